@@ -9,10 +9,41 @@
    This implements a hardware abstraction layer for the PIC32 ADC
 
  Notes
-
+   Conversions are asynchronous: ADC_StartScan triggers a scan of the
+   chosen inputs and the end of scan interrupt posts EV_ADC_COMPLETE to the
+   service that started it. The interrupt fills one half of a double buffer
+   while ADC_GetResult reads the other, so a service never sees a half
+   written scan. ADCService is the one user, it batches everybody else's
+   requests into these scans.
+   Both inputs go through the hardware oversampling filters, so one scan
+   is ADC_OVERSAMPLES conversions, retriggered from the interrupt, and the
+   result is their average rather than a single sample.
 ****************************************************************************/
+#include <sys/attribs.h>
+
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ADC_HAL.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// priority of the end of scan interrupt, above the core timer tick
+#define ADC_EOS_PRIORITY 4
+
+// ADCFLTRx.OVRSAM 0b001, 16 conversions accumulated into 14 bits, of which
+// ADC_GetResult keeps 12 rounded. Averaging 16 cuts random noise by 4.
+#define ADC_OVRSAM 1
+#define ADC_OVERSAMPLES 16
+#define ADC_OVERSAMPLE_BITS 2
+
+/*---------------------------- Module Variables ---------------------------*/
+// the scan results, the ISR fills [ReadyBuffer ^ 1] then flips ReadyBuffer
+static volatile uint16_t Results[2][ADC_NUM_CHANNELS];
+static volatile uint8_t ReadyBuffer;
+
+// the inputs in the running scan, ADC_CHANNEL_BITs, 0 when there is none
+static volatile uint8_t ScanChannels;
+// and the service to tell when it is done
+static uint8_t ScanOwner;
 
 /**************************************************************************
   Function
@@ -93,18 +124,24 @@ void InitADC(void) {
    ADCGIRQEN2 = 0;
   
    /* Configure ADCCSSx */ 
-   ADCCSS1 = 0; // Clear all bits 
+   ADCCSS1 = 0; // Clear all bits, ADC_StartScan picks the inputs 
    ADCCSS2 = 0; 
-   ADCCSS1bits.CSS12 = 1; // AN12 set for scan 
-   ADCCSS1bits.CSS13 = 1; // AN13 set for scan 
    
    /* Configure ADCCMPCONx */ 
    ADCCMPCON1 = 0; // No digital comparators are used. Setting the ADCCMPCONx 
    ADCCMPCON2 = 0; // register to '0' ensures that the comparator is disabled. 
    
    /* Configure ADCFLTRx */ 
-   ADCFLTR1 = 0; // No oversampling filters are used. 
-   ADCFLTR2 = 0; 
+   ADCFLTR1 = 0; // Oversampling filter 1 on AN12 
+   ADCFLTR1bits.CHNLID = 12; 
+   ADCFLTR1bits.DFMODE = 0; // Oversampling mode, not averaging 
+   ADCFLTR1bits.OVRSAM = ADC_OVRSAM; 
+   ADCFLTR1bits.AFEN = 1; 
+   ADCFLTR2 = 0; // Oversampling filter 2 on AN13 
+   ADCFLTR2bits.CHNLID = 13; 
+   ADCFLTR2bits.DFMODE = 0; 
+   ADCFLTR2bits.OVRSAM = ADC_OVRSAM; 
+   ADCFLTR2bits.AFEN = 1; 
    
    /* Set up the trigger sources */ 
    ADCTRG4bits.TRGSRC12 = 3; // Set AN0 (Class 1) to trigger from scan source 
@@ -114,6 +151,12 @@ void InitADC(void) {
    ADCEIEN1 = 0; // No early interrupt 
    ADCEIEN2 = 0;
    
+   /* End of scan interrupt, completes ADC_StartScan */ 
+   ADCCON2bits.EOSIEN = 1; // Interrupt once the whole scan list is converted 
+   IFS1CLR = _IFS1_ADCEOSIF_MASK; // Clear any stale end of scan flag 
+   IPC11bits.ADCEOSIP = ADC_EOS_PRIORITY; 
+   IEC1SET = _IEC1_ADCEOSIE_MASK; // Enable the end of scan interrupt 
+   
    /*
     Step 3: The user sets the ANENx bit to ?1? for the ADC 
     SAR Cores needed (which internally in the ADC module 
@@ -163,27 +206,105 @@ void InitADC(void) {
 
 /**************************************************************************
   Function
-     ReadADCValues
+     ADC_StartScan
 
  Parameters
-     uint32_t* Results: a pointer to a vector which the ADC results will be
-                        placed
+     uint8_t WhichService: the service to post EV_ADC_COMPLETE to
+     uint8_t Channels: the inputs to convert, ADC_CHANNEL_BITs or'd together
 
  Returns
-     None
+     bool: false if a scan is already running or the arguments are bad
 
  Description
-     Places the readings from the ADC into Results
+     Starts a conversion of the chosen inputs without waiting for it. When
+     it is done, WhichService gets EV_ADC_COMPLETE, with Channels in the
+     EventParam, and the readings are available from ADC_GetResult.
  Notes
- 
+     The event comes through ES_PostToServiceFromISR, so WhichService must
+     have an ISR queue attached.
  *************************************************************************/
-void ReadADC(uint16_t *Results){
-    
+bool ADC_StartScan(uint8_t WhichService, uint8_t Channels)
+{
+    if ((WhichService >= NUM_SERVICES) || (Channels == 0) ||
+        (Channels >= (1 << ADC_NUM_CHANNELS)) || (ScanChannels != 0)) {
+        return false;
+    }
+    ScanOwner = WhichService;
+    ScanChannels = Channels;
+    ADCCSS1bits.CSS12 = (Channels & ADC_CHANNEL_BIT(ADC_THERMISTOR)) != 0;
+    ADCCSS1bits.CSS13 = (Channels & ADC_CHANNEL_BIT(ADC_SOIL_MOISTURE)) != 0;
     ADCCON3bits.GSWTRG = 1; // Trigger a conversion
-    
-    while (ADCDSTAT1bits.ARDY12 == 0); 
-    Results[0] = ADCDATA12; // Wait the conversions to complete
-    
-    while (ADCDSTAT1bits.ARDY13 == 0); 
-    Results[1] = ADCDATA13; // fetch the result
-}
\ No newline at end of file
+    return true;
+}
+
+/**************************************************************************
+  Function
+     ADC_GetResult
+
+ Parameters
+     ADC_Channel_t WhichChannel: the input to fetch
+
+ Returns
+     uint16_t: the 12 bit reading from the most recent scan that included
+               WhichChannel
+
+ Description
+     Reads one channel of the last scan; call it on EV_ADC_COMPLETE
+ Notes
+     The buffer read here is not written again until two more scans have
+     completed.
+ *************************************************************************/
+uint16_t ADC_GetResult(ADC_Channel_t WhichChannel)
+{
+    return Results[ReadyBuffer][WhichChannel];
+}
+
+/**************************************************************************
+  Function
+     ADC_EOS_ISR
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     End of scan interrupt response. Until the oversampling filters of the
+     scanned inputs have their ADC_OVERSAMPLES conversions it triggers the
+     next one. Then it stores the scan in the idle half of the buffer,
+     makes it the ready half and tells the scan's owner.
+ Notes
+     Inputs left out of the scan keep their last reading.
+ *************************************************************************/
+void __ISR(_ADC_EOS_VECTOR, IPL4AUTO) ADC_EOS_ISR(void)
+{
+    uint8_t Fill = ReadyBuffer ^ 1;
+    uint8_t Channels = ScanChannels;
+    ES_Event_t DoneEvent = {EV_ADC_COMPLETE, Channels};
+
+    (void)ADCCON2; // Reading ADCCON2 clears EOSRDY
+    IFS1CLR = _IFS1_ADCEOSIF_MASK;
+    if (((Channels & ADC_CHANNEL_BIT(ADC_THERMISTOR)) &&
+         (ADCFLTR1bits.AFRDY == 0)) ||
+        ((Channels & ADC_CHANNEL_BIT(ADC_SOIL_MOISTURE)) &&
+         (ADCFLTR2bits.AFRDY == 0))) {
+        ADCCON3bits.GSWTRG = 1; // Feed the filters another conversion
+        return;
+    }
+    Results[Fill][ADC_THERMISTOR] = Results[ReadyBuffer][ADC_THERMISTOR];
+    Results[Fill][ADC_SOIL_MOISTURE] =
+        Results[ReadyBuffer][ADC_SOIL_MOISTURE];
+    if (Channels & ADC_CHANNEL_BIT(ADC_THERMISTOR)) {
+        Results[Fill][ADC_THERMISTOR] = (ADCFLTR1bits.FLTRDATA +
+            (1 << (ADC_OVERSAMPLE_BITS - 1))) >> ADC_OVERSAMPLE_BITS;
+    }
+    if (Channels & ADC_CHANNEL_BIT(ADC_SOIL_MOISTURE)) {
+        Results[Fill][ADC_SOIL_MOISTURE] = (ADCFLTR2bits.FLTRDATA +
+            (1 << (ADC_OVERSAMPLE_BITS - 1))) >> ADC_OVERSAMPLE_BITS;
+    }
+    ReadyBuffer = Fill;
+
+    ScanChannels = 0;
+    ES_PostToServiceFromISR(ScanOwner, DoneEvent);
+}
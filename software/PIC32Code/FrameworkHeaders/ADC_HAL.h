@@ -8,8 +8,23 @@
 #ifndef ADC_HAL_H
 #define	ADC_HAL_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// the scan list, in the order the inputs land in the result buffer
+typedef enum
+{
+    ADC_THERMISTOR,     // AN12
+    ADC_SOIL_MOISTURE,  // AN13
+    ADC_NUM_CHANNELS
+} ADC_Channel_t;
+
+// a set of channels for ADC_StartScan
+#define ADC_CHANNEL_BIT(Channel) (1 << (Channel))
+
 void InitADC(void);
-void ReadADC(uint16_t *Results);
+bool ADC_StartScan(uint8_t WhichService, uint8_t Channels);
+uint16_t ADC_GetResult(ADC_Channel_t WhichChannel);
 
 #endif	/* ADC_HAL_H */
 
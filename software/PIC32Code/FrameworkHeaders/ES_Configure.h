@@ -28,12 +28,102 @@
 // The maximum number of services sets an upper bound on the number of
 // services that the framework will handle. Reasonable values are 8 and 16
 // corresponding to an 8-bit(uint8_t) and 16-bit(uint16_t) Ready variable size
+// Values above 16, up to 64, switch the Ready variable to a two level bitmap
+// so finding the highest priority ready service still takes constant time
 #define MAX_NUM_SERVICES 16
 
 /****************************************************************************/
 // This macro determines that nuber of services that are *actually* used in
 // a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
-#define NUM_SERVICES 8
+#define NUM_SERVICES 9
+
+/****************************************************************************/
+// Any service may also name a batch run function, SERV_n_BATCH_RUN. ES_Run
+// then passes it every event waiting in that service's queue in one call,
+// as an array and a count, instead of calling SERV_n_RUN once per event.
+// BATCH_RUN_MAX_EVENTS sets how many events one call can carry, make it at
+// least as big as the largest queue of a batch service.
+#define BATCH_RUN_MAX_EVENTS 3
+
+/****************************************************************************/
+// ES_Publish posts an event only to the services that subscribe to its type.
+// A service subscribes by setting SERV_n_SUBSCRIBES to the ES_EVENT_BITs of
+// the types it wants, or'd together; only the first 64 event types can be
+// subscribed to. The framework turns these into a table of subscribers per
+// event type when it is compiled, so a publish costs one table look up.
+// SERV_n_COALESCE, set the same way, lists the types of which a service only
+// wants the latest value: a post of one overwrites the event of that type
+// already waiting, if there is one, instead of taking another queue entry.
+// ES_GetQueueStats counts these posts in Coalesced.
+
+/****************************************************************************/
+// ES_Run normally takes the highest numbered service with an event waiting.
+// Defining EDF_DISPATCH makes it take the one whose next event is closest to
+// its deadline instead, earliest deadline first. An event's deadline is
+// SERV_n_DEADLINE ticks after it was posted, or EDF_DEFAULT_DEADLINE for a
+// service that does not set one, and must be under 32768 ticks. Equal
+// deadlines go to the higher numbered service. Each queued event's post
+// tick is kept, so EDF_STAMP_DEPTH must be at least the largest
+// SERV_n_QUEUE_SIZE or ES_Initialize fails.
+// It trades misses between services rather than removing them. Under
+// BenchDeadline's 90% busy load the low priority USB service goes from 28
+// missed deadlines to none, but the pump goes from 12 to 14 and the display
+// from 0 to 1, since a tight deadline no longer always wins outright.
+// #define EDF_DISPATCH
+#define EDF_DEFAULT_DEADLINE 1000
+#define EDF_STAMP_DEPTH 8
+
+/****************************************************************************/
+// Defining ES_PROFILE times every call to a service's run function with the
+// core timer (_HW_GetCycleCount) and keeps the minimum, maximum, mean and a
+// log2 histogram for each service, ES_PROFILE_BUCKETS buckets wide. 'p' on
+// the terminal prints them (ES_PrintProfile). Without it none of the timing
+// code or data is built, so it is left off until it is wanted.
+// #define ES_PROFILE
+#define ES_PROFILE_BUCKETS 20
+#define ES_PROFILE_COUNTS_PER_US 20
+
+/****************************************************************************/
+// Defining ES_RUN_BUDGET has ES_Run time every run function call against its
+// service's SERV_n_BUDGET_US, ES_DEFAULT_BUDGET_US for a service that does
+// not set one. A call that goes over is logged with its service, event,
+// time taken and the tick it returned on, the last ES_OVERRUN_LOG_SIZE of
+// them kept. 'o' on the terminal prints them (ES_PrintOverruns).
+// Defining ES_BUDGET_WATCHDOG as well turns on the hardware watchdog,
+// cleared before every dispatch and on every idle pass of ES_Run, so that a
+// call that never returns resets the chip, and that call is the first
+// overrun logged after the restart. Both are left off until wanted.
+// #define ES_RUN_BUDGET
+#define ES_DEFAULT_BUDGET_US 1000
+#define ES_OVERRUN_LOG_SIZE 8
+// #define ES_BUDGET_WATCHDOG
+
+/****************************************************************************/
+// Defining ES_TRACE keeps a flight recorder, a ring of the last ES_TRACE_SIZE
+// (a power of 2) posts, run function calls and returns, and timer expiries,
+// 8 bytes each, stamped with _HW_GetCycleCount. 'r' on the terminal dumps it
+// in binary (ES_TraceDump) for HostPort/TraceDecode to turn into a Chrome
+// trace. Without it none of the recording code or data is built. The ring
+// alone is ES_TRACE_SIZE * 8 bytes of RAM, so it is left off until wanted.
+// #define ES_TRACE
+#define ES_TRACE_SIZE 512
+
+/****************************************************************************/
+// A service's queue is normally an ES_Queue, at most 254 events, indexed
+// with a %. Defining SERV_n_RING_QUEUE gives it a mask indexed ring instead,
+// in which case SERV_n_QUEUE_SIZE must be a power of 2, up to 32768, and the
+// build fails if it is not. BenchQueue finds the ring no faster at 4 or 8
+// entries, so it pays only for big queues and none of these services use it.
+
+/****************************************************************************/
+// Events that need more than the 16 bit EventParam carry the handle of a
+// block from the payload pool (ES_Payload.h) instead. These set how many
+// blocks there are and how many bytes each holds; 0 blocks leaves it out.
+#define NUM_PAYLOAD_BLOCKS 4
+#define PAYLOAD_BLOCK_SIZE 8
+// the ES_EVENT_BITs of the types whose EventParam is a payload handle, so
+// that the framework can release the block of a coalesced event
+#define ES_PAYLOAD_EVENTS ES_EVENT_BIT(EV_UPDATE_TEMP)
 
 /****************************************************************************/
 // These are the definitions for Service 0, the lowest priority service.
@@ -48,6 +138,10 @@
 #define SERV_0_RUN RunUsbOutService
 // How big should this services Queue be?
 #define SERV_0_QUEUE_SIZE 5
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_0_DEADLINE 500
+// the event types ES_Publish sends this service, ES_EVENT_BITs or'd together
+#define SERV_0_SUBSCRIBES ES_EVENT_BIT(ES_NEW_KEY)
 
 /****************************************************************************/
 // The following sections are used to define the parameters for each of the
@@ -64,6 +158,8 @@
 #define SERV_1_RUN RunTemperatureSM
 // How big should this services Queue be?
 #define SERV_1_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_1_DEADLINE 100
 #endif
 
 /****************************************************************************/
@@ -75,8 +171,17 @@
 #define SERV_2_INIT InitWiFiSM
 // the name of the run function
 #define SERV_2_RUN RunWiFiSM
+// SPI1 RX bytes arrive in bursts, this takes them a queue at a time. Left
+// off: BenchBatch finds batching no faster until bursts of 4 or more, and
+// this queue holds 3.
+// #define SERV_2_BATCH_RUN RunWiFiSMBatch
 // How big should this services Queue be?
 #define SERV_2_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_2_DEADLINE 10
+// only the newest reading of each kind is worth sending
+#define SERV_2_COALESCE (ES_EVENT_BIT(EV_UPDATE_TEMP) | \
+    ES_EVENT_BIT(EV_SEND_WIFI_MOISTURE_UPDATE))
 #endif
 
 /****************************************************************************/
@@ -90,6 +195,8 @@
 #define SERV_3_RUN RunPumpSM
 // How big should this services Queue be?
 #define SERV_3_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_3_DEADLINE 5
 #endif
 
 /****************************************************************************/
@@ -103,6 +210,11 @@
 #define SERV_4_RUN RunDisplaySM
 // How big should this services Queue be?
 #define SERV_4_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_4_DEADLINE 50
+// only the newest reading of each kind is worth showing
+#define SERV_4_COALESCE (ES_EVENT_BIT(EV_UPDATE_TEMP) | \
+    ES_EVENT_BIT(EV_SEND_WIFI_MOISTURE_UPDATE))
 #endif
 
 /****************************************************************************/
@@ -116,6 +228,8 @@
 #define SERV_5_RUN RunUserButtonSM
 // How big should this services Queue be?
 #define SERV_5_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_5_DEADLINE 20
 #endif
 
 /****************************************************************************/
@@ -129,6 +243,8 @@
 #define SERV_6_RUN RunWaterButtonSM
 // How big should this services Queue be?
 #define SERV_6_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_6_DEADLINE 20
 #endif
 
 /****************************************************************************/
@@ -142,19 +258,23 @@
 #define SERV_7_RUN RunSoilMoistureSM
 // How big should this services Queue be?
 #define SERV_7_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_7_DEADLINE 20
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 8
 #if NUM_SERVICES > 8
 // the header file with the public function prototypes
-#define SERV_8_HEADER "TestHarnessService8.h"
+#define SERV_8_HEADER "ADCService.h"
 // the name of the Init function
-#define SERV_8_INIT InitTestHarnessService8
+#define SERV_8_INIT InitADCService
 // the name of the run function
-#define SERV_8_RUN RunTestHarnessService8
+#define SERV_8_RUN RunADCService
 // How big should this services Queue be?
 #define SERV_8_QUEUE_SIZE 3
+// with EDF_DISPATCH, the ticks an event may wait in the queue
+#define SERV_8_DEADLINE 5
 #endif
 
 /****************************************************************************/
@@ -248,6 +368,10 @@
 #define SERV_15_QUEUE_SIZE 3
 #endif
 
+/****************************************************************************/
+// Services 16 and up (MAX_NUM_SERVICES > 16) are defined the same way:
+// SERV_16_HEADER, SERV_16_INIT, SERV_16_RUN, SERV_16_QUEUE_SIZE and so on.
+
 /****************************************************************************/
 // Name/define the events of interest
 // Universal events occupy the lowest entries, followed by user-defined events
@@ -279,7 +403,10 @@ typedef enum
   EV_SEND_WIFI_THRESHOLD_UPDATE,
   EV_SEND_WIFI_UNIT_UPDATE,
   EV_SEND_WIFI_MOISTURE_UPDATE,
-  EV_SEND_WATER_LOW_UPDATE
+  EV_SEND_WATER_LOW_UPDATE,
+  EV_ADC_COMPLETE,          /* a scan started by ADC_StartScan is done */
+  EV_ADC_READING,           /* a reading asked for with RequestADCReading */
+  NUM_EVENT_TYPES           /* not an event, keep it last */
 }ES_EventType_t;
 
 /****************************************************************************/
@@ -312,14 +439,53 @@ typedef enum
 #define DIST_LIST7 PostTemplateFSM
 #endif
 
+/****************************************************************************/
+// Subscriber lists are distribution lists that services join and leave at
+// run time, with ES_ListSubscribe and ES_ListUnsubscribe. ES_ListPost posts
+// to every member of a list with interrupts off just once for the lot.
+// NUM_SUBSCRIBER_LISTS sets how many there are, numbered from 0.
+#define NUM_SUBSCRIBER_LISTS 2
+// new readings from TemperatureSM
+#define TEMPERATURE_LIST 0
+// new readings from SoilMoistureSM
+#define MOISTURE_LIST 1
+
 /****************************************************************************/
 // This is the list of event checking functions
 #define EVENT_CHECK_LIST Check4Keystroke, CheckUserButton, CheckWaterButton
 
+/****************************************************************************/
+// The number of timers. 16 fits in a single 16-bit active flag word, above
+// that, up to 64, the active flags become a two level bitmap
+#define MAX_NUM_TIMERS 16
+
+// Define TIMER_WHEEL_SIZE (a power of 2) to keep the timers in a hashed
+// timing wheel instead of visiting every active timer on every tick. Each
+// slot costs a byte and a tick looks at one slot, so a size near the number
+// of timers in use keeps the tick short. Needed for more than 64 timers (up
+// to 255); timers from 64 up all post to TIMER_EXTRA_RESP_FUNC, with the
+// timer number in the EventParam as usual. A few timers gain nothing here.
+// #define TIMER_WHEEL_SIZE 64
+
+// The number of timers kept in a pool for ES_Timer_Alloc, numbered from
+// MAX_NUM_TIMERS up. They need no TIMERn_RESP_FUNC, each one posts to the
+// service it was allocated for, and they count toward the 64 (255) limit.
+#define NUM_DYNAMIC_TIMERS 4
+
+/****************************************************************************/
+// Define TICKLESS_IDLE to let the CPU sleep when the framework is idle rather
+// than spin through the event checkers. The tick interrupt is put off until
+// the next timer expiry, but never more than TICKLESS_MAX_TICKS ticks, so the
+// polled event checkers (the buttons and the keyboard here) still get a look.
+// The ticks slept through are made up on waking. Off until the sleep and
+// the catch up have been checked on the target.
+// #define TICKLESS_IDLE
+#define TICKLESS_MAX_TICKS 10
+
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
-// corresponding timer expires. All 16 must be defined. If you are not using
-// a timer, then you should use TIMER_UNUSED
+// corresponding timer expires. All MAX_NUM_TIMERS must be defined. If you are
+// not using a timer, then you should use TIMER_UNUSED
 // Unlike services, any combination of timers may be used and there is no
 // priority in servicing them
 #define TIMER_UNUSED ((pPostFunc)0)
@@ -330,7 +496,7 @@ typedef enum
 #define TIMER4_RESP_FUNC TIMER_UNUSED
 #define TIMER5_RESP_FUNC TIMER_UNUSED
 #define TIMER6_RESP_FUNC TIMER_UNUSED
-#define TIMER7_RESP_FUNC TIMER_UNUSED
+#define TIMER7_RESP_FUNC PostADCService
 #define TIMER8_RESP_FUNC PostDisplaySM
 #define TIMER9_RESP_FUNC PostSoilMoistureSM
 #define TIMER10_RESP_FUNC PostPumpSM
@@ -339,6 +505,56 @@ typedef enum
 #define TIMER13_RESP_FUNC PostWaterButtonSM
 #define TIMER14_RESP_FUNC PostUserButtonSM
 #define TIMER15_RESP_FUNC PostUsbOutService
+#if MAX_NUM_TIMERS > 16
+#define TIMER16_RESP_FUNC TIMER_UNUSED
+#define TIMER17_RESP_FUNC TIMER_UNUSED
+#define TIMER18_RESP_FUNC TIMER_UNUSED
+#define TIMER19_RESP_FUNC TIMER_UNUSED
+#define TIMER20_RESP_FUNC TIMER_UNUSED
+#define TIMER21_RESP_FUNC TIMER_UNUSED
+#define TIMER22_RESP_FUNC TIMER_UNUSED
+#define TIMER23_RESP_FUNC TIMER_UNUSED
+#define TIMER24_RESP_FUNC TIMER_UNUSED
+#define TIMER25_RESP_FUNC TIMER_UNUSED
+#define TIMER26_RESP_FUNC TIMER_UNUSED
+#define TIMER27_RESP_FUNC TIMER_UNUSED
+#define TIMER28_RESP_FUNC TIMER_UNUSED
+#define TIMER29_RESP_FUNC TIMER_UNUSED
+#define TIMER30_RESP_FUNC TIMER_UNUSED
+#define TIMER31_RESP_FUNC TIMER_UNUSED
+#define TIMER32_RESP_FUNC TIMER_UNUSED
+#define TIMER33_RESP_FUNC TIMER_UNUSED
+#define TIMER34_RESP_FUNC TIMER_UNUSED
+#define TIMER35_RESP_FUNC TIMER_UNUSED
+#define TIMER36_RESP_FUNC TIMER_UNUSED
+#define TIMER37_RESP_FUNC TIMER_UNUSED
+#define TIMER38_RESP_FUNC TIMER_UNUSED
+#define TIMER39_RESP_FUNC TIMER_UNUSED
+#define TIMER40_RESP_FUNC TIMER_UNUSED
+#define TIMER41_RESP_FUNC TIMER_UNUSED
+#define TIMER42_RESP_FUNC TIMER_UNUSED
+#define TIMER43_RESP_FUNC TIMER_UNUSED
+#define TIMER44_RESP_FUNC TIMER_UNUSED
+#define TIMER45_RESP_FUNC TIMER_UNUSED
+#define TIMER46_RESP_FUNC TIMER_UNUSED
+#define TIMER47_RESP_FUNC TIMER_UNUSED
+#define TIMER48_RESP_FUNC TIMER_UNUSED
+#define TIMER49_RESP_FUNC TIMER_UNUSED
+#define TIMER50_RESP_FUNC TIMER_UNUSED
+#define TIMER51_RESP_FUNC TIMER_UNUSED
+#define TIMER52_RESP_FUNC TIMER_UNUSED
+#define TIMER53_RESP_FUNC TIMER_UNUSED
+#define TIMER54_RESP_FUNC TIMER_UNUSED
+#define TIMER55_RESP_FUNC TIMER_UNUSED
+#define TIMER56_RESP_FUNC TIMER_UNUSED
+#define TIMER57_RESP_FUNC TIMER_UNUSED
+#define TIMER58_RESP_FUNC TIMER_UNUSED
+#define TIMER59_RESP_FUNC TIMER_UNUSED
+#define TIMER60_RESP_FUNC TIMER_UNUSED
+#define TIMER61_RESP_FUNC TIMER_UNUSED
+#define TIMER62_RESP_FUNC TIMER_UNUSED
+#define TIMER63_RESP_FUNC TIMER_UNUSED
+#endif
 
 /****************************************************************************/
 // Give the timer numbers symbolc names to make it easier to move them
@@ -347,8 +563,9 @@ typedef enum
 // the timer number matches where the timer event will be routed
 // These symbolic names should be changed to be relevant to your application
 
+#define ADC_BATCH_TIMER 7
 #define DISPLAY_TIMER 8
-#define SOIL_MOISTURE_AFTER_WATER_TIMER 9
+#define SOIL_MOISTURE_SETTLE_TIMER 9
 #define PUMP_TIMER 10
 #define SOIL_MOISTURE_TIMER 11
 #define TEMPERATURE_UPDATE_TIMER 12
@@ -48,14 +48,33 @@
  Returns
      bool true if an event was recalled, false if no event was left in queue
  Description
-     pulls an event off the deferral queue if one is available. It there was
-     something in the queue, then it posts it LIFO fashion to the queue
-     indicated by WhichService
+     pulls all events off the deferral queue if any are available and puts
+     them at the front of the queue indicated by WhichService, in the order
+     they were deferred
  Notes
-     None.
+     all or nothing: if the service's queue does not have room for every
+     deferred event, they all stay deferred
  Author
      J. Edward Carryer, 11/20/13 16:49
 ****************************************************************************/
 bool ES_RecallEvents(uint8_t WhichService, ES_Event_t *pBlock);
 
+/****************************************************************************
+ Function
+     ES_RecallEventsOfType
+ Parameters
+      uint8_t WhichService, number of the service to post Recalled event to
+      ES_Event * pBlock, pointer to the block of memory that implements the
+        Defer/Recall queue
+      ES_EventType_t WhichType, the type of event to recall
+ Returns
+     bool true if an event was recalled, false if none of that type was left
+ Description
+     ES_RecallEvents for the events of one type only, the rest stay deferred
+ Notes
+     all or nothing, like ES_RecallEvents
+****************************************************************************/
+bool ES_RecallEventsOfType(uint8_t WhichService, ES_Event_t *pBlock,
+    ES_EventType_t WhichType);
+
 #endif
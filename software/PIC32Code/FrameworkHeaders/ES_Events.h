@@ -30,4 +30,9 @@ typedef struct ES_Event
   uint16_t EventParam;          // parameter value for use w/ this event
 }ES_Event_t;
 
+// a SERV_n_SUBSCRIBES mask holds a bit for each of the first
+// ES_MAX_SUBSCRIBED_TYPES event types, ES_EVENT_BIT(Type) is Type's bit
+#define ES_MAX_SUBSCRIBED_TYPES 64
+#define ES_EVENT_BIT(Type) (1ULL << (Type))
+
 #endif /* ES_Events_H */
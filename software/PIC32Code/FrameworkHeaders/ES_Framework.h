@@ -28,6 +28,9 @@
 #include "ES_PostList.h"
 #include "ES_General.h"
 #include "ES_Timers.h"
+#include "ES_SPSCQueue.h"
+#include "ES_Payload.h"
+#include "ES_Trace.h"
 
 typedef enum
 {
@@ -40,10 +43,74 @@ typedef enum
   FailedOther
 }ES_Return_t;
 
+// what one service's queue has seen since start up (or ES_ResetQueueStats)
+typedef struct
+{
+  uint32_t Enqueued;      // posts accepted, ISR posts included
+  uint32_t Dequeued;      // events handed to the service
+  uint32_t Dropped;       // posts refused because the queue was full
+  uint32_t Coalesced;     // posts that overwrote a waiting event of their
+                          // type (SERV_n_COALESCE), not in Enqueued
+  uint16_t PeakDepth;     // most events ever waiting in the queue at once
+  uint16_t Capacity;      // SERV_n_QUEUE_SIZE, as built
+}ES_QueueStats_t;
+
+#ifdef ES_PROFILE
+// how long one service's run function has taken per call, in core timer
+// counts (ES_PROFILE_COUNTS_PER_US to the microsecond)
+typedef struct
+{
+  uint32_t Runs;          // calls timed
+  uint32_t MinCounts;
+  uint32_t MaxCounts;
+  uint64_t TotalCounts;   // for the mean, TotalCounts / Runs
+  // calls that took from 2^n to 2^(n+1) - 1 counts, the last bucket also
+  // takes everything longer and bucket 0 also takes calls of 0 counts
+  uint32_t Histogram[ES_PROFILE_BUCKETS];
+}ES_ProfileStats_t;
+#endif
+
+#ifdef ES_RUN_BUDGET
+// Counts of a run function call that never returned, found by the watchdog
+#define ES_OVERRUN_WATCHDOG 0xFFFFFFFFUL
+
+// a run function call that went over its service's SERV_n_BUDGET_US
+typedef struct
+{
+  uint64_t   Tick;        // ES_Timer_GetTime64 when it was noticed
+  uint32_t   Counts;      // how long it took, in core timer counts
+  ES_Event_t Event;       // what it was called with, the first of a batch
+  uint8_t    Service;
+}ES_Overrun_t;
+#endif
+
 ES_Return_t ES_Initialize(TimerRate_t NewRate);
 ES_Return_t ES_Run(void);
 bool ES_PostAll(ES_Event_t ThisEvent);
+bool ES_Publish(ES_Event_t ThisEvent);
+bool ES_ListSubscribe(uint8_t WhichList, uint8_t WhichService);
+bool ES_ListUnsubscribe(uint8_t WhichList, uint8_t WhichService);
+uint8_t ES_ListPost(uint8_t WhichList, ES_Event_t ThisEvent);
 bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent);
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent);
+bool ES_PostToServiceFront(uint8_t WhichService, const ES_Event_t *pEvents,
+    uint8_t NumEvents);
+uint16_t ES_GetQueueRoom(uint8_t WhichService);
+bool ES_AttachISRQueue(uint8_t WhichService, ES_SPSCQueue_t *pQueue);
+bool ES_PostToServiceFromISR(uint8_t WhichService, ES_Event_t TheEvent);
+bool ES_GetQueueStats(uint8_t WhichService, ES_QueueStats_t *pStats);
+void ES_ResetQueueStats(void);
+void ES_PrintQueueStats(void);
+bool ES_AnyEventsPending(void);
+#ifdef ES_PROFILE
+bool ES_GetProfile(uint8_t WhichService, ES_ProfileStats_t *pStats);
+void ES_ResetProfile(void);
+void ES_PrintProfile(void);
+#endif
+#ifdef ES_RUN_BUDGET
+uint32_t ES_GetNumOverruns(void);
+uint8_t ES_GetOverruns(ES_Overrun_t *pDest, uint8_t MaxRecords);
+void ES_PrintOverruns(void);
+#endif
 
 #endif   // ES_Framework_H
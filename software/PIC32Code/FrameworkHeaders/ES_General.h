@@ -6,4 +6,10 @@
 #define BITS_PER_BYTE 8
 #define BITS_PER_NYBBLE 4
 
+// true for 1, 2, 4, 8... usable in #if and in constant expressions
+#define ES_IS_POW2(x) (((x) != 0) && (((x) & ((x) - 1)) == 0))
+
+// fails to compile, naming Msg, when Cond is false. File scope only.
+#define ES_STATIC_ASSERT(Cond, Msg) typedef char Msg[(Cond) ? 1 : -1]
+
 #endif //ES_General_H
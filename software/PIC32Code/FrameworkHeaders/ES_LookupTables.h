@@ -23,7 +23,11 @@
  08/05/13 15:45 jec      added #include for ES_Types.h since we depend on it
  01/15/12 13:03 jec      started coding
 *****************************************************************************/
+#ifndef ES_LOOKUPTABLES_H
+#define ES_LOOKUPTABLES_H
+
 #include "ES_Types.h"
+#include "ES_Port.h"
 /*
   Since we moved up to 16 timers & services, this table got too big to justify
   having a separate table for the clear and set masks, so just #define the
@@ -48,7 +52,7 @@ extern uint8_t const Nybble2MSBitNum[15];
 
 /****************************************************************************
  Function
-   ES_GetMSBSet
+   ES_GetMSBitSetTable
  Parameters
    uint16_t  Val2Check The number to find the MSB in
  Returns
@@ -56,8 +60,77 @@ extern uint8_t const Nybble2MSBitNum[15];
  Description
    find the MSB that is set in Val2Check and returns that bit number
  Notes
-
+   portable version, walks Val2Check a nybble at a time through
+   Nybble2MSBitNum
  Author
    J. Edward Carryer, 10/20/13, 17:03
 ****************************************************************************/
-uint8_t ES_GetMSBitSet(uint16_t Val2Check);
+uint8_t ES_GetMSBitSetTable(uint16_t Val2Check);
+
+/****************************************************************************
+ Function
+   ES_GetMSBitSet
+ Parameters
+   uint16_t  Val2Check The number to find the MSB in
+ Returns
+   bit number of the MSB that is set in Val2Check, 128 if Val2Check = 0
+ Description
+   find the MSB that is set in Val2Check and returns that bit number
+ Notes
+   this is the innermost operation of ES_Run, so when the port has a count
+   leading zeros instruction (ES_HAS_CLZ) it is inlined down to that
+   instruction. Otherwise it is the table version. The timer tick calls
+   ES_GetMSBitSetTable directly, see ES_Timers.c.
+****************************************************************************/
+#ifdef ES_HAS_CLZ
+static inline uint8_t ES_GetMSBitSet(uint16_t Val2Check)
+{
+  if (Val2Check == 0)
+  {
+    return 128; // this is the error return value
+  }
+  // the operand is promoted to 32 bits, so bit 31 is the top of the count
+  return (uint8_t)(31 - __builtin_clz(Val2Check));
+}
+#else
+#define ES_GetMSBitSet ES_GetMSBitSetTable
+#endif
+
+/*
+  Two level bitmaps, used when there are more than 16 services or timers.
+  Element 0 is the summary: bit n is set whenever element n+1, which holds
+  bits n*16 to n*16+15, is non-zero. Finding the highest set bit is then two
+  ES_GetMSBitSet calls however many bits there are. Up to 256 bits.
+  Declare one with: uint16_t Map[ES_BITMAP_SIZE(NumBits)];
+*/
+#define ES_BITMAP_SIZE(NumBits) (1 + (((NumBits) + 15) / 16))
+
+static inline void ES_BitmapSet(uint16_t *pBitmap, uint8_t BitNum)
+{
+  pBitmap[(BitNum >> 4) + 1] |= BitNum2SetMask[BitNum & 0x0F];
+  pBitmap[0] |= BitNum2SetMask[BitNum >> 4];
+}
+
+static inline void ES_BitmapClear(uint16_t *pBitmap, uint8_t BitNum)
+{
+  pBitmap[(BitNum >> 4) + 1] &= BitNum2ClrMask[BitNum & 0x0F];
+  if (pBitmap[(BitNum >> 4) + 1] == 0)
+  {
+    pBitmap[0] &= BitNum2ClrMask[BitNum >> 4];
+  }
+}
+
+// returns 128 if no bit is set, the same as ES_GetMSBitSet
+static inline uint8_t ES_BitmapGetMSBitSet(const uint16_t *pBitmap)
+{
+  uint8_t Group;
+
+  if (pBitmap[0] == 0)
+  {
+    return 128;
+  }
+  Group = ES_GetMSBitSet(pBitmap[0]);
+  return (uint8_t)((Group << 4) + ES_GetMSBitSet(pBitmap[Group + 1]));
+}
+
+#endif /* ES_LOOKUPTABLES_H */
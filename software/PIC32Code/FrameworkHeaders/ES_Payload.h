@@ -0,0 +1,47 @@
+/****************************************************************************
+ Module
+     ES_Payload.h
+ Description
+     header file for the event payload pool. A payload is a fixed size block
+     that an event carries by handle in its EventParam, for data that does
+     not fit in 16 bits. Blocks are reference counted so one can be posted
+     to several services without copying it.
+ Notes
+     the poster allocates (holding one reference), retains once for every
+     post that succeeds, then releases its own reference. Each service that
+     receives the event releases it once when done, whatever state it is in.
+     An event that is overwritten in a coalescing queue (SERV_n_COALESCE) is
+     released by the framework, if its type is in ES_PAYLOAD_EVENTS.
+     Not for use from ISRs, see ES_Payload.c.
+     Sized by NUM_PAYLOAD_BLOCKS and PAYLOAD_BLOCK_SIZE in ES_Configure.h.
+*****************************************************************************/
+#ifndef ES_Payload_H
+#define ES_Payload_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+
+#ifndef NUM_PAYLOAD_BLOCKS
+#define NUM_PAYLOAD_BLOCKS 0
+#endif
+#ifndef PAYLOAD_BLOCK_SIZE
+#define PAYLOAD_BLOCK_SIZE 0
+#endif
+// the event types that carry a handle, as ES_EVENT_BITs
+#ifndef ES_PAYLOAD_EVENTS
+#define ES_PAYLOAD_EVENTS 0ULL
+#endif
+
+// the handle that refers to no block, returned when the pool is empty
+#define ES_PAYLOAD_NONE 0
+
+/* prototypes for public functions */
+
+void ES_PayloadInit(void);
+uint16_t ES_PayloadAlloc(void);
+void *ES_PayloadGet(uint16_t Handle);
+bool ES_PayloadRetain(uint16_t Handle);
+void ES_PayloadRelease(uint16_t Handle);
+uint8_t ES_PayloadNumFree(void);
+
+#endif /* ES_Payload_H */
@@ -55,6 +55,15 @@
 // ISR to be reentrant.
 #define REENTRANT __reentrant
 
+// The macro 'ES_PERSISTENT' marks a variable that the start up code leaves
+// alone, so that it keeps its value through a watchdog reset. It must not
+// have an initializer. Where there is no such thing it evaluates to nothing.
+#ifdef __XC32
+#define ES_PERSISTENT __attribute__((persistent))
+#else
+#define ES_PERSISTENT
+#endif
+
 // these macros provide the wrappers for critical regions, where ints will be off
 // but the state of the interrupt enable prior to entry will be restored.
 // allocation of temp var for saving interrupt enable status should be defined
@@ -83,6 +92,15 @@ extern  uint8_t _INTCON_temp;
 #define ExitCritical()
 #endif
 
+// the MIPS32 cores in the PIC32 have a count leading zeros instruction (clz)
+// that GCC based compilers, XC32 included, emit for __builtin_clz. With this
+// defined, ES_GetMSBitSet becomes a single instruction instead of a walk
+// through the nybble table in ES_Run's dispatch. The timer tick keeps the
+// table either way. Comment it out to force the portable table.
+#if defined(__GNUC__)
+#define ES_HAS_CLZ
+#endif
+
 /* Rate constants for programming the SysTick Period to generate tick interrupts.
    These assume that we are using the M4K core timer running at 20MHz. Even
    thought the processor clock is 40MHz the core timer increments every other 
@@ -117,8 +135,14 @@ void _HW_PIC32Init(void);
 void _HW_Timer_Init(const TimerRate_t Rate);
 bool _HW_Process_Pending_Ints(void);
 uint16_t _HW_GetTickCount(void);
+uint64_t _HW_GetTickCount64(void);
+uint32_t _HW_GetCycleCount(void);
+void _HW_WatchdogInit(void);
+void _HW_WatchdogClear(void);
+bool _HW_WatchdogCausedReset(void);
 void _HW_ConsoleInit(void);
 void _HW_SysTickIntHandler(void);
+void _HW_Idle(void);
 
 // and the one Framework function that we define here
 uint16_t ES_Timer_GetTime(void);
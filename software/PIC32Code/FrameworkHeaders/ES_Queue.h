@@ -24,10 +24,22 @@
 
 uint8_t ES_InitQueue(ES_Event_t *pBlock, uint8_t BlockSize);
 bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
+bool ES_EnQueueFIFOInCritical(ES_Event_t *pBlock, ES_Event_t Event2Add);
+bool ES_ReplaceInCritical(ES_Event_t *pBlock, ES_Event_t NewEvent,
+    ES_Event_t *pOldEvent);
 bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
+bool ES_EnQueueFrontInCritical(ES_Event_t *pBlock, const ES_Event_t *pEvents,
+    uint8_t NumEvents);
 uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
+uint8_t ES_DeQueueBatch(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents);
+uint8_t ES_DeQueueMatching(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents, ES_EventType_t WhichType);
+uint8_t ES_PeekMatching(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents, ES_EventType_t WhichType);
 //void EF_FlushQueue( unsigned char * pBlock );
 bool ES_IsQueueEmpty(ES_Event_t *pBlock);
+uint8_t ES_QueueDepth(ES_Event_t *pBlock);
 
 #endif /*ES_Queue_H */
 
@@ -0,0 +1,52 @@
+/****************************************************************************
+ Module
+     ES_RingQueue.h
+ Description
+     header file for the mask indexed event queues. A ring queue holds a
+     power of 2 number of events, up to 32768, and is declared with
+     ES_RING_QUEUE so that a bad size is caught by the compiler.
+ Notes
+     a service picks one in ES_Configure.h by defining SERV_n_RING_QUEUE
+*****************************************************************************/
+#ifndef ES_RingQueue_H
+#define ES_RingQueue_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+#include "ES_General.h"
+
+#define ES_RING_QUEUE_MAX_SIZE 32768U
+
+typedef struct
+{
+  uint16_t Mask;                  // size - 1
+  volatile uint16_t Head;         // index of the oldest entry
+  volatile uint16_t NumEntries;
+  ES_Event_t *pSlots;
+}ES_RingQueue_t;
+
+// declares a static, empty ring queue called Name with room for Size events
+#define ES_RING_QUEUE(Name, Size)                                           \
+  ES_STATIC_ASSERT(ES_IS_POW2(Size) && ((Size) <= ES_RING_QUEUE_MAX_SIZE),  \
+      Name##_size_must_be_a_power_of_2);                                    \
+  static ES_Event_t Name##Slots[(Size)];                                    \
+  static ES_RingQueue_t Name = { (Size) - 1, 0, 0, Name##Slots }
+
+/* prototypes for public functions */
+
+void ES_RingInit(ES_RingQueue_t *pQueue);
+bool ES_RingEnQueueFIFO(ES_RingQueue_t *pQueue, ES_Event_t Event2Add);
+bool ES_RingEnQueueFIFOInCritical(ES_RingQueue_t *pQueue,
+    ES_Event_t Event2Add);
+bool ES_RingReplaceInCritical(ES_RingQueue_t *pQueue, ES_Event_t NewEvent,
+    ES_Event_t *pOldEvent);
+bool ES_RingEnQueueLIFO(ES_RingQueue_t *pQueue, ES_Event_t Event2Add);
+bool ES_RingEnQueueFrontInCritical(ES_RingQueue_t *pQueue,
+    const ES_Event_t *pEvents, uint16_t NumEvents);
+uint16_t ES_RingDeQueue(ES_RingQueue_t *pQueue, ES_Event_t *pReturnEvent);
+uint16_t ES_RingDeQueueBatch(ES_RingQueue_t *pQueue, ES_Event_t *pDest,
+    uint16_t MaxEvents);
+bool ES_RingIsEmpty(ES_RingQueue_t *pQueue);
+uint16_t ES_RingDepth(ES_RingQueue_t *pQueue);
+
+#endif /* ES_RingQueue_H */
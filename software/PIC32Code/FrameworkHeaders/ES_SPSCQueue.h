@@ -0,0 +1,35 @@
+/****************************************************************************
+ Module
+     ES_SPSCQueue.h
+ Description
+     header file for the single producer, single consumer event queues used
+     to carry events from an interrupt to a service without turning
+     interrupts off
+ Notes
+     one ISR writes, ES_Run reads. The size must be a power of 2, no larger
+     than 32768.
+*****************************************************************************/
+#ifndef ES_SPSCQueue_H
+#define ES_SPSCQueue_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef struct
+{
+  volatile uint16_t Head;   // next slot to write, only the producer moves it
+  volatile uint16_t Tail;   // next slot to read, only the consumer moves it
+  uint16_t Mask;            // size - 1
+  ES_Event_t *pSlots;
+}ES_SPSCQueue_t;
+
+/* prototypes for public functions */
+
+bool ES_SPSCInit(ES_SPSCQueue_t *pQueue, ES_Event_t *pSlots, uint16_t Size);
+bool ES_SPSCEnQueue(ES_SPSCQueue_t *pQueue, ES_Event_t Event2Add);
+bool ES_SPSCDeQueue(ES_SPSCQueue_t *pQueue, ES_Event_t *pReturnEvent);
+uint16_t ES_SPSCDeQueueBatch(ES_SPSCQueue_t *pQueue, ES_Event_t *pDest,
+    uint16_t MaxEvents);
+bool ES_SPSCIsEmpty(ES_SPSCQueue_t *pQueue);
+
+#endif /* ES_SPSCQueue_H */
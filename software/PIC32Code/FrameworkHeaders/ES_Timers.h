@@ -42,13 +42,28 @@ typedef enum
   ES_Timer_NOT_ACTIVE = 0
 }ES_TimerReturn_t;
 
+// a timer handed out by ES_Timer_Alloc, usable wherever a timer number is
+typedef uint8_t ES_TimerHandle_t;
+#define ES_TIMER_NO_HANDLE 0xFF
+// the timer number in an ES_TIMEOUT's EventParam, for a dynamic timer the
+// high byte holds its generation
+#define ES_TIMER_HANDLE(Param) ((ES_TimerHandle_t)((Param) & 0xFF))
+
 void ES_Timer_Init(TimerRate_t Rate);
 void ES_Timer_Tick_Resp(void);
-ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime);
-ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime);
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint32_t NewTime);
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint32_t NewTime);
 ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num);
 ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num);
+ES_TimerReturn_t ES_Timer_InitPeriodic(uint8_t Num, uint32_t Period);
+uint16_t ES_Timer_GetOverruns(uint8_t Num);
+ES_TimerHandle_t ES_Timer_Alloc(uint8_t WhichService);
+ES_TimerReturn_t ES_Timer_Free(ES_TimerHandle_t Handle);
+bool ES_Timer_TimeoutDispatched(uint16_t Param);
 uint16_t ES_Timer_GetTime(void);
+uint64_t ES_Timer_GetTime64(void);
+uint32_t ES_Timer_GetTicksToNextTimeout(void);
+uint32_t ES_Timer_SkipTicks(uint32_t NumTicks);
 
 #endif   /* ES_Timers_H */
 /*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,53 @@
+/****************************************************************************
+ Module
+     ES_Trace.h
+ Description
+     header file for the flight recorder, a ring of the last ES_TRACE_SIZE
+     posts, dispatches and timer expiries, dumped over the terminal in
+     binary for HostPort/TraceDecode to turn into a Chrome trace
+ Notes
+     only built with ES_TRACE defined in ES_Configure.h. The dump is a
+     header, then the records oldest first, all little endian:
+       'E' 'S' 'T' 'R', version (1 byte), record size (1 byte),
+       count of records (2 bytes), core timer counts per us (2 bytes)
+     and each record is
+       time in core timer counts (4 bytes), EventParam (2 bytes),
+       EventType (1 byte), kind in the top 2 bits and service in the low 6
+*****************************************************************************/
+#ifndef ES_Trace_H
+#define ES_Trace_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+#define ES_TRACE_VERSION 1
+#define ES_TRACE_RECORD_SIZE 8
+
+// the service in a record that is not about any one service
+#define ES_TRACE_NO_SERVICE 0x3F
+
+typedef enum
+{
+  ES_TRACE_POST = 0,    // the service's queue took the event
+  ES_TRACE_START,       // the service's run function was called with it, a
+                        // batch has one START per event
+  ES_TRACE_END,         // the run function returned
+  ES_TRACE_TIMEOUT      // timer EventParam expired, before its post
+}ES_TraceKind_t;
+
+typedef struct
+{
+  uint32_t Time;          // _HW_GetCycleCount
+  uint16_t EventParam;
+  uint8_t  EventType;
+  uint8_t  KindService;   // kind << 6 | service
+}ES_TraceRecord_t;
+
+/* prototypes for public functions */
+
+void ES_TraceRecord(ES_TraceKind_t Kind, uint8_t WhichService,
+    ES_Event_t ThisEvent);
+void ES_TraceDump(void);
+
+#endif /* ES_Trace_H */
@@ -27,10 +27,15 @@
 /*--------------------------- External Variables --------------------------*/
 
 /*----------------------------- Module Defines ----------------------------*/
+// events moved per splice onto the service's queue, which bounds the stack a
+// recall takes. A recall no bigger than this is one splice.
+#define RECALL_CHUNK 8
 
 /*------------------------------ Module Types -----------------------------*/
 
 /*---------------------------- Module Functions ---------------------------*/
+static bool Recall(uint8_t WhichService, ES_Event_t *pBlock,
+    ES_EventType_t WhichType);
 
 /*---------------------------- Module Variables ---------------------------*/
 
@@ -45,28 +50,92 @@
  Returns
      bool true if an event was recalled, false if no event was left in queue
  Description
-     pulls all events off the deferral queue if any are available. If there was
-     something in the queue, then it posts it LIFO fashion to the queue
-     indicated by WhichService
+     pulls all events off the deferral queue if any are available and puts
+     them at the front of the queue indicated by WhichService, oldest first,
+     in the order they were deferred
  Notes
-     None.
+     all or nothing: if the service's queue does not have room for every
+     deferred event, they all stay deferred
  Author
      J. Edward Carryer, 11/20/13 16:49
 ****************************************************************************/
 bool ES_RecallEvents(uint8_t WhichService, ES_Event_t *pBlock)
 {
-  ES_Event_t  RecalledEvent;
-  bool      WereEventsPulled = false;
-  // recall any events from the queue
-  do
+  return Recall(WhichService, pBlock, ES_NO_EVENT);
+}
+
+/****************************************************************************
+ Function
+     ES_RecallEventsOfType
+ Parameters
+      uint8_t WhichService, number of the service to post Recalled event to
+      ES_Event * pBlock, pointer to the block of memory that implements the
+        Defer/Recall queue
+      ES_EventType_t WhichType, the type of event to recall
+ Returns
+     bool true if an event was recalled, false if none of that type was left
+     in the queue
+ Description
+     ES_RecallEvents for the events of one type only, the others stay
+     deferred in their order, so that a service can take back just what it
+     can handle in its new state
+ Notes
+     all or nothing, like ES_RecallEvents
+****************************************************************************/
+bool ES_RecallEventsOfType(uint8_t WhichService, ES_Event_t *pBlock,
+    ES_EventType_t WhichType)
+{
+  if (WhichType == ES_NO_EVENT)
+  {
+    return false;
+  }
+  return Recall(WhichService, pBlock, WhichType);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// moves the deferred events of WhichType (ES_NO_EVENT for all) to the front
+// of the service's queue. ES_DeferEvent adds at the front, so the deferral
+// queue holds the newest first: each chunk is reversed and spliced ahead
+// of the newer chunks already moved, which leaves the oldest at the front.
+// A part recalled would run ahead of older events left deferred, so the
+// service's queue must have room for the lot before any are moved. Each
+// chunk is only taken off the deferral queue once the splice has it.
+static bool Recall(uint8_t WhichService, ES_Event_t *pBlock,
+    ES_EventType_t WhichType)
+{
+  ES_Event_t  Chunk[RECALL_CHUNK];
+  ES_Event_t  Swap;
+  uint8_t     NumLeft;
+  uint8_t     NumTaken;
+  uint8_t     i;
+  bool        WereEventsPulled = false;
+
+  NumLeft = ES_PeekMatching(pBlock, NULL, UINT8_MAX, WhichType);
+  if ((NumLeft == 0) || (NumLeft > ES_GetQueueRoom(WhichService)))
+  {
+    return false;
+  }
+  while (NumLeft > 0)
   {
-    ES_DeQueue(pBlock, &RecalledEvent);
-    if (RecalledEvent.EventType != ES_NO_EVENT)
+    NumTaken = ES_PeekMatching(pBlock, Chunk, RECALL_CHUNK, WhichType);
+    for (i = 0; i < NumTaken / 2; i++)
+    {
+      Swap                      = Chunk[i];
+      Chunk[i]                  = Chunk[NumTaken - 1 - i];
+      Chunk[NumTaken - 1 - i]   = Swap;
+    }
+    if (!ES_PostToServiceFront(WhichService, Chunk, NumTaken))
     {
-      ES_PostToServiceLIFO(WhichService, RecalledEvent);
-      WereEventsPulled = true;
+      // only an interrupt posting since the room was checked gets here,
+      // what is left stays deferred as it was
+      break;
     }
-  } while (RecalledEvent.EventType != ES_NO_EVENT);
+    ES_DeQueueMatching(pBlock, Chunk, NumTaken, WhichType);
+    NumLeft -= NumTaken;
+    WereEventsPulled = true;
+  }
   return WereEventsPulled;
 }
 
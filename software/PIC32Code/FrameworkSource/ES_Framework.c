@@ -30,10 +30,15 @@
 #include "../FrameworkHeaders/ES_Configure.h"
 #include "../FrameworkHeaders/ES_Framework.h"
 #include "../FrameworkHeaders/ES_Queue.h"
+#include "../FrameworkHeaders/ES_RingQueue.h"
+#include "../FrameworkHeaders/ES_SPSCQueue.h"
+#include "../FrameworkHeaders/ES_Payload.h"
+#include "../FrameworkHeaders/ES_Trace.h"
 #include "../FrameworkHeaders/ES_LookupTables.h"
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_General.h"
 #include "../FrameworkHeaders/ES_CheckEvents.h"
+#include "../FrameworkHeaders/dbprintf.h"
 // Include the header files for the Service modules.
 // This gets you the prototypes for the public service functions.
 
@@ -49,29 +54,81 @@
 #error "ES_Configure.h was not included"
 #endif
 
+#if NUM_SERVICES > MAX_NUM_SERVICES
+#error "NUM_SERVICES must not be more than MAX_NUM_SERVICES"
+#endif
+#if MAX_NUM_SERVICES > 64
+#error "the framework supports at most 64 services"
+#endif
+
 /*----------------------------- Module Defines ----------------------------*/
 typedef bool      InitFunc_t (uint8_t Priority);
 typedef ES_Event_t  RunFunc_t (ES_Event_t ThisEvent);
 
+typedef ES_Event_t  BatchRunFunc_t (const ES_Event_t *pEvents,
+    uint8_t NumEvents);
+
 typedef InitFunc_t  *pInitFunc;
 typedef RunFunc_t   *pRunFunc;
+typedef BatchRunFunc_t *pBatchRunFunc;
 
 #define NULL_INIT_FUNC ((pInitFunc)0)
+#define NULL_BATCH_RUN ((pBatchRunFunc)0)
 
 typedef struct
 {
   InitFunc_t *InitFunc;       // Service Initialization function
   RunFunc_t *RunFunc;         // Service Run function
+  BatchRunFunc_t *BatchRunFunc; // optional, takes a whole queue at a time
 }ES_ServDesc_t;
 
 typedef struct
 {
   ES_Event_t *pMem;       // pointer to the memory
   uint8_t Size;         // how big is it
+  ES_RingQueue_t *pRing;  // or, if not NULL, the ring queue used instead
 }ES_QueueDesc_t;
 
+// what became of a post
+typedef enum
+{
+  PostDropped,        // the queue was full
+  PostQueued,         // the event took a new entry
+  PostCoalesced       // it overwrote a waiting event of the same type
+}PostResult_t;
+
 /*---------------------------- Module Functions ---------------------------*/
 //static bool CheckSystemEvents( void );
+static bool CheckISRQueues(void);
+static bool DeQueueISREvent(uint8_t WhichService, ES_Event_t *pEvent);
+static void InitQueue(uint8_t WhichService);
+static bool EnQueueFIFO(uint8_t WhichService, ES_Event_t Event2Add);
+static bool EnQueueLIFO(uint8_t WhichService, ES_Event_t Event2Add);
+static PostResult_t EnQueueFIFOInCritical(uint8_t WhichService,
+    ES_Event_t Event2Add, ES_Event_t *pReplaced);
+static bool IsCoalesced(uint8_t WhichService, ES_EventType_t EventType);
+static void NotePost(uint8_t WhichService, ES_Event_t Event2Add,
+    PostResult_t Result, bool AtFront, const ES_Event_t *pReplaced);
+static uint16_t DeQueue(uint8_t WhichService, ES_Event_t *pReturnEvent);
+static uint8_t DeQueueBatch(uint8_t WhichService, ES_Event_t *pDest,
+    uint8_t MaxEvents);
+static bool IsQueueEmpty(uint8_t WhichService);
+static uint16_t QueueDepth(uint8_t WhichService);
+static uint16_t QueueCapacity(uint8_t WhichService);
+static void CountPost(uint8_t WhichService, PostResult_t Result);
+#ifdef ES_PROFILE
+static void RecordRunTime(uint8_t WhichService, uint32_t Counts);
+#endif
+#ifdef ES_RUN_BUDGET
+static void LogOverrun(uint8_t WhichService, ES_Event_t ThisEvent,
+    uint32_t Counts);
+#endif
+#ifdef EDF_DISPATCH
+static uint8_t GetEarliestDeadline(void);
+static void NoteDispatched(uint8_t WhichService);
+static void AddStamp(uint8_t WhichService, bool AtFront);
+static void DropStamps(uint8_t WhichService, uint8_t NumStamps);
+#endif
 
 /*---------------------------- Module Variables ---------------------------*/
 /****************************************************************************/
@@ -81,368 +138,4037 @@ typedef struct
 // The first entry, at index 0, is the lowest priority, with increasing
 // priority with higher indices
 
+// services that do not name a batch run function get one event per call
+#ifndef SERV_0_BATCH_RUN
+#define SERV_0_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_1_BATCH_RUN
+#define SERV_1_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_2_BATCH_RUN
+#define SERV_2_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_3_BATCH_RUN
+#define SERV_3_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_4_BATCH_RUN
+#define SERV_4_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_5_BATCH_RUN
+#define SERV_5_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_6_BATCH_RUN
+#define SERV_6_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_7_BATCH_RUN
+#define SERV_7_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_8_BATCH_RUN
+#define SERV_8_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_9_BATCH_RUN
+#define SERV_9_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_10_BATCH_RUN
+#define SERV_10_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_11_BATCH_RUN
+#define SERV_11_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_12_BATCH_RUN
+#define SERV_12_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_13_BATCH_RUN
+#define SERV_13_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_14_BATCH_RUN
+#define SERV_14_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_15_BATCH_RUN
+#define SERV_15_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_16_BATCH_RUN
+#define SERV_16_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_17_BATCH_RUN
+#define SERV_17_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_18_BATCH_RUN
+#define SERV_18_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_19_BATCH_RUN
+#define SERV_19_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_20_BATCH_RUN
+#define SERV_20_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_21_BATCH_RUN
+#define SERV_21_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_22_BATCH_RUN
+#define SERV_22_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_23_BATCH_RUN
+#define SERV_23_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_24_BATCH_RUN
+#define SERV_24_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_25_BATCH_RUN
+#define SERV_25_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_26_BATCH_RUN
+#define SERV_26_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_27_BATCH_RUN
+#define SERV_27_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_28_BATCH_RUN
+#define SERV_28_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_29_BATCH_RUN
+#define SERV_29_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_30_BATCH_RUN
+#define SERV_30_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_31_BATCH_RUN
+#define SERV_31_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_32_BATCH_RUN
+#define SERV_32_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_33_BATCH_RUN
+#define SERV_33_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_34_BATCH_RUN
+#define SERV_34_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_35_BATCH_RUN
+#define SERV_35_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_36_BATCH_RUN
+#define SERV_36_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_37_BATCH_RUN
+#define SERV_37_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_38_BATCH_RUN
+#define SERV_38_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_39_BATCH_RUN
+#define SERV_39_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_40_BATCH_RUN
+#define SERV_40_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_41_BATCH_RUN
+#define SERV_41_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_42_BATCH_RUN
+#define SERV_42_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_43_BATCH_RUN
+#define SERV_43_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_44_BATCH_RUN
+#define SERV_44_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_45_BATCH_RUN
+#define SERV_45_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_46_BATCH_RUN
+#define SERV_46_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_47_BATCH_RUN
+#define SERV_47_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_48_BATCH_RUN
+#define SERV_48_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_49_BATCH_RUN
+#define SERV_49_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_50_BATCH_RUN
+#define SERV_50_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_51_BATCH_RUN
+#define SERV_51_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_52_BATCH_RUN
+#define SERV_52_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_53_BATCH_RUN
+#define SERV_53_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_54_BATCH_RUN
+#define SERV_54_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_55_BATCH_RUN
+#define SERV_55_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_56_BATCH_RUN
+#define SERV_56_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_57_BATCH_RUN
+#define SERV_57_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_58_BATCH_RUN
+#define SERV_58_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_59_BATCH_RUN
+#define SERV_59_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_60_BATCH_RUN
+#define SERV_60_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_61_BATCH_RUN
+#define SERV_61_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_62_BATCH_RUN
+#define SERV_62_BATCH_RUN NULL_BATCH_RUN
+#endif
+#ifndef SERV_63_BATCH_RUN
+#define SERV_63_BATCH_RUN NULL_BATCH_RUN
+#endif
+
 static ES_ServDesc_t const ServDescList[] =
-{ { SERV_0_INIT, SERV_0_RUN } /* lowest priority  always present */
+{ { SERV_0_INIT, SERV_0_RUN, SERV_0_BATCH_RUN } /* lowest priority  always present */
 #if NUM_SERVICES > 1
-  , { SERV_1_INIT, SERV_1_RUN }
+  , { SERV_1_INIT, SERV_1_RUN, SERV_1_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 2
-  , { SERV_2_INIT, SERV_2_RUN }
+  , { SERV_2_INIT, SERV_2_RUN, SERV_2_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 3
-  , { SERV_3_INIT, SERV_3_RUN }
+  , { SERV_3_INIT, SERV_3_RUN, SERV_3_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 4
-  , { SERV_4_INIT, SERV_4_RUN }
+  , { SERV_4_INIT, SERV_4_RUN, SERV_4_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 5
-  , { SERV_5_INIT, SERV_5_RUN }
+  , { SERV_5_INIT, SERV_5_RUN, SERV_5_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 6
-  , { SERV_6_INIT, SERV_6_RUN }
+  , { SERV_6_INIT, SERV_6_RUN, SERV_6_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 7
-  , { SERV_7_INIT, SERV_7_RUN }
+  , { SERV_7_INIT, SERV_7_RUN, SERV_7_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 8
-  , { SERV_8_INIT, SERV_8_RUN }
+  , { SERV_8_INIT, SERV_8_RUN, SERV_8_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 9
-  , { SERV_9_INIT, SERV_9_RUN }
+  , { SERV_9_INIT, SERV_9_RUN, SERV_9_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 10
-  , { SERV_10_INIT, SERV_10_RUN }
+  , { SERV_10_INIT, SERV_10_RUN, SERV_10_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 11
-  , { SERV_11_INIT, SERV_11_RUN }
+  , { SERV_11_INIT, SERV_11_RUN, SERV_11_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 12
-  , { SERV_12_INIT, SERV_12_RUN }
+  , { SERV_12_INIT, SERV_12_RUN, SERV_12_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 13
-  , { SERV_13_INIT, SERV_13_RUN }
+  , { SERV_13_INIT, SERV_13_RUN, SERV_13_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 14
-  , { SERV_14_INIT, SERV_14_RUN }
+  , { SERV_14_INIT, SERV_14_RUN, SERV_14_BATCH_RUN }
 #endif
 #if NUM_SERVICES > 15
-  , { SERV_15_INIT, SERV_15_RUN }
+  , { SERV_15_INIT, SERV_15_RUN, SERV_15_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 16
+  , { SERV_16_INIT, SERV_16_RUN, SERV_16_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 17
+  , { SERV_17_INIT, SERV_17_RUN, SERV_17_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 18
+  , { SERV_18_INIT, SERV_18_RUN, SERV_18_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 19
+  , { SERV_19_INIT, SERV_19_RUN, SERV_19_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 20
+  , { SERV_20_INIT, SERV_20_RUN, SERV_20_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 21
+  , { SERV_21_INIT, SERV_21_RUN, SERV_21_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 22
+  , { SERV_22_INIT, SERV_22_RUN, SERV_22_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 23
+  , { SERV_23_INIT, SERV_23_RUN, SERV_23_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 24
+  , { SERV_24_INIT, SERV_24_RUN, SERV_24_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 25
+  , { SERV_25_INIT, SERV_25_RUN, SERV_25_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 26
+  , { SERV_26_INIT, SERV_26_RUN, SERV_26_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 27
+  , { SERV_27_INIT, SERV_27_RUN, SERV_27_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 28
+  , { SERV_28_INIT, SERV_28_RUN, SERV_28_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 29
+  , { SERV_29_INIT, SERV_29_RUN, SERV_29_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 30
+  , { SERV_30_INIT, SERV_30_RUN, SERV_30_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 31
+  , { SERV_31_INIT, SERV_31_RUN, SERV_31_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 32
+  , { SERV_32_INIT, SERV_32_RUN, SERV_32_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 33
+  , { SERV_33_INIT, SERV_33_RUN, SERV_33_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 34
+  , { SERV_34_INIT, SERV_34_RUN, SERV_34_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 35
+  , { SERV_35_INIT, SERV_35_RUN, SERV_35_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 36
+  , { SERV_36_INIT, SERV_36_RUN, SERV_36_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 37
+  , { SERV_37_INIT, SERV_37_RUN, SERV_37_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 38
+  , { SERV_38_INIT, SERV_38_RUN, SERV_38_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 39
+  , { SERV_39_INIT, SERV_39_RUN, SERV_39_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 40
+  , { SERV_40_INIT, SERV_40_RUN, SERV_40_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 41
+  , { SERV_41_INIT, SERV_41_RUN, SERV_41_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 42
+  , { SERV_42_INIT, SERV_42_RUN, SERV_42_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 43
+  , { SERV_43_INIT, SERV_43_RUN, SERV_43_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 44
+  , { SERV_44_INIT, SERV_44_RUN, SERV_44_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 45
+  , { SERV_45_INIT, SERV_45_RUN, SERV_45_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 46
+  , { SERV_46_INIT, SERV_46_RUN, SERV_46_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 47
+  , { SERV_47_INIT, SERV_47_RUN, SERV_47_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 48
+  , { SERV_48_INIT, SERV_48_RUN, SERV_48_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 49
+  , { SERV_49_INIT, SERV_49_RUN, SERV_49_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 50
+  , { SERV_50_INIT, SERV_50_RUN, SERV_50_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 51
+  , { SERV_51_INIT, SERV_51_RUN, SERV_51_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 52
+  , { SERV_52_INIT, SERV_52_RUN, SERV_52_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 53
+  , { SERV_53_INIT, SERV_53_RUN, SERV_53_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 54
+  , { SERV_54_INIT, SERV_54_RUN, SERV_54_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 55
+  , { SERV_55_INIT, SERV_55_RUN, SERV_55_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 56
+  , { SERV_56_INIT, SERV_56_RUN, SERV_56_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 57
+  , { SERV_57_INIT, SERV_57_RUN, SERV_57_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 58
+  , { SERV_58_INIT, SERV_58_RUN, SERV_58_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 59
+  , { SERV_59_INIT, SERV_59_RUN, SERV_59_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 60
+  , { SERV_60_INIT, SERV_60_RUN, SERV_60_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 61
+  , { SERV_61_INIT, SERV_61_RUN, SERV_61_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 62
+  , { SERV_62_INIT, SERV_62_RUN, SERV_62_BATCH_RUN }
+#endif
+#if NUM_SERVICES > 63
+  , { SERV_63_INIT, SERV_63_RUN, SERV_63_BATCH_RUN }
 #endif
 };
 
+#ifdef ES_RUN_BUDGET
 /****************************************************************************/
-// The queues for the services
-
-static ES_Event_t Queue0[SERV_0_QUEUE_SIZE + 1];
-#if NUM_SERVICES > 1
-static ES_Event_t Queue1[SERV_1_QUEUE_SIZE + 1];
+// The longest each service's run function may take per call before ES_Run
+// logs an overrun, SERV_n_BUDGET_US or ES_DEFAULT_BUDGET_US, held here in
+// core timer counts.
+#ifndef ES_DEFAULT_BUDGET_US
+#define ES_DEFAULT_BUDGET_US 1000
 #endif
-#if NUM_SERVICES > 2
-static ES_Event_t Queue2[SERV_2_QUEUE_SIZE + 1];
+#ifndef ES_OVERRUN_LOG_SIZE
+#define ES_OVERRUN_LOG_SIZE 8
 #endif
-#if NUM_SERVICES > 3
-static ES_Event_t Queue3[SERV_3_QUEUE_SIZE + 1];
+#ifndef SERV_0_BUDGET_US
+#define SERV_0_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 4
-static ES_Event_t Queue4[SERV_4_QUEUE_SIZE + 1];
+#ifndef SERV_1_BUDGET_US
+#define SERV_1_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 5
-static ES_Event_t Queue5[SERV_5_QUEUE_SIZE + 1];
+#ifndef SERV_2_BUDGET_US
+#define SERV_2_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 6
-static ES_Event_t Queue6[SERV_6_QUEUE_SIZE + 1];
+#ifndef SERV_3_BUDGET_US
+#define SERV_3_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 7
-static ES_Event_t Queue7[SERV_7_QUEUE_SIZE + 1];
+#ifndef SERV_4_BUDGET_US
+#define SERV_4_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 8
-static ES_Event_t Queue8[SERV_8_QUEUE_SIZE + 1];
+#ifndef SERV_5_BUDGET_US
+#define SERV_5_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 9
-static ES_Event_t Queue9[SERV_9_QUEUE_SIZE + 1];
+#ifndef SERV_6_BUDGET_US
+#define SERV_6_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 10
-static ES_Event_t Queue10[SERV_10_QUEUE_SIZE + 1];
+#ifndef SERV_7_BUDGET_US
+#define SERV_7_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 11
-static ES_Event_t Queue11[SERV_11_QUEUE_SIZE + 1];
+#ifndef SERV_8_BUDGET_US
+#define SERV_8_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 12
-static ES_Event_t Queue12[SERV_12_QUEUE_SIZE + 1];
+#ifndef SERV_9_BUDGET_US
+#define SERV_9_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 13
-static ES_Event_t Queue13[SERV_13_QUEUE_SIZE + 1];
+#ifndef SERV_10_BUDGET_US
+#define SERV_10_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 14
-static ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
+#ifndef SERV_11_BUDGET_US
+#define SERV_11_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
-#if NUM_SERVICES > 15
-static ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
+#ifndef SERV_12_BUDGET_US
+#define SERV_12_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_13_BUDGET_US
+#define SERV_13_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_14_BUDGET_US
+#define SERV_14_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_15_BUDGET_US
+#define SERV_15_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_16_BUDGET_US
+#define SERV_16_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_17_BUDGET_US
+#define SERV_17_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_18_BUDGET_US
+#define SERV_18_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_19_BUDGET_US
+#define SERV_19_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_20_BUDGET_US
+#define SERV_20_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_21_BUDGET_US
+#define SERV_21_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_22_BUDGET_US
+#define SERV_22_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_23_BUDGET_US
+#define SERV_23_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_24_BUDGET_US
+#define SERV_24_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_25_BUDGET_US
+#define SERV_25_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_26_BUDGET_US
+#define SERV_26_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_27_BUDGET_US
+#define SERV_27_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_28_BUDGET_US
+#define SERV_28_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_29_BUDGET_US
+#define SERV_29_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_30_BUDGET_US
+#define SERV_30_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_31_BUDGET_US
+#define SERV_31_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_32_BUDGET_US
+#define SERV_32_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_33_BUDGET_US
+#define SERV_33_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_34_BUDGET_US
+#define SERV_34_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_35_BUDGET_US
+#define SERV_35_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_36_BUDGET_US
+#define SERV_36_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_37_BUDGET_US
+#define SERV_37_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_38_BUDGET_US
+#define SERV_38_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_39_BUDGET_US
+#define SERV_39_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_40_BUDGET_US
+#define SERV_40_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_41_BUDGET_US
+#define SERV_41_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_42_BUDGET_US
+#define SERV_42_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_43_BUDGET_US
+#define SERV_43_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_44_BUDGET_US
+#define SERV_44_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_45_BUDGET_US
+#define SERV_45_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_46_BUDGET_US
+#define SERV_46_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_47_BUDGET_US
+#define SERV_47_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_48_BUDGET_US
+#define SERV_48_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_49_BUDGET_US
+#define SERV_49_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_50_BUDGET_US
+#define SERV_50_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_51_BUDGET_US
+#define SERV_51_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_52_BUDGET_US
+#define SERV_52_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_53_BUDGET_US
+#define SERV_53_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_54_BUDGET_US
+#define SERV_54_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_55_BUDGET_US
+#define SERV_55_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_56_BUDGET_US
+#define SERV_56_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_57_BUDGET_US
+#define SERV_57_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_58_BUDGET_US
+#define SERV_58_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_59_BUDGET_US
+#define SERV_59_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_60_BUDGET_US
+#define SERV_60_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_61_BUDGET_US
+#define SERV_61_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_62_BUDGET_US
+#define SERV_62_BUDGET_US ES_DEFAULT_BUDGET_US
+#endif
+#ifndef SERV_63_BUDGET_US
+#define SERV_63_BUDGET_US ES_DEFAULT_BUDGET_US
 #endif
 
-/****************************************************************************/
-// array of queue descriptors for posting by priority level
+#define BudgetCounts(Us) ((uint32_t)(Us) * ES_PROFILE_COUNTS_PER_US)
 
-static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
-  { Queue0, ARRAY_SIZE(Queue0) }
+static uint32_t const ServBudgets[] =
+{ BudgetCounts(SERV_0_BUDGET_US)
 #if NUM_SERVICES > 1
-  , { Queue1, ARRAY_SIZE(Queue1) }
+  , BudgetCounts(SERV_1_BUDGET_US)
 #endif
 #if NUM_SERVICES > 2
-  , { Queue2, ARRAY_SIZE(Queue2) }
+  , BudgetCounts(SERV_2_BUDGET_US)
 #endif
 #if NUM_SERVICES > 3
-  , { Queue3, ARRAY_SIZE(Queue3) }
+  , BudgetCounts(SERV_3_BUDGET_US)
 #endif
 #if NUM_SERVICES > 4
-  , { Queue4, ARRAY_SIZE(Queue4) }
+  , BudgetCounts(SERV_4_BUDGET_US)
 #endif
 #if NUM_SERVICES > 5
-  , { Queue5, ARRAY_SIZE(Queue5) }
+  , BudgetCounts(SERV_5_BUDGET_US)
 #endif
 #if NUM_SERVICES > 6
-  , { Queue6, ARRAY_SIZE(Queue6) }
+  , BudgetCounts(SERV_6_BUDGET_US)
 #endif
 #if NUM_SERVICES > 7
-  , { Queue7, ARRAY_SIZE(Queue7) }
+  , BudgetCounts(SERV_7_BUDGET_US)
 #endif
 #if NUM_SERVICES > 8
-  , { Queue8, ARRAY_SIZE(Queue8) }
+  , BudgetCounts(SERV_8_BUDGET_US)
 #endif
 #if NUM_SERVICES > 9
-  , { Queue9, ARRAY_SIZE(Queue9) }
+  , BudgetCounts(SERV_9_BUDGET_US)
 #endif
 #if NUM_SERVICES > 10
-  , { Queue10, ARRAY_SIZE(Queue10) }
+  , BudgetCounts(SERV_10_BUDGET_US)
 #endif
 #if NUM_SERVICES > 11
-  , { Queue11, ARRAY_SIZE(Queue11) }
+  , BudgetCounts(SERV_11_BUDGET_US)
 #endif
 #if NUM_SERVICES > 12
-  , { Queue12, ARRAY_SIZE(Queue12) }
+  , BudgetCounts(SERV_12_BUDGET_US)
 #endif
 #if NUM_SERVICES > 13
-  , { Queue13, ARRAY_SIZE(Queue13) }
+  , BudgetCounts(SERV_13_BUDGET_US)
 #endif
 #if NUM_SERVICES > 14
-  , { Queue14, ARRAY_SIZE(Queue14) }
+  , BudgetCounts(SERV_14_BUDGET_US)
 #endif
 #if NUM_SERVICES > 15
-  , { Queue15, ARRAY_SIZE(Queue15) }
+  , BudgetCounts(SERV_15_BUDGET_US)
 #endif
-};
-
-/****************************************************************************/
-// Variable used to keep track of which queues have events in them
-
-uint16_t Ready;
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-   ES_Initialize
- Parameters
-   TimerRate_t the rate at which to initialize the framework timer subsystem
- Returns
-   ES_Return_t : FailedPointer if any of the function pointers are NULL
-                 FailedInit if any of the initialization functions failed
- Description
-   Initialize all the services and tests for NULL pointers in the array
- Notes
-
- Author
-   J. Edward Carryer, 10/23/11,
-****************************************************************************/
-ES_Return_t ES_Initialize(TimerRate_t NewRate)
-{
-  uint8_t i;
-  ES_Timer_Init(NewRate);  // start up the timer subsystem
-  // loop through the list testing for NULL pointers and
-  for (i = 0; i < ARRAY_SIZE(ServDescList); i++)
-  {
-    if ((ServDescList[i].InitFunc == (pInitFunc)0) ||
-        (ServDescList[i].RunFunc == (pRunFunc)0))
-    {
-      return FailedPointer; // protect against NULL pointers
-    }
-    // and initializing the event queues (must happen before running inits)
-    ES_InitQueue(EventQueues[i].pMem, EventQueues[i].Size);
-    // executing the init functions
-    if (ServDescList[i].InitFunc(i) != true)
-    {
-      return FailedInit; // this is a failed initialization
-    }
-  }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-  _HW_DebugLines_Init();
+#if NUM_SERVICES > 16
+  , BudgetCounts(SERV_16_BUDGET_US)
 #endif
-  return Success;
-}
-
+#if NUM_SERVICES > 17
+  , BudgetCounts(SERV_17_BUDGET_US)
+#endif
+#if NUM_SERVICES > 18
+  , BudgetCounts(SERV_18_BUDGET_US)
+#endif
+#if NUM_SERVICES > 19
+  , BudgetCounts(SERV_19_BUDGET_US)
+#endif
+#if NUM_SERVICES > 20
+  , BudgetCounts(SERV_20_BUDGET_US)
+#endif
+#if NUM_SERVICES > 21
+  , BudgetCounts(SERV_21_BUDGET_US)
+#endif
+#if NUM_SERVICES > 22
+  , BudgetCounts(SERV_22_BUDGET_US)
+#endif
+#if NUM_SERVICES > 23
+  , BudgetCounts(SERV_23_BUDGET_US)
+#endif
+#if NUM_SERVICES > 24
+  , BudgetCounts(SERV_24_BUDGET_US)
+#endif
+#if NUM_SERVICES > 25
+  , BudgetCounts(SERV_25_BUDGET_US)
+#endif
+#if NUM_SERVICES > 26
+  , BudgetCounts(SERV_26_BUDGET_US)
+#endif
+#if NUM_SERVICES > 27
+  , BudgetCounts(SERV_27_BUDGET_US)
+#endif
+#if NUM_SERVICES > 28
+  , BudgetCounts(SERV_28_BUDGET_US)
+#endif
+#if NUM_SERVICES > 29
+  , BudgetCounts(SERV_29_BUDGET_US)
+#endif
+#if NUM_SERVICES > 30
+  , BudgetCounts(SERV_30_BUDGET_US)
+#endif
+#if NUM_SERVICES > 31
+  , BudgetCounts(SERV_31_BUDGET_US)
+#endif
+#if NUM_SERVICES > 32
+  , BudgetCounts(SERV_32_BUDGET_US)
+#endif
+#if NUM_SERVICES > 33
+  , BudgetCounts(SERV_33_BUDGET_US)
+#endif
+#if NUM_SERVICES > 34
+  , BudgetCounts(SERV_34_BUDGET_US)
+#endif
+#if NUM_SERVICES > 35
+  , BudgetCounts(SERV_35_BUDGET_US)
+#endif
+#if NUM_SERVICES > 36
+  , BudgetCounts(SERV_36_BUDGET_US)
+#endif
+#if NUM_SERVICES > 37
+  , BudgetCounts(SERV_37_BUDGET_US)
+#endif
+#if NUM_SERVICES > 38
+  , BudgetCounts(SERV_38_BUDGET_US)
+#endif
+#if NUM_SERVICES > 39
+  , BudgetCounts(SERV_39_BUDGET_US)
+#endif
+#if NUM_SERVICES > 40
+  , BudgetCounts(SERV_40_BUDGET_US)
+#endif
+#if NUM_SERVICES > 41
+  , BudgetCounts(SERV_41_BUDGET_US)
+#endif
+#if NUM_SERVICES > 42
+  , BudgetCounts(SERV_42_BUDGET_US)
+#endif
+#if NUM_SERVICES > 43
+  , BudgetCounts(SERV_43_BUDGET_US)
+#endif
+#if NUM_SERVICES > 44
+  , BudgetCounts(SERV_44_BUDGET_US)
+#endif
+#if NUM_SERVICES > 45
+  , BudgetCounts(SERV_45_BUDGET_US)
+#endif
+#if NUM_SERVICES > 46
+  , BudgetCounts(SERV_46_BUDGET_US)
+#endif
+#if NUM_SERVICES > 47
+  , BudgetCounts(SERV_47_BUDGET_US)
+#endif
+#if NUM_SERVICES > 48
+  , BudgetCounts(SERV_48_BUDGET_US)
+#endif
+#if NUM_SERVICES > 49
+  , BudgetCounts(SERV_49_BUDGET_US)
+#endif
+#if NUM_SERVICES > 50
+  , BudgetCounts(SERV_50_BUDGET_US)
+#endif
+#if NUM_SERVICES > 51
+  , BudgetCounts(SERV_51_BUDGET_US)
+#endif
+#if NUM_SERVICES > 52
+  , BudgetCounts(SERV_52_BUDGET_US)
+#endif
+#if NUM_SERVICES > 53
+  , BudgetCounts(SERV_53_BUDGET_US)
+#endif
+#if NUM_SERVICES > 54
+  , BudgetCounts(SERV_54_BUDGET_US)
+#endif
+#if NUM_SERVICES > 55
+  , BudgetCounts(SERV_55_BUDGET_US)
+#endif
+#if NUM_SERVICES > 56
+  , BudgetCounts(SERV_56_BUDGET_US)
+#endif
+#if NUM_SERVICES > 57
+  , BudgetCounts(SERV_57_BUDGET_US)
+#endif
+#if NUM_SERVICES > 58
+  , BudgetCounts(SERV_58_BUDGET_US)
+#endif
+#if NUM_SERVICES > 59
+  , BudgetCounts(SERV_59_BUDGET_US)
+#endif
+#if NUM_SERVICES > 60
+  , BudgetCounts(SERV_60_BUDGET_US)
+#endif
+#if NUM_SERVICES > 61
+  , BudgetCounts(SERV_61_BUDGET_US)
+#endif
+#if NUM_SERVICES > 62
+  , BudgetCounts(SERV_62_BUDGET_US)
+#endif
+#if NUM_SERVICES > 63
+  , BudgetCounts(SERV_63_BUDGET_US)
+#endif
+};
+#endif
+
+#if defined(ES_BUDGET_WATCHDOG) && !defined(ES_RUN_BUDGET)
+#error ES_BUDGET_WATCHDOG needs ES_RUN_BUDGET
+#endif
+
+#ifdef EDF_DISPATCH
+/****************************************************************************/
+// Relative deadlines, in ticks, for earliest deadline first dispatch. An
+// event's deadline runs from when it was posted; services that do not set
+// SERV_n_DEADLINE get EDF_DEFAULT_DEADLINE.
+#ifndef EDF_DEFAULT_DEADLINE
+#define EDF_DEFAULT_DEADLINE 1000
+#endif
+#ifndef EDF_STAMP_DEPTH
+#define EDF_STAMP_DEPTH 8
+#endif
+#ifndef SERV_0_DEADLINE
+#define SERV_0_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_1_DEADLINE
+#define SERV_1_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_2_DEADLINE
+#define SERV_2_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_3_DEADLINE
+#define SERV_3_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_4_DEADLINE
+#define SERV_4_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_5_DEADLINE
+#define SERV_5_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_6_DEADLINE
+#define SERV_6_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_7_DEADLINE
+#define SERV_7_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_8_DEADLINE
+#define SERV_8_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_9_DEADLINE
+#define SERV_9_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_10_DEADLINE
+#define SERV_10_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_11_DEADLINE
+#define SERV_11_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_12_DEADLINE
+#define SERV_12_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_13_DEADLINE
+#define SERV_13_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_14_DEADLINE
+#define SERV_14_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_15_DEADLINE
+#define SERV_15_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_16_DEADLINE
+#define SERV_16_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_17_DEADLINE
+#define SERV_17_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_18_DEADLINE
+#define SERV_18_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_19_DEADLINE
+#define SERV_19_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_20_DEADLINE
+#define SERV_20_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_21_DEADLINE
+#define SERV_21_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_22_DEADLINE
+#define SERV_22_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_23_DEADLINE
+#define SERV_23_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_24_DEADLINE
+#define SERV_24_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_25_DEADLINE
+#define SERV_25_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_26_DEADLINE
+#define SERV_26_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_27_DEADLINE
+#define SERV_27_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_28_DEADLINE
+#define SERV_28_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_29_DEADLINE
+#define SERV_29_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_30_DEADLINE
+#define SERV_30_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_31_DEADLINE
+#define SERV_31_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_32_DEADLINE
+#define SERV_32_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_33_DEADLINE
+#define SERV_33_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_34_DEADLINE
+#define SERV_34_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_35_DEADLINE
+#define SERV_35_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_36_DEADLINE
+#define SERV_36_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_37_DEADLINE
+#define SERV_37_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_38_DEADLINE
+#define SERV_38_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_39_DEADLINE
+#define SERV_39_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_40_DEADLINE
+#define SERV_40_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_41_DEADLINE
+#define SERV_41_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_42_DEADLINE
+#define SERV_42_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_43_DEADLINE
+#define SERV_43_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_44_DEADLINE
+#define SERV_44_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_45_DEADLINE
+#define SERV_45_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_46_DEADLINE
+#define SERV_46_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_47_DEADLINE
+#define SERV_47_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_48_DEADLINE
+#define SERV_48_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_49_DEADLINE
+#define SERV_49_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_50_DEADLINE
+#define SERV_50_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_51_DEADLINE
+#define SERV_51_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_52_DEADLINE
+#define SERV_52_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_53_DEADLINE
+#define SERV_53_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_54_DEADLINE
+#define SERV_54_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_55_DEADLINE
+#define SERV_55_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_56_DEADLINE
+#define SERV_56_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_57_DEADLINE
+#define SERV_57_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_58_DEADLINE
+#define SERV_58_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_59_DEADLINE
+#define SERV_59_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_60_DEADLINE
+#define SERV_60_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_61_DEADLINE
+#define SERV_61_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_62_DEADLINE
+#define SERV_62_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+#ifndef SERV_63_DEADLINE
+#define SERV_63_DEADLINE EDF_DEFAULT_DEADLINE
+#endif
+
+static uint16_t const ServDeadlines[] =
+{ SERV_0_DEADLINE
+#if NUM_SERVICES > 1
+  , SERV_1_DEADLINE
+#endif
+#if NUM_SERVICES > 2
+  , SERV_2_DEADLINE
+#endif
+#if NUM_SERVICES > 3
+  , SERV_3_DEADLINE
+#endif
+#if NUM_SERVICES > 4
+  , SERV_4_DEADLINE
+#endif
+#if NUM_SERVICES > 5
+  , SERV_5_DEADLINE
+#endif
+#if NUM_SERVICES > 6
+  , SERV_6_DEADLINE
+#endif
+#if NUM_SERVICES > 7
+  , SERV_7_DEADLINE
+#endif
+#if NUM_SERVICES > 8
+  , SERV_8_DEADLINE
+#endif
+#if NUM_SERVICES > 9
+  , SERV_9_DEADLINE
+#endif
+#if NUM_SERVICES > 10
+  , SERV_10_DEADLINE
+#endif
+#if NUM_SERVICES > 11
+  , SERV_11_DEADLINE
+#endif
+#if NUM_SERVICES > 12
+  , SERV_12_DEADLINE
+#endif
+#if NUM_SERVICES > 13
+  , SERV_13_DEADLINE
+#endif
+#if NUM_SERVICES > 14
+  , SERV_14_DEADLINE
+#endif
+#if NUM_SERVICES > 15
+  , SERV_15_DEADLINE
+#endif
+#if NUM_SERVICES > 16
+  , SERV_16_DEADLINE
+#endif
+#if NUM_SERVICES > 17
+  , SERV_17_DEADLINE
+#endif
+#if NUM_SERVICES > 18
+  , SERV_18_DEADLINE
+#endif
+#if NUM_SERVICES > 19
+  , SERV_19_DEADLINE
+#endif
+#if NUM_SERVICES > 20
+  , SERV_20_DEADLINE
+#endif
+#if NUM_SERVICES > 21
+  , SERV_21_DEADLINE
+#endif
+#if NUM_SERVICES > 22
+  , SERV_22_DEADLINE
+#endif
+#if NUM_SERVICES > 23
+  , SERV_23_DEADLINE
+#endif
+#if NUM_SERVICES > 24
+  , SERV_24_DEADLINE
+#endif
+#if NUM_SERVICES > 25
+  , SERV_25_DEADLINE
+#endif
+#if NUM_SERVICES > 26
+  , SERV_26_DEADLINE
+#endif
+#if NUM_SERVICES > 27
+  , SERV_27_DEADLINE
+#endif
+#if NUM_SERVICES > 28
+  , SERV_28_DEADLINE
+#endif
+#if NUM_SERVICES > 29
+  , SERV_29_DEADLINE
+#endif
+#if NUM_SERVICES > 30
+  , SERV_30_DEADLINE
+#endif
+#if NUM_SERVICES > 31
+  , SERV_31_DEADLINE
+#endif
+#if NUM_SERVICES > 32
+  , SERV_32_DEADLINE
+#endif
+#if NUM_SERVICES > 33
+  , SERV_33_DEADLINE
+#endif
+#if NUM_SERVICES > 34
+  , SERV_34_DEADLINE
+#endif
+#if NUM_SERVICES > 35
+  , SERV_35_DEADLINE
+#endif
+#if NUM_SERVICES > 36
+  , SERV_36_DEADLINE
+#endif
+#if NUM_SERVICES > 37
+  , SERV_37_DEADLINE
+#endif
+#if NUM_SERVICES > 38
+  , SERV_38_DEADLINE
+#endif
+#if NUM_SERVICES > 39
+  , SERV_39_DEADLINE
+#endif
+#if NUM_SERVICES > 40
+  , SERV_40_DEADLINE
+#endif
+#if NUM_SERVICES > 41
+  , SERV_41_DEADLINE
+#endif
+#if NUM_SERVICES > 42
+  , SERV_42_DEADLINE
+#endif
+#if NUM_SERVICES > 43
+  , SERV_43_DEADLINE
+#endif
+#if NUM_SERVICES > 44
+  , SERV_44_DEADLINE
+#endif
+#if NUM_SERVICES > 45
+  , SERV_45_DEADLINE
+#endif
+#if NUM_SERVICES > 46
+  , SERV_46_DEADLINE
+#endif
+#if NUM_SERVICES > 47
+  , SERV_47_DEADLINE
+#endif
+#if NUM_SERVICES > 48
+  , SERV_48_DEADLINE
+#endif
+#if NUM_SERVICES > 49
+  , SERV_49_DEADLINE
+#endif
+#if NUM_SERVICES > 50
+  , SERV_50_DEADLINE
+#endif
+#if NUM_SERVICES > 51
+  , SERV_51_DEADLINE
+#endif
+#if NUM_SERVICES > 52
+  , SERV_52_DEADLINE
+#endif
+#if NUM_SERVICES > 53
+  , SERV_53_DEADLINE
+#endif
+#if NUM_SERVICES > 54
+  , SERV_54_DEADLINE
+#endif
+#if NUM_SERVICES > 55
+  , SERV_55_DEADLINE
+#endif
+#if NUM_SERVICES > 56
+  , SERV_56_DEADLINE
+#endif
+#if NUM_SERVICES > 57
+  , SERV_57_DEADLINE
+#endif
+#if NUM_SERVICES > 58
+  , SERV_58_DEADLINE
+#endif
+#if NUM_SERVICES > 59
+  , SERV_59_DEADLINE
+#endif
+#if NUM_SERVICES > 60
+  , SERV_60_DEADLINE
+#endif
+#if NUM_SERVICES > 61
+  , SERV_61_DEADLINE
+#endif
+#if NUM_SERVICES > 62
+  , SERV_62_DEADLINE
+#endif
+#if NUM_SERVICES > 63
+  , SERV_63_DEADLINE
+#endif
+};
+
+// the ticks on which the events in each service's queue were posted,
+// oldest first. Kept in step with the queue by EnQueueFIFO, EnQueueLIFO,
+// DeQueue and DeQueueBatch, so it needs a slot for every event the queue
+// can hold.
+typedef struct
+{
+  uint16_t Ticks[EDF_STAMP_DEPTH];
+  uint8_t  Oldest;
+  uint8_t  Count;
+}PostStamps_t;
+
+static PostStamps_t PostStamps[NUM_SERVICES];
+
+// events from an interrupt fed queue are stamped when ES_Run first sees
+// them, valid while ISRHeadStamped is set
+static uint16_t ISRHeadSince[NUM_SERVICES];
+static bool     ISRHeadStamped[NUM_SERVICES];
+#endif
+
+/****************************************************************************/
+// The subscriber table for ES_Publish, one mask per event type with bit n set
+// if service n takes that type. It is built here, by the preprocessor, from
+// the SERV_n_SUBSCRIBES masks; services that do not set one take nothing.
+#if NUM_SERVICES > 32
+typedef uint64_t SubscriberMask_t;
+#elif NUM_SERVICES > 16
+typedef uint32_t SubscriberMask_t;
+#else
+typedef uint16_t SubscriberMask_t;
+#endif
+
+#ifndef SERV_0_SUBSCRIBES
+#define SERV_0_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_1_SUBSCRIBES
+#define SERV_1_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_2_SUBSCRIBES
+#define SERV_2_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_3_SUBSCRIBES
+#define SERV_3_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_4_SUBSCRIBES
+#define SERV_4_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_5_SUBSCRIBES
+#define SERV_5_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_6_SUBSCRIBES
+#define SERV_6_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_7_SUBSCRIBES
+#define SERV_7_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_8_SUBSCRIBES
+#define SERV_8_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_9_SUBSCRIBES
+#define SERV_9_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_10_SUBSCRIBES
+#define SERV_10_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_11_SUBSCRIBES
+#define SERV_11_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_12_SUBSCRIBES
+#define SERV_12_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_13_SUBSCRIBES
+#define SERV_13_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_14_SUBSCRIBES
+#define SERV_14_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_15_SUBSCRIBES
+#define SERV_15_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_16_SUBSCRIBES
+#define SERV_16_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_17_SUBSCRIBES
+#define SERV_17_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_18_SUBSCRIBES
+#define SERV_18_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_19_SUBSCRIBES
+#define SERV_19_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_20_SUBSCRIBES
+#define SERV_20_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_21_SUBSCRIBES
+#define SERV_21_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_22_SUBSCRIBES
+#define SERV_22_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_23_SUBSCRIBES
+#define SERV_23_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_24_SUBSCRIBES
+#define SERV_24_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_25_SUBSCRIBES
+#define SERV_25_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_26_SUBSCRIBES
+#define SERV_26_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_27_SUBSCRIBES
+#define SERV_27_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_28_SUBSCRIBES
+#define SERV_28_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_29_SUBSCRIBES
+#define SERV_29_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_30_SUBSCRIBES
+#define SERV_30_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_31_SUBSCRIBES
+#define SERV_31_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_32_SUBSCRIBES
+#define SERV_32_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_33_SUBSCRIBES
+#define SERV_33_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_34_SUBSCRIBES
+#define SERV_34_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_35_SUBSCRIBES
+#define SERV_35_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_36_SUBSCRIBES
+#define SERV_36_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_37_SUBSCRIBES
+#define SERV_37_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_38_SUBSCRIBES
+#define SERV_38_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_39_SUBSCRIBES
+#define SERV_39_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_40_SUBSCRIBES
+#define SERV_40_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_41_SUBSCRIBES
+#define SERV_41_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_42_SUBSCRIBES
+#define SERV_42_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_43_SUBSCRIBES
+#define SERV_43_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_44_SUBSCRIBES
+#define SERV_44_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_45_SUBSCRIBES
+#define SERV_45_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_46_SUBSCRIBES
+#define SERV_46_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_47_SUBSCRIBES
+#define SERV_47_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_48_SUBSCRIBES
+#define SERV_48_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_49_SUBSCRIBES
+#define SERV_49_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_50_SUBSCRIBES
+#define SERV_50_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_51_SUBSCRIBES
+#define SERV_51_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_52_SUBSCRIBES
+#define SERV_52_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_53_SUBSCRIBES
+#define SERV_53_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_54_SUBSCRIBES
+#define SERV_54_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_55_SUBSCRIBES
+#define SERV_55_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_56_SUBSCRIBES
+#define SERV_56_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_57_SUBSCRIBES
+#define SERV_57_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_58_SUBSCRIBES
+#define SERV_58_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_59_SUBSCRIBES
+#define SERV_59_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_60_SUBSCRIBES
+#define SERV_60_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_61_SUBSCRIBES
+#define SERV_61_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_62_SUBSCRIBES
+#define SERV_62_SUBSCRIBES 0ULL
+#endif
+#ifndef SERV_63_SUBSCRIBES
+#define SERV_63_SUBSCRIBES 0ULL
+#endif
+
+// service Serv's bit if its SERV_n_<Setting> mask has Type, services past
+// NUM_SERVICES are masked off
+#define ServiceBit(Serv, Setting, Type) \
+  ((((uint64_t)SERV_##Serv##_##Setting >> (Type)) & 1) << (Serv))
+#define AllServices ((2ULL << (NUM_SERVICES - 1)) - 1)
+#define ServicesWith(Setting, Type) ((SubscriberMask_t)(AllServices & ( \
+  ServiceBit(0, Setting, Type) | ServiceBit(1, Setting, Type) | \
+  ServiceBit(2, Setting, Type) | ServiceBit(3, Setting, Type) | \
+  ServiceBit(4, Setting, Type) | ServiceBit(5, Setting, Type) | \
+  ServiceBit(6, Setting, Type) | ServiceBit(7, Setting, Type) | \
+  ServiceBit(8, Setting, Type) | ServiceBit(9, Setting, Type) | \
+  ServiceBit(10, Setting, Type) | ServiceBit(11, Setting, Type) | \
+  ServiceBit(12, Setting, Type) | ServiceBit(13, Setting, Type) | \
+  ServiceBit(14, Setting, Type) | ServiceBit(15, Setting, Type) | \
+  ServiceBit(16, Setting, Type) | ServiceBit(17, Setting, Type) | \
+  ServiceBit(18, Setting, Type) | ServiceBit(19, Setting, Type) | \
+  ServiceBit(20, Setting, Type) | ServiceBit(21, Setting, Type) | \
+  ServiceBit(22, Setting, Type) | ServiceBit(23, Setting, Type) | \
+  ServiceBit(24, Setting, Type) | ServiceBit(25, Setting, Type) | \
+  ServiceBit(26, Setting, Type) | ServiceBit(27, Setting, Type) | \
+  ServiceBit(28, Setting, Type) | ServiceBit(29, Setting, Type) | \
+  ServiceBit(30, Setting, Type) | ServiceBit(31, Setting, Type) | \
+  ServiceBit(32, Setting, Type) | ServiceBit(33, Setting, Type) | \
+  ServiceBit(34, Setting, Type) | ServiceBit(35, Setting, Type) | \
+  ServiceBit(36, Setting, Type) | ServiceBit(37, Setting, Type) | \
+  ServiceBit(38, Setting, Type) | ServiceBit(39, Setting, Type) | \
+  ServiceBit(40, Setting, Type) | ServiceBit(41, Setting, Type) | \
+  ServiceBit(42, Setting, Type) | ServiceBit(43, Setting, Type) | \
+  ServiceBit(44, Setting, Type) | ServiceBit(45, Setting, Type) | \
+  ServiceBit(46, Setting, Type) | ServiceBit(47, Setting, Type) | \
+  ServiceBit(48, Setting, Type) | ServiceBit(49, Setting, Type) | \
+  ServiceBit(50, Setting, Type) | ServiceBit(51, Setting, Type) | \
+  ServiceBit(52, Setting, Type) | ServiceBit(53, Setting, Type) | \
+  ServiceBit(54, Setting, Type) | ServiceBit(55, Setting, Type) | \
+  ServiceBit(56, Setting, Type) | ServiceBit(57, Setting, Type) | \
+  ServiceBit(58, Setting, Type) | ServiceBit(59, Setting, Type) | \
+  ServiceBit(60, Setting, Type) | ServiceBit(61, Setting, Type) | \
+  ServiceBit(62, Setting, Type) | ServiceBit(63, Setting, Type))))
+#define ServicesWith8(Setting, Type) \
+  ServicesWith(Setting, Type), ServicesWith(Setting, (Type) + 1), \
+  ServicesWith(Setting, (Type) + 2), ServicesWith(Setting, (Type) + 3), \
+  ServicesWith(Setting, (Type) + 4), ServicesWith(Setting, (Type) + 5), \
+  ServicesWith(Setting, (Type) + 6), ServicesWith(Setting, (Type) + 7)
+#define ServicesWithTable(Setting) \
+  ServicesWith8(Setting, 0), ServicesWith8(Setting, 8), \
+  ServicesWith8(Setting, 16), ServicesWith8(Setting, 24), \
+  ServicesWith8(Setting, 32), ServicesWith8(Setting, 40), \
+  ServicesWith8(Setting, 48), ServicesWith8(Setting, 56)
+
+static SubscriberMask_t const Subscribers[ES_MAX_SUBSCRIBED_TYPES] =
+{
+  ServicesWithTable(SUBSCRIBES)
+};
+
+/****************************************************************************/
+// The coalescing table, built the same way from the SERV_n_COALESCE masks.
+// Bit n is set if service n keeps only the newest waiting event of the type,
+// a post overwriting the one already queued rather than taking a new entry.
+#ifndef SERV_0_COALESCE
+#define SERV_0_COALESCE 0ULL
+#endif
+#ifndef SERV_1_COALESCE
+#define SERV_1_COALESCE 0ULL
+#endif
+#ifndef SERV_2_COALESCE
+#define SERV_2_COALESCE 0ULL
+#endif
+#ifndef SERV_3_COALESCE
+#define SERV_3_COALESCE 0ULL
+#endif
+#ifndef SERV_4_COALESCE
+#define SERV_4_COALESCE 0ULL
+#endif
+#ifndef SERV_5_COALESCE
+#define SERV_5_COALESCE 0ULL
+#endif
+#ifndef SERV_6_COALESCE
+#define SERV_6_COALESCE 0ULL
+#endif
+#ifndef SERV_7_COALESCE
+#define SERV_7_COALESCE 0ULL
+#endif
+#ifndef SERV_8_COALESCE
+#define SERV_8_COALESCE 0ULL
+#endif
+#ifndef SERV_9_COALESCE
+#define SERV_9_COALESCE 0ULL
+#endif
+#ifndef SERV_10_COALESCE
+#define SERV_10_COALESCE 0ULL
+#endif
+#ifndef SERV_11_COALESCE
+#define SERV_11_COALESCE 0ULL
+#endif
+#ifndef SERV_12_COALESCE
+#define SERV_12_COALESCE 0ULL
+#endif
+#ifndef SERV_13_COALESCE
+#define SERV_13_COALESCE 0ULL
+#endif
+#ifndef SERV_14_COALESCE
+#define SERV_14_COALESCE 0ULL
+#endif
+#ifndef SERV_15_COALESCE
+#define SERV_15_COALESCE 0ULL
+#endif
+#ifndef SERV_16_COALESCE
+#define SERV_16_COALESCE 0ULL
+#endif
+#ifndef SERV_17_COALESCE
+#define SERV_17_COALESCE 0ULL
+#endif
+#ifndef SERV_18_COALESCE
+#define SERV_18_COALESCE 0ULL
+#endif
+#ifndef SERV_19_COALESCE
+#define SERV_19_COALESCE 0ULL
+#endif
+#ifndef SERV_20_COALESCE
+#define SERV_20_COALESCE 0ULL
+#endif
+#ifndef SERV_21_COALESCE
+#define SERV_21_COALESCE 0ULL
+#endif
+#ifndef SERV_22_COALESCE
+#define SERV_22_COALESCE 0ULL
+#endif
+#ifndef SERV_23_COALESCE
+#define SERV_23_COALESCE 0ULL
+#endif
+#ifndef SERV_24_COALESCE
+#define SERV_24_COALESCE 0ULL
+#endif
+#ifndef SERV_25_COALESCE
+#define SERV_25_COALESCE 0ULL
+#endif
+#ifndef SERV_26_COALESCE
+#define SERV_26_COALESCE 0ULL
+#endif
+#ifndef SERV_27_COALESCE
+#define SERV_27_COALESCE 0ULL
+#endif
+#ifndef SERV_28_COALESCE
+#define SERV_28_COALESCE 0ULL
+#endif
+#ifndef SERV_29_COALESCE
+#define SERV_29_COALESCE 0ULL
+#endif
+#ifndef SERV_30_COALESCE
+#define SERV_30_COALESCE 0ULL
+#endif
+#ifndef SERV_31_COALESCE
+#define SERV_31_COALESCE 0ULL
+#endif
+#ifndef SERV_32_COALESCE
+#define SERV_32_COALESCE 0ULL
+#endif
+#ifndef SERV_33_COALESCE
+#define SERV_33_COALESCE 0ULL
+#endif
+#ifndef SERV_34_COALESCE
+#define SERV_34_COALESCE 0ULL
+#endif
+#ifndef SERV_35_COALESCE
+#define SERV_35_COALESCE 0ULL
+#endif
+#ifndef SERV_36_COALESCE
+#define SERV_36_COALESCE 0ULL
+#endif
+#ifndef SERV_37_COALESCE
+#define SERV_37_COALESCE 0ULL
+#endif
+#ifndef SERV_38_COALESCE
+#define SERV_38_COALESCE 0ULL
+#endif
+#ifndef SERV_39_COALESCE
+#define SERV_39_COALESCE 0ULL
+#endif
+#ifndef SERV_40_COALESCE
+#define SERV_40_COALESCE 0ULL
+#endif
+#ifndef SERV_41_COALESCE
+#define SERV_41_COALESCE 0ULL
+#endif
+#ifndef SERV_42_COALESCE
+#define SERV_42_COALESCE 0ULL
+#endif
+#ifndef SERV_43_COALESCE
+#define SERV_43_COALESCE 0ULL
+#endif
+#ifndef SERV_44_COALESCE
+#define SERV_44_COALESCE 0ULL
+#endif
+#ifndef SERV_45_COALESCE
+#define SERV_45_COALESCE 0ULL
+#endif
+#ifndef SERV_46_COALESCE
+#define SERV_46_COALESCE 0ULL
+#endif
+#ifndef SERV_47_COALESCE
+#define SERV_47_COALESCE 0ULL
+#endif
+#ifndef SERV_48_COALESCE
+#define SERV_48_COALESCE 0ULL
+#endif
+#ifndef SERV_49_COALESCE
+#define SERV_49_COALESCE 0ULL
+#endif
+#ifndef SERV_50_COALESCE
+#define SERV_50_COALESCE 0ULL
+#endif
+#ifndef SERV_51_COALESCE
+#define SERV_51_COALESCE 0ULL
+#endif
+#ifndef SERV_52_COALESCE
+#define SERV_52_COALESCE 0ULL
+#endif
+#ifndef SERV_53_COALESCE
+#define SERV_53_COALESCE 0ULL
+#endif
+#ifndef SERV_54_COALESCE
+#define SERV_54_COALESCE 0ULL
+#endif
+#ifndef SERV_55_COALESCE
+#define SERV_55_COALESCE 0ULL
+#endif
+#ifndef SERV_56_COALESCE
+#define SERV_56_COALESCE 0ULL
+#endif
+#ifndef SERV_57_COALESCE
+#define SERV_57_COALESCE 0ULL
+#endif
+#ifndef SERV_58_COALESCE
+#define SERV_58_COALESCE 0ULL
+#endif
+#ifndef SERV_59_COALESCE
+#define SERV_59_COALESCE 0ULL
+#endif
+#ifndef SERV_60_COALESCE
+#define SERV_60_COALESCE 0ULL
+#endif
+#ifndef SERV_61_COALESCE
+#define SERV_61_COALESCE 0ULL
+#endif
+#ifndef SERV_62_COALESCE
+#define SERV_62_COALESCE 0ULL
+#endif
+#ifndef SERV_63_COALESCE
+#define SERV_63_COALESCE 0ULL
+#endif
+
+static SubscriberMask_t const Coalescers[ES_MAX_SUBSCRIBED_TYPES] =
+{
+  ServicesWithTable(COALESCE)
+};
+
+#if NUM_SUBSCRIBER_LISTS > 0
+// the members of the lists services join at run time, bit n for service n.
+// Only touched with interrupts off, a mask may take more than one store.
+static SubscriberMask_t ListMembers[NUM_SUBSCRIBER_LISTS];
+#endif
+
+/****************************************************************************/
+// The queues for the services
+
+// a service that defines SERV_n_RING_QUEUE gets a mask indexed ring
+// (ES_RingQueue.c) of SERV_n_QUEUE_SIZE events, the rest an ES_Queue block
+
+#ifdef SERV_0_RING_QUEUE
+ES_RING_QUEUE(Queue0, SERV_0_QUEUE_SIZE);
+#define QUEUE_0_DESC { NULL, 0, &Queue0 }
+#else
+static ES_Event_t Queue0[SERV_0_QUEUE_SIZE + 1];
+#define QUEUE_0_DESC { Queue0, ARRAY_SIZE(Queue0), NULL }
+#endif
+#if NUM_SERVICES > 1
+#ifdef SERV_1_RING_QUEUE
+ES_RING_QUEUE(Queue1, SERV_1_QUEUE_SIZE);
+#define QUEUE_1_DESC { NULL, 0, &Queue1 }
+#else
+static ES_Event_t Queue1[SERV_1_QUEUE_SIZE + 1];
+#define QUEUE_1_DESC { Queue1, ARRAY_SIZE(Queue1), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 2
+#ifdef SERV_2_RING_QUEUE
+ES_RING_QUEUE(Queue2, SERV_2_QUEUE_SIZE);
+#define QUEUE_2_DESC { NULL, 0, &Queue2 }
+#else
+static ES_Event_t Queue2[SERV_2_QUEUE_SIZE + 1];
+#define QUEUE_2_DESC { Queue2, ARRAY_SIZE(Queue2), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 3
+#ifdef SERV_3_RING_QUEUE
+ES_RING_QUEUE(Queue3, SERV_3_QUEUE_SIZE);
+#define QUEUE_3_DESC { NULL, 0, &Queue3 }
+#else
+static ES_Event_t Queue3[SERV_3_QUEUE_SIZE + 1];
+#define QUEUE_3_DESC { Queue3, ARRAY_SIZE(Queue3), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 4
+#ifdef SERV_4_RING_QUEUE
+ES_RING_QUEUE(Queue4, SERV_4_QUEUE_SIZE);
+#define QUEUE_4_DESC { NULL, 0, &Queue4 }
+#else
+static ES_Event_t Queue4[SERV_4_QUEUE_SIZE + 1];
+#define QUEUE_4_DESC { Queue4, ARRAY_SIZE(Queue4), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 5
+#ifdef SERV_5_RING_QUEUE
+ES_RING_QUEUE(Queue5, SERV_5_QUEUE_SIZE);
+#define QUEUE_5_DESC { NULL, 0, &Queue5 }
+#else
+static ES_Event_t Queue5[SERV_5_QUEUE_SIZE + 1];
+#define QUEUE_5_DESC { Queue5, ARRAY_SIZE(Queue5), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 6
+#ifdef SERV_6_RING_QUEUE
+ES_RING_QUEUE(Queue6, SERV_6_QUEUE_SIZE);
+#define QUEUE_6_DESC { NULL, 0, &Queue6 }
+#else
+static ES_Event_t Queue6[SERV_6_QUEUE_SIZE + 1];
+#define QUEUE_6_DESC { Queue6, ARRAY_SIZE(Queue6), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 7
+#ifdef SERV_7_RING_QUEUE
+ES_RING_QUEUE(Queue7, SERV_7_QUEUE_SIZE);
+#define QUEUE_7_DESC { NULL, 0, &Queue7 }
+#else
+static ES_Event_t Queue7[SERV_7_QUEUE_SIZE + 1];
+#define QUEUE_7_DESC { Queue7, ARRAY_SIZE(Queue7), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 8
+#ifdef SERV_8_RING_QUEUE
+ES_RING_QUEUE(Queue8, SERV_8_QUEUE_SIZE);
+#define QUEUE_8_DESC { NULL, 0, &Queue8 }
+#else
+static ES_Event_t Queue8[SERV_8_QUEUE_SIZE + 1];
+#define QUEUE_8_DESC { Queue8, ARRAY_SIZE(Queue8), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 9
+#ifdef SERV_9_RING_QUEUE
+ES_RING_QUEUE(Queue9, SERV_9_QUEUE_SIZE);
+#define QUEUE_9_DESC { NULL, 0, &Queue9 }
+#else
+static ES_Event_t Queue9[SERV_9_QUEUE_SIZE + 1];
+#define QUEUE_9_DESC { Queue9, ARRAY_SIZE(Queue9), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 10
+#ifdef SERV_10_RING_QUEUE
+ES_RING_QUEUE(Queue10, SERV_10_QUEUE_SIZE);
+#define QUEUE_10_DESC { NULL, 0, &Queue10 }
+#else
+static ES_Event_t Queue10[SERV_10_QUEUE_SIZE + 1];
+#define QUEUE_10_DESC { Queue10, ARRAY_SIZE(Queue10), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 11
+#ifdef SERV_11_RING_QUEUE
+ES_RING_QUEUE(Queue11, SERV_11_QUEUE_SIZE);
+#define QUEUE_11_DESC { NULL, 0, &Queue11 }
+#else
+static ES_Event_t Queue11[SERV_11_QUEUE_SIZE + 1];
+#define QUEUE_11_DESC { Queue11, ARRAY_SIZE(Queue11), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 12
+#ifdef SERV_12_RING_QUEUE
+ES_RING_QUEUE(Queue12, SERV_12_QUEUE_SIZE);
+#define QUEUE_12_DESC { NULL, 0, &Queue12 }
+#else
+static ES_Event_t Queue12[SERV_12_QUEUE_SIZE + 1];
+#define QUEUE_12_DESC { Queue12, ARRAY_SIZE(Queue12), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 13
+#ifdef SERV_13_RING_QUEUE
+ES_RING_QUEUE(Queue13, SERV_13_QUEUE_SIZE);
+#define QUEUE_13_DESC { NULL, 0, &Queue13 }
+#else
+static ES_Event_t Queue13[SERV_13_QUEUE_SIZE + 1];
+#define QUEUE_13_DESC { Queue13, ARRAY_SIZE(Queue13), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 14
+#ifdef SERV_14_RING_QUEUE
+ES_RING_QUEUE(Queue14, SERV_14_QUEUE_SIZE);
+#define QUEUE_14_DESC { NULL, 0, &Queue14 }
+#else
+static ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
+#define QUEUE_14_DESC { Queue14, ARRAY_SIZE(Queue14), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 15
+#ifdef SERV_15_RING_QUEUE
+ES_RING_QUEUE(Queue15, SERV_15_QUEUE_SIZE);
+#define QUEUE_15_DESC { NULL, 0, &Queue15 }
+#else
+static ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
+#define QUEUE_15_DESC { Queue15, ARRAY_SIZE(Queue15), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 16
+#ifdef SERV_16_RING_QUEUE
+ES_RING_QUEUE(Queue16, SERV_16_QUEUE_SIZE);
+#define QUEUE_16_DESC { NULL, 0, &Queue16 }
+#else
+static ES_Event_t Queue16[SERV_16_QUEUE_SIZE + 1];
+#define QUEUE_16_DESC { Queue16, ARRAY_SIZE(Queue16), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 17
+#ifdef SERV_17_RING_QUEUE
+ES_RING_QUEUE(Queue17, SERV_17_QUEUE_SIZE);
+#define QUEUE_17_DESC { NULL, 0, &Queue17 }
+#else
+static ES_Event_t Queue17[SERV_17_QUEUE_SIZE + 1];
+#define QUEUE_17_DESC { Queue17, ARRAY_SIZE(Queue17), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 18
+#ifdef SERV_18_RING_QUEUE
+ES_RING_QUEUE(Queue18, SERV_18_QUEUE_SIZE);
+#define QUEUE_18_DESC { NULL, 0, &Queue18 }
+#else
+static ES_Event_t Queue18[SERV_18_QUEUE_SIZE + 1];
+#define QUEUE_18_DESC { Queue18, ARRAY_SIZE(Queue18), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 19
+#ifdef SERV_19_RING_QUEUE
+ES_RING_QUEUE(Queue19, SERV_19_QUEUE_SIZE);
+#define QUEUE_19_DESC { NULL, 0, &Queue19 }
+#else
+static ES_Event_t Queue19[SERV_19_QUEUE_SIZE + 1];
+#define QUEUE_19_DESC { Queue19, ARRAY_SIZE(Queue19), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 20
+#ifdef SERV_20_RING_QUEUE
+ES_RING_QUEUE(Queue20, SERV_20_QUEUE_SIZE);
+#define QUEUE_20_DESC { NULL, 0, &Queue20 }
+#else
+static ES_Event_t Queue20[SERV_20_QUEUE_SIZE + 1];
+#define QUEUE_20_DESC { Queue20, ARRAY_SIZE(Queue20), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 21
+#ifdef SERV_21_RING_QUEUE
+ES_RING_QUEUE(Queue21, SERV_21_QUEUE_SIZE);
+#define QUEUE_21_DESC { NULL, 0, &Queue21 }
+#else
+static ES_Event_t Queue21[SERV_21_QUEUE_SIZE + 1];
+#define QUEUE_21_DESC { Queue21, ARRAY_SIZE(Queue21), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 22
+#ifdef SERV_22_RING_QUEUE
+ES_RING_QUEUE(Queue22, SERV_22_QUEUE_SIZE);
+#define QUEUE_22_DESC { NULL, 0, &Queue22 }
+#else
+static ES_Event_t Queue22[SERV_22_QUEUE_SIZE + 1];
+#define QUEUE_22_DESC { Queue22, ARRAY_SIZE(Queue22), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 23
+#ifdef SERV_23_RING_QUEUE
+ES_RING_QUEUE(Queue23, SERV_23_QUEUE_SIZE);
+#define QUEUE_23_DESC { NULL, 0, &Queue23 }
+#else
+static ES_Event_t Queue23[SERV_23_QUEUE_SIZE + 1];
+#define QUEUE_23_DESC { Queue23, ARRAY_SIZE(Queue23), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 24
+#ifdef SERV_24_RING_QUEUE
+ES_RING_QUEUE(Queue24, SERV_24_QUEUE_SIZE);
+#define QUEUE_24_DESC { NULL, 0, &Queue24 }
+#else
+static ES_Event_t Queue24[SERV_24_QUEUE_SIZE + 1];
+#define QUEUE_24_DESC { Queue24, ARRAY_SIZE(Queue24), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 25
+#ifdef SERV_25_RING_QUEUE
+ES_RING_QUEUE(Queue25, SERV_25_QUEUE_SIZE);
+#define QUEUE_25_DESC { NULL, 0, &Queue25 }
+#else
+static ES_Event_t Queue25[SERV_25_QUEUE_SIZE + 1];
+#define QUEUE_25_DESC { Queue25, ARRAY_SIZE(Queue25), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 26
+#ifdef SERV_26_RING_QUEUE
+ES_RING_QUEUE(Queue26, SERV_26_QUEUE_SIZE);
+#define QUEUE_26_DESC { NULL, 0, &Queue26 }
+#else
+static ES_Event_t Queue26[SERV_26_QUEUE_SIZE + 1];
+#define QUEUE_26_DESC { Queue26, ARRAY_SIZE(Queue26), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 27
+#ifdef SERV_27_RING_QUEUE
+ES_RING_QUEUE(Queue27, SERV_27_QUEUE_SIZE);
+#define QUEUE_27_DESC { NULL, 0, &Queue27 }
+#else
+static ES_Event_t Queue27[SERV_27_QUEUE_SIZE + 1];
+#define QUEUE_27_DESC { Queue27, ARRAY_SIZE(Queue27), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 28
+#ifdef SERV_28_RING_QUEUE
+ES_RING_QUEUE(Queue28, SERV_28_QUEUE_SIZE);
+#define QUEUE_28_DESC { NULL, 0, &Queue28 }
+#else
+static ES_Event_t Queue28[SERV_28_QUEUE_SIZE + 1];
+#define QUEUE_28_DESC { Queue28, ARRAY_SIZE(Queue28), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 29
+#ifdef SERV_29_RING_QUEUE
+ES_RING_QUEUE(Queue29, SERV_29_QUEUE_SIZE);
+#define QUEUE_29_DESC { NULL, 0, &Queue29 }
+#else
+static ES_Event_t Queue29[SERV_29_QUEUE_SIZE + 1];
+#define QUEUE_29_DESC { Queue29, ARRAY_SIZE(Queue29), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 30
+#ifdef SERV_30_RING_QUEUE
+ES_RING_QUEUE(Queue30, SERV_30_QUEUE_SIZE);
+#define QUEUE_30_DESC { NULL, 0, &Queue30 }
+#else
+static ES_Event_t Queue30[SERV_30_QUEUE_SIZE + 1];
+#define QUEUE_30_DESC { Queue30, ARRAY_SIZE(Queue30), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 31
+#ifdef SERV_31_RING_QUEUE
+ES_RING_QUEUE(Queue31, SERV_31_QUEUE_SIZE);
+#define QUEUE_31_DESC { NULL, 0, &Queue31 }
+#else
+static ES_Event_t Queue31[SERV_31_QUEUE_SIZE + 1];
+#define QUEUE_31_DESC { Queue31, ARRAY_SIZE(Queue31), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 32
+#ifdef SERV_32_RING_QUEUE
+ES_RING_QUEUE(Queue32, SERV_32_QUEUE_SIZE);
+#define QUEUE_32_DESC { NULL, 0, &Queue32 }
+#else
+static ES_Event_t Queue32[SERV_32_QUEUE_SIZE + 1];
+#define QUEUE_32_DESC { Queue32, ARRAY_SIZE(Queue32), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 33
+#ifdef SERV_33_RING_QUEUE
+ES_RING_QUEUE(Queue33, SERV_33_QUEUE_SIZE);
+#define QUEUE_33_DESC { NULL, 0, &Queue33 }
+#else
+static ES_Event_t Queue33[SERV_33_QUEUE_SIZE + 1];
+#define QUEUE_33_DESC { Queue33, ARRAY_SIZE(Queue33), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 34
+#ifdef SERV_34_RING_QUEUE
+ES_RING_QUEUE(Queue34, SERV_34_QUEUE_SIZE);
+#define QUEUE_34_DESC { NULL, 0, &Queue34 }
+#else
+static ES_Event_t Queue34[SERV_34_QUEUE_SIZE + 1];
+#define QUEUE_34_DESC { Queue34, ARRAY_SIZE(Queue34), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 35
+#ifdef SERV_35_RING_QUEUE
+ES_RING_QUEUE(Queue35, SERV_35_QUEUE_SIZE);
+#define QUEUE_35_DESC { NULL, 0, &Queue35 }
+#else
+static ES_Event_t Queue35[SERV_35_QUEUE_SIZE + 1];
+#define QUEUE_35_DESC { Queue35, ARRAY_SIZE(Queue35), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 36
+#ifdef SERV_36_RING_QUEUE
+ES_RING_QUEUE(Queue36, SERV_36_QUEUE_SIZE);
+#define QUEUE_36_DESC { NULL, 0, &Queue36 }
+#else
+static ES_Event_t Queue36[SERV_36_QUEUE_SIZE + 1];
+#define QUEUE_36_DESC { Queue36, ARRAY_SIZE(Queue36), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 37
+#ifdef SERV_37_RING_QUEUE
+ES_RING_QUEUE(Queue37, SERV_37_QUEUE_SIZE);
+#define QUEUE_37_DESC { NULL, 0, &Queue37 }
+#else
+static ES_Event_t Queue37[SERV_37_QUEUE_SIZE + 1];
+#define QUEUE_37_DESC { Queue37, ARRAY_SIZE(Queue37), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 38
+#ifdef SERV_38_RING_QUEUE
+ES_RING_QUEUE(Queue38, SERV_38_QUEUE_SIZE);
+#define QUEUE_38_DESC { NULL, 0, &Queue38 }
+#else
+static ES_Event_t Queue38[SERV_38_QUEUE_SIZE + 1];
+#define QUEUE_38_DESC { Queue38, ARRAY_SIZE(Queue38), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 39
+#ifdef SERV_39_RING_QUEUE
+ES_RING_QUEUE(Queue39, SERV_39_QUEUE_SIZE);
+#define QUEUE_39_DESC { NULL, 0, &Queue39 }
+#else
+static ES_Event_t Queue39[SERV_39_QUEUE_SIZE + 1];
+#define QUEUE_39_DESC { Queue39, ARRAY_SIZE(Queue39), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 40
+#ifdef SERV_40_RING_QUEUE
+ES_RING_QUEUE(Queue40, SERV_40_QUEUE_SIZE);
+#define QUEUE_40_DESC { NULL, 0, &Queue40 }
+#else
+static ES_Event_t Queue40[SERV_40_QUEUE_SIZE + 1];
+#define QUEUE_40_DESC { Queue40, ARRAY_SIZE(Queue40), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 41
+#ifdef SERV_41_RING_QUEUE
+ES_RING_QUEUE(Queue41, SERV_41_QUEUE_SIZE);
+#define QUEUE_41_DESC { NULL, 0, &Queue41 }
+#else
+static ES_Event_t Queue41[SERV_41_QUEUE_SIZE + 1];
+#define QUEUE_41_DESC { Queue41, ARRAY_SIZE(Queue41), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 42
+#ifdef SERV_42_RING_QUEUE
+ES_RING_QUEUE(Queue42, SERV_42_QUEUE_SIZE);
+#define QUEUE_42_DESC { NULL, 0, &Queue42 }
+#else
+static ES_Event_t Queue42[SERV_42_QUEUE_SIZE + 1];
+#define QUEUE_42_DESC { Queue42, ARRAY_SIZE(Queue42), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 43
+#ifdef SERV_43_RING_QUEUE
+ES_RING_QUEUE(Queue43, SERV_43_QUEUE_SIZE);
+#define QUEUE_43_DESC { NULL, 0, &Queue43 }
+#else
+static ES_Event_t Queue43[SERV_43_QUEUE_SIZE + 1];
+#define QUEUE_43_DESC { Queue43, ARRAY_SIZE(Queue43), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 44
+#ifdef SERV_44_RING_QUEUE
+ES_RING_QUEUE(Queue44, SERV_44_QUEUE_SIZE);
+#define QUEUE_44_DESC { NULL, 0, &Queue44 }
+#else
+static ES_Event_t Queue44[SERV_44_QUEUE_SIZE + 1];
+#define QUEUE_44_DESC { Queue44, ARRAY_SIZE(Queue44), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 45
+#ifdef SERV_45_RING_QUEUE
+ES_RING_QUEUE(Queue45, SERV_45_QUEUE_SIZE);
+#define QUEUE_45_DESC { NULL, 0, &Queue45 }
+#else
+static ES_Event_t Queue45[SERV_45_QUEUE_SIZE + 1];
+#define QUEUE_45_DESC { Queue45, ARRAY_SIZE(Queue45), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 46
+#ifdef SERV_46_RING_QUEUE
+ES_RING_QUEUE(Queue46, SERV_46_QUEUE_SIZE);
+#define QUEUE_46_DESC { NULL, 0, &Queue46 }
+#else
+static ES_Event_t Queue46[SERV_46_QUEUE_SIZE + 1];
+#define QUEUE_46_DESC { Queue46, ARRAY_SIZE(Queue46), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 47
+#ifdef SERV_47_RING_QUEUE
+ES_RING_QUEUE(Queue47, SERV_47_QUEUE_SIZE);
+#define QUEUE_47_DESC { NULL, 0, &Queue47 }
+#else
+static ES_Event_t Queue47[SERV_47_QUEUE_SIZE + 1];
+#define QUEUE_47_DESC { Queue47, ARRAY_SIZE(Queue47), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 48
+#ifdef SERV_48_RING_QUEUE
+ES_RING_QUEUE(Queue48, SERV_48_QUEUE_SIZE);
+#define QUEUE_48_DESC { NULL, 0, &Queue48 }
+#else
+static ES_Event_t Queue48[SERV_48_QUEUE_SIZE + 1];
+#define QUEUE_48_DESC { Queue48, ARRAY_SIZE(Queue48), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 49
+#ifdef SERV_49_RING_QUEUE
+ES_RING_QUEUE(Queue49, SERV_49_QUEUE_SIZE);
+#define QUEUE_49_DESC { NULL, 0, &Queue49 }
+#else
+static ES_Event_t Queue49[SERV_49_QUEUE_SIZE + 1];
+#define QUEUE_49_DESC { Queue49, ARRAY_SIZE(Queue49), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 50
+#ifdef SERV_50_RING_QUEUE
+ES_RING_QUEUE(Queue50, SERV_50_QUEUE_SIZE);
+#define QUEUE_50_DESC { NULL, 0, &Queue50 }
+#else
+static ES_Event_t Queue50[SERV_50_QUEUE_SIZE + 1];
+#define QUEUE_50_DESC { Queue50, ARRAY_SIZE(Queue50), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 51
+#ifdef SERV_51_RING_QUEUE
+ES_RING_QUEUE(Queue51, SERV_51_QUEUE_SIZE);
+#define QUEUE_51_DESC { NULL, 0, &Queue51 }
+#else
+static ES_Event_t Queue51[SERV_51_QUEUE_SIZE + 1];
+#define QUEUE_51_DESC { Queue51, ARRAY_SIZE(Queue51), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 52
+#ifdef SERV_52_RING_QUEUE
+ES_RING_QUEUE(Queue52, SERV_52_QUEUE_SIZE);
+#define QUEUE_52_DESC { NULL, 0, &Queue52 }
+#else
+static ES_Event_t Queue52[SERV_52_QUEUE_SIZE + 1];
+#define QUEUE_52_DESC { Queue52, ARRAY_SIZE(Queue52), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 53
+#ifdef SERV_53_RING_QUEUE
+ES_RING_QUEUE(Queue53, SERV_53_QUEUE_SIZE);
+#define QUEUE_53_DESC { NULL, 0, &Queue53 }
+#else
+static ES_Event_t Queue53[SERV_53_QUEUE_SIZE + 1];
+#define QUEUE_53_DESC { Queue53, ARRAY_SIZE(Queue53), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 54
+#ifdef SERV_54_RING_QUEUE
+ES_RING_QUEUE(Queue54, SERV_54_QUEUE_SIZE);
+#define QUEUE_54_DESC { NULL, 0, &Queue54 }
+#else
+static ES_Event_t Queue54[SERV_54_QUEUE_SIZE + 1];
+#define QUEUE_54_DESC { Queue54, ARRAY_SIZE(Queue54), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 55
+#ifdef SERV_55_RING_QUEUE
+ES_RING_QUEUE(Queue55, SERV_55_QUEUE_SIZE);
+#define QUEUE_55_DESC { NULL, 0, &Queue55 }
+#else
+static ES_Event_t Queue55[SERV_55_QUEUE_SIZE + 1];
+#define QUEUE_55_DESC { Queue55, ARRAY_SIZE(Queue55), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 56
+#ifdef SERV_56_RING_QUEUE
+ES_RING_QUEUE(Queue56, SERV_56_QUEUE_SIZE);
+#define QUEUE_56_DESC { NULL, 0, &Queue56 }
+#else
+static ES_Event_t Queue56[SERV_56_QUEUE_SIZE + 1];
+#define QUEUE_56_DESC { Queue56, ARRAY_SIZE(Queue56), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 57
+#ifdef SERV_57_RING_QUEUE
+ES_RING_QUEUE(Queue57, SERV_57_QUEUE_SIZE);
+#define QUEUE_57_DESC { NULL, 0, &Queue57 }
+#else
+static ES_Event_t Queue57[SERV_57_QUEUE_SIZE + 1];
+#define QUEUE_57_DESC { Queue57, ARRAY_SIZE(Queue57), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 58
+#ifdef SERV_58_RING_QUEUE
+ES_RING_QUEUE(Queue58, SERV_58_QUEUE_SIZE);
+#define QUEUE_58_DESC { NULL, 0, &Queue58 }
+#else
+static ES_Event_t Queue58[SERV_58_QUEUE_SIZE + 1];
+#define QUEUE_58_DESC { Queue58, ARRAY_SIZE(Queue58), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 59
+#ifdef SERV_59_RING_QUEUE
+ES_RING_QUEUE(Queue59, SERV_59_QUEUE_SIZE);
+#define QUEUE_59_DESC { NULL, 0, &Queue59 }
+#else
+static ES_Event_t Queue59[SERV_59_QUEUE_SIZE + 1];
+#define QUEUE_59_DESC { Queue59, ARRAY_SIZE(Queue59), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 60
+#ifdef SERV_60_RING_QUEUE
+ES_RING_QUEUE(Queue60, SERV_60_QUEUE_SIZE);
+#define QUEUE_60_DESC { NULL, 0, &Queue60 }
+#else
+static ES_Event_t Queue60[SERV_60_QUEUE_SIZE + 1];
+#define QUEUE_60_DESC { Queue60, ARRAY_SIZE(Queue60), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 61
+#ifdef SERV_61_RING_QUEUE
+ES_RING_QUEUE(Queue61, SERV_61_QUEUE_SIZE);
+#define QUEUE_61_DESC { NULL, 0, &Queue61 }
+#else
+static ES_Event_t Queue61[SERV_61_QUEUE_SIZE + 1];
+#define QUEUE_61_DESC { Queue61, ARRAY_SIZE(Queue61), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 62
+#ifdef SERV_62_RING_QUEUE
+ES_RING_QUEUE(Queue62, SERV_62_QUEUE_SIZE);
+#define QUEUE_62_DESC { NULL, 0, &Queue62 }
+#else
+static ES_Event_t Queue62[SERV_62_QUEUE_SIZE + 1];
+#define QUEUE_62_DESC { Queue62, ARRAY_SIZE(Queue62), NULL }
+#endif
+#endif
+#if NUM_SERVICES > 63
+#ifdef SERV_63_RING_QUEUE
+ES_RING_QUEUE(Queue63, SERV_63_QUEUE_SIZE);
+#define QUEUE_63_DESC { NULL, 0, &Queue63 }
+#else
+static ES_Event_t Queue63[SERV_63_QUEUE_SIZE + 1];
+#define QUEUE_63_DESC { Queue63, ARRAY_SIZE(Queue63), NULL }
+#endif
+#endif
+
+/****************************************************************************/
+// array of queue descriptors for posting by priority level
+
+static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
+  QUEUE_0_DESC
+#if NUM_SERVICES > 1
+  , QUEUE_1_DESC
+#endif
+#if NUM_SERVICES > 2
+  , QUEUE_2_DESC
+#endif
+#if NUM_SERVICES > 3
+  , QUEUE_3_DESC
+#endif
+#if NUM_SERVICES > 4
+  , QUEUE_4_DESC
+#endif
+#if NUM_SERVICES > 5
+  , QUEUE_5_DESC
+#endif
+#if NUM_SERVICES > 6
+  , QUEUE_6_DESC
+#endif
+#if NUM_SERVICES > 7
+  , QUEUE_7_DESC
+#endif
+#if NUM_SERVICES > 8
+  , QUEUE_8_DESC
+#endif
+#if NUM_SERVICES > 9
+  , QUEUE_9_DESC
+#endif
+#if NUM_SERVICES > 10
+  , QUEUE_10_DESC
+#endif
+#if NUM_SERVICES > 11
+  , QUEUE_11_DESC
+#endif
+#if NUM_SERVICES > 12
+  , QUEUE_12_DESC
+#endif
+#if NUM_SERVICES > 13
+  , QUEUE_13_DESC
+#endif
+#if NUM_SERVICES > 14
+  , QUEUE_14_DESC
+#endif
+#if NUM_SERVICES > 15
+  , QUEUE_15_DESC
+#endif
+#if NUM_SERVICES > 16
+  , QUEUE_16_DESC
+#endif
+#if NUM_SERVICES > 17
+  , QUEUE_17_DESC
+#endif
+#if NUM_SERVICES > 18
+  , QUEUE_18_DESC
+#endif
+#if NUM_SERVICES > 19
+  , QUEUE_19_DESC
+#endif
+#if NUM_SERVICES > 20
+  , QUEUE_20_DESC
+#endif
+#if NUM_SERVICES > 21
+  , QUEUE_21_DESC
+#endif
+#if NUM_SERVICES > 22
+  , QUEUE_22_DESC
+#endif
+#if NUM_SERVICES > 23
+  , QUEUE_23_DESC
+#endif
+#if NUM_SERVICES > 24
+  , QUEUE_24_DESC
+#endif
+#if NUM_SERVICES > 25
+  , QUEUE_25_DESC
+#endif
+#if NUM_SERVICES > 26
+  , QUEUE_26_DESC
+#endif
+#if NUM_SERVICES > 27
+  , QUEUE_27_DESC
+#endif
+#if NUM_SERVICES > 28
+  , QUEUE_28_DESC
+#endif
+#if NUM_SERVICES > 29
+  , QUEUE_29_DESC
+#endif
+#if NUM_SERVICES > 30
+  , QUEUE_30_DESC
+#endif
+#if NUM_SERVICES > 31
+  , QUEUE_31_DESC
+#endif
+#if NUM_SERVICES > 32
+  , QUEUE_32_DESC
+#endif
+#if NUM_SERVICES > 33
+  , QUEUE_33_DESC
+#endif
+#if NUM_SERVICES > 34
+  , QUEUE_34_DESC
+#endif
+#if NUM_SERVICES > 35
+  , QUEUE_35_DESC
+#endif
+#if NUM_SERVICES > 36
+  , QUEUE_36_DESC
+#endif
+#if NUM_SERVICES > 37
+  , QUEUE_37_DESC
+#endif
+#if NUM_SERVICES > 38
+  , QUEUE_38_DESC
+#endif
+#if NUM_SERVICES > 39
+  , QUEUE_39_DESC
+#endif
+#if NUM_SERVICES > 40
+  , QUEUE_40_DESC
+#endif
+#if NUM_SERVICES > 41
+  , QUEUE_41_DESC
+#endif
+#if NUM_SERVICES > 42
+  , QUEUE_42_DESC
+#endif
+#if NUM_SERVICES > 43
+  , QUEUE_43_DESC
+#endif
+#if NUM_SERVICES > 44
+  , QUEUE_44_DESC
+#endif
+#if NUM_SERVICES > 45
+  , QUEUE_45_DESC
+#endif
+#if NUM_SERVICES > 46
+  , QUEUE_46_DESC
+#endif
+#if NUM_SERVICES > 47
+  , QUEUE_47_DESC
+#endif
+#if NUM_SERVICES > 48
+  , QUEUE_48_DESC
+#endif
+#if NUM_SERVICES > 49
+  , QUEUE_49_DESC
+#endif
+#if NUM_SERVICES > 50
+  , QUEUE_50_DESC
+#endif
+#if NUM_SERVICES > 51
+  , QUEUE_51_DESC
+#endif
+#if NUM_SERVICES > 52
+  , QUEUE_52_DESC
+#endif
+#if NUM_SERVICES > 53
+  , QUEUE_53_DESC
+#endif
+#if NUM_SERVICES > 54
+  , QUEUE_54_DESC
+#endif
+#if NUM_SERVICES > 55
+  , QUEUE_55_DESC
+#endif
+#if NUM_SERVICES > 56
+  , QUEUE_56_DESC
+#endif
+#if NUM_SERVICES > 57
+  , QUEUE_57_DESC
+#endif
+#if NUM_SERVICES > 58
+  , QUEUE_58_DESC
+#endif
+#if NUM_SERVICES > 59
+  , QUEUE_59_DESC
+#endif
+#if NUM_SERVICES > 60
+  , QUEUE_60_DESC
+#endif
+#if NUM_SERVICES > 61
+  , QUEUE_61_DESC
+#endif
+#if NUM_SERVICES > 62
+  , QUEUE_62_DESC
+#endif
+#if NUM_SERVICES > 63
+  , QUEUE_63_DESC
+#endif
+};
+
+/****************************************************************************/
+// where a batch service's events are handed to it
+static ES_Event_t BatchEvents[BATCH_RUN_MAX_EVENTS];
+
+/****************************************************************************/
+// interrupt fed queues, attached by the services that want them. ISRs post
+// to these without touching Ready, ES_Run notices them when it looks for work
+static ES_SPSCQueue_t *ISRQueues[NUM_SERVICES];
+static uint8_t ISRFedServices[NUM_SERVICES];
+static uint8_t NumISRFedServices;
+
+/****************************************************************************/
+// queue traffic, reported by ES_GetQueueStats and ES_PrintQueueStats
+typedef struct
+{
+  uint32_t Enqueued;      // these three are written with interrupts off,
+  uint32_t Dropped;       // since ISRs post too
+  uint16_t PeakDepth;
+  uint32_t Dequeued;      // only ES_Run writes this
+  uint32_t ISREnqueued;   // only the ES_PostToServiceFromISR ISR writes
+  uint32_t ISRDropped;    // these two
+  uint32_t Coalesced;     // written with interrupts off
+}QueueStats_t;
+
+static QueueStats_t QueueStats[NUM_SERVICES];
+
+#ifdef ES_PROFILE
+/****************************************************************************/
+// run function timing, reported by ES_GetProfile and ES_PrintProfile. Only
+// ES_Run writes these.
+static ES_ProfileStats_t Profile[NUM_SERVICES];
+#endif
+
+#ifdef ES_RUN_BUDGET
+/****************************************************************************/
+// the last ES_OVERRUN_LOG_SIZE overruns, reported by ES_GetOverruns and
+// ES_PrintOverruns. Only ES_Run and ES_Initialize write these.
+static ES_Overrun_t Overruns[ES_OVERRUN_LOG_SIZE];
+static uint32_t     NumOverruns;  // ever, the newest is at NumOverruns - 1
+#endif
+
+#ifdef ES_BUDGET_WATCHDOG
+// the call in progress, left alone by the start up code so that after a
+// watchdog reset ES_Initialize can tell which call hung
+#define RUNNING_MARK 0x52554E21UL
+typedef struct
+{
+  uint32_t   Mark;        // RUNNING_MARK while a run function is called
+  ES_Event_t Event;
+  uint8_t    Service;
+}Running_t;
+
+static ES_PERSISTENT Running_t Running;
+#endif
+
+/****************************************************************************/
+// Variable used to keep track of which queues have events in them
+
+#if MAX_NUM_SERVICES > 16
+// a two level bitmap (see ES_LookupTables.h). Marking a queue empty touches
+// two words, so it is done with interrupts off to keep an ISR post from
+// landing between them and being lost from the summary word.
+static uint16_t Ready[ES_BITMAP_SIZE(MAX_NUM_SERVICES)];
+
+#define IsAnyServiceReady() (Ready[0] != 0)
+#define GetHighestReady()   ES_BitmapGetMSBitSet(Ready)
+#define ReadyGroups()       (Ready[0])
+#define ReadyInGroup(Group) (Ready[(Group) + 1])
+#define MarkReady(Which)    do { EnterCritical(); \
+                                 ES_BitmapSet(Ready, (Which)); \
+                                 ExitCritical(); } while (0)
+#define MarkReadyInCritical(Which) ES_BitmapSet(Ready, (Which))
+#define MarkEmpty(Which)    do { EnterCritical(); \
+                                 ES_BitmapClear(Ready, (Which)); \
+                                 ExitCritical(); } while (0)
+#else
+uint16_t Ready;
+
+#define IsAnyServiceReady() (Ready != 0)
+#define GetHighestReady()   ES_GetMSBitSet(Ready)
+#define ReadyGroups()       ((Ready != 0) ? BIT0HI : 0)
+#define ReadyInGroup(Group) (Ready)
+#define MarkReady(Which)    (Ready |= BitNum2SetMask[(Which)])
+#define MarkReadyInCritical(Which) MarkReady(Which)
+#define MarkEmpty(Which)    (Ready &= BitNum2ClrMask[(Which)])
+#endif
+
+// the service ES_Run takes an event from next
+#ifdef EDF_DISPATCH
+#define PickService()       GetEarliestDeadline()
+#else
+#define PickService()       GetHighestReady()
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_Initialize
+ Parameters
+   TimerRate_t the rate at which to initialize the framework timer subsystem
+ Returns
+   ES_Return_t : FailedPointer if any of the function pointers are NULL
+                 FailedInit if any of the initialization functions failed
+ Description
+   Initialize all the services and tests for NULL pointers in the array
+ Notes
+
+ Author
+   J. Edward Carryer, 10/23/11,
+****************************************************************************/
+ES_Return_t ES_Initialize(TimerRate_t NewRate)
+{
+  uint8_t i;
+  ES_Timer_Init(NewRate);  // start up the timer subsystem
+  ES_PayloadInit();        // services may post payloads from their inits
+  // loop through the list testing for NULL pointers and
+  for (i = 0; i < ARRAY_SIZE(ServDescList); i++)
+  {
+    if ((ServDescList[i].InitFunc == (pInitFunc)0) ||
+        (ServDescList[i].RunFunc == (pRunFunc)0))
+    {
+      return FailedPointer; // protect against NULL pointers
+    }
+    // and initializing the event queues (must happen before running inits)
+    InitQueue(i);
+#ifdef EDF_DISPATCH
+    if (QueueCapacity(i) > EDF_STAMP_DEPTH)
+    {
+      return FailedInit; // not enough room to stamp a full queue
+    }
+#endif
+    // executing the init functions
+    if (ServDescList[i].InitFunc(i) != true)
+    {
+      return FailedInit; // this is a failed initialization
+    }
+  }
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+  _HW_DebugLines_Init();
+#endif
+#ifdef ES_BUDGET_WATCHDOG
+  if (_HW_WatchdogCausedReset() && (Running.Mark == RUNNING_MARK))
+  {
+    LogOverrun(Running.Service, Running.Event, ES_OVERRUN_WATCHDOG);
+  }
+  Running.Mark = 0;
+  _HW_WatchdogInit();
+#endif
+  return Success;
+}
+
+/****************************************************************************
+ Function
+   ES_Run
+ Parameters
+   None
+ Returns
+   ES_Return_t : FailedRun is any of the run functions failed during execution
+ Description
+   This is the main framework function. It searches through the services
+   to find one with a non-empty queue and then executes the
+   service to process the event in its queue.
+   while all the queues are empty, it searches for system generated or
+   user generated events or moves bytes from buffer to UART.
+ Notes
+   this function only returns in case of an error
+   services with a batch run function get all of their waiting events in
+   one call. With EDF_DISPATCH the next service is the one whose waiting
+   event is closest to its deadline, rather than the highest numbered one.
+ Author
+   J. Edward Carryer, 10/23/11,
+****************************************************************************/
+ES_Return_t ES_Run(void)
+{
+  // make these static to improve speed
+  uint8_t         HighestPrior;
+  uint8_t         NumEvents;
+  uint8_t         NumKept;
+  uint8_t         i;
+  static ES_Event_t ThisEvent;
+#if defined(ES_PROFILE) || defined(ES_RUN_BUDGET)
+  uint32_t        RunStart;
+  uint32_t        RunCounts;
+#endif
+#ifdef ES_RUN_BUDGET
+  const ES_Event_t *pRunEvent;  // the event logged if the call overruns
+#endif
+#ifdef ES_TRACE
+  const ES_Event_t *pEndEvent;  // the event recorded when the call returns
+#endif
+
+  while (1)  // stay here unless we detect an error condition
+  {
+#ifdef ES_BUDGET_WATCHDOG
+    _HW_WatchdogClear(); // the idle passes count as progress too
+#endif
+    // loop through the list executing the run functions for services
+    // with a non-empty queue. Process any pending ints before testing
+    // Ready
+    while ((_HW_Process_Pending_Ints()) && CheckISRQueues())
+    {
+#ifdef ES_BUDGET_WATCHDOG
+      _HW_WatchdogClear();
+#endif
+      HighestPrior = PickService();
+      if (ServDescList[HighestPrior].BatchRunFunc != NULL_BATCH_RUN)
+      {
+        // mark empty before draining, so a post that lands mid-drain
+        // re-marks the queue rather than being forgotten
+        MarkEmpty(HighestPrior);
+        NumEvents = 0;
+        if (ISRQueues[HighestPrior] != NULL)
+        {
+          NumEvents = (uint8_t)ES_SPSCDeQueueBatch(ISRQueues[HighestPrior],
+              BatchEvents, ARRAY_SIZE(BatchEvents));
+        }
+        QueueStats[HighestPrior].Dequeued += NumEvents;
+        NumEvents += DeQueueBatch(HighestPrior, &BatchEvents[NumEvents],
+            ARRAY_SIZE(BatchEvents) - NumEvents);
+        if (IsQueueEmpty(HighestPrior) == false)
+        {
+          MarkReady(HighestPrior); // more than one batch worth waiting
+        }
+        // lets a periodic timer post its next timeout, and drops the
+        // timeouts of dynamic timers freed since they were posted
+        NumKept = 0;
+        for (i = 0; i < NumEvents; i++)
+        {
+          if ((BatchEvents[i].EventType == ES_TIMEOUT) &&
+              !ES_Timer_TimeoutDispatched(BatchEvents[i].EventParam))
+          {
+            continue;
+          }
+          BatchEvents[NumKept++] = BatchEvents[i];
+#ifdef ES_TRACE
+          ES_TraceRecord(ES_TRACE_START, HighestPrior, BatchEvents[i]);
+#endif
+        }
+        NumEvents = NumKept;
+        if (NumEvents == 0)
+        {
+#ifdef EDF_DISPATCH
+          NoteDispatched(HighestPrior);
+#endif
+          continue;
+        }
+#ifdef EDF_DISPATCH
+        NoteDispatched(HighestPrior);
+#endif
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+        _HW_DebugSetLine1();
+#endif
+#ifdef ES_RUN_BUDGET
+        pRunEvent = &BatchEvents[0];
+#endif
+#ifdef ES_TRACE
+        pEndEvent = &BatchEvents[NumEvents - 1];
+#endif
+#ifdef ES_BUDGET_WATCHDOG
+        Running.Service = HighestPrior;
+        Running.Event   = *pRunEvent;
+        Running.Mark    = RUNNING_MARK;
+#endif
+#if defined(ES_PROFILE) || defined(ES_RUN_BUDGET)
+        RunStart = _HW_GetCycleCount();
+#endif
+        if (ServDescList[HighestPrior].BatchRunFunc(BatchEvents,
+            NumEvents).EventType != ES_NO_EVENT)
+        {
+          return FailedRun;
+        }
+      }
+      else
+      {
+        // interrupt events go first, then the ordinary queue
+        if ((DeQueueISREvent(HighestPrior, &ThisEvent) == false) &&
+            (DeQueue(HighestPrior, &ThisEvent) == 0))
+        {
+          MarkEmpty(HighestPrior); // mark queue as now empty
+        }
+        // lets a periodic timer post its next timeout, and drops the
+        // timeout of a dynamic timer freed since it was posted
+        if ((ThisEvent.EventType == ES_TIMEOUT) &&
+            !ES_Timer_TimeoutDispatched(ThisEvent.EventParam))
+        {
+#ifdef EDF_DISPATCH
+          NoteDispatched(HighestPrior);
+#endif
+          continue;
+        }
+#ifdef ES_TRACE
+        ES_TraceRecord(ES_TRACE_START, HighestPrior, ThisEvent);
+#endif
+#ifdef EDF_DISPATCH
+        NoteDispatched(HighestPrior);
+#endif
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+        _HW_DebugSetLine1();
+#endif
+#ifdef ES_RUN_BUDGET
+        pRunEvent = &ThisEvent;
+#endif
+#ifdef ES_TRACE
+        pEndEvent = &ThisEvent;
+#endif
+#ifdef ES_BUDGET_WATCHDOG
+        Running.Service = HighestPrior;
+        Running.Event   = ThisEvent;
+        Running.Mark    = RUNNING_MARK;
+#endif
+#if defined(ES_PROFILE) || defined(ES_RUN_BUDGET)
+        RunStart = _HW_GetCycleCount();
+#endif
+        if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
+            ES_NO_EVENT)
+        {
+          return FailedRun;
+        }
+      }
+#if defined(ES_PROFILE) || defined(ES_RUN_BUDGET)
+      RunCounts = _HW_GetCycleCount() - RunStart;
+#endif
+#ifdef ES_BUDGET_WATCHDOG
+      Running.Mark = 0;
+#endif
+#ifdef ES_PROFILE
+      RecordRunTime(HighestPrior, RunCounts);
+#endif
+#ifdef ES_RUN_BUDGET
+      if (RunCounts > ServBudgets[HighestPrior])
+      {
+        LogOverrun(HighestPrior, *pRunEvent, RunCounts);
+      }
+#endif
+#ifdef ES_TRACE
+      ES_TraceRecord(ES_TRACE_END, HighestPrior, *pEndEvent);
+#endif
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+      _HW_DebugClearLine1();
+#endif
+    }
+
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+    _HW_DebugSetLine2();
+#endif
+    // all the queues are empty, so look for new user detected events
+    if (!ES_CheckUserEvents()) // no new user events
+    {
+      Terminal_MoveBuffer2UART(); // try moving bytes, if available, to UART
+      _HW_Idle(); // nothing left to do, let the port wait for the next tick
+    }
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+    _HW_DebugClearLine2();
+#endif
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PostAll
+ Parameters
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if any of the post functions failed during execution
+ Description
+   posts to all of the services' queues
+ Notes
+
+ Author
+   J. Edward Carryer, 01/15/12,
+****************************************************************************/
+bool ES_PostAll(ES_Event_t ThisEvent)
+{
+  uint8_t i;
+  // loop through the list executing the post functions
+  for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
+  {
+    if (EnQueueFIFO(i, ThisEvent) != true)
+    {
+      break; // this is a failed post
+    }
+    else
+    {
+      MarkReady(i); // show queue as non-empty
+    }
+  }
+  if (i == ARRAY_SIZE(EventQueues))    // if no failures
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_Publish
+ Parameters
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if the type has no subscribers table entry or any of the
+   subscribers' queues was full
+ Description
+   posts to the queue of every service that subscribes to the event's type,
+   through SERV_n_SUBSCRIBES, and to no others
+ Notes
+   unlike ES_PostAll a full queue does not stop the posts to the services
+   after it
+****************************************************************************/
+bool ES_Publish(ES_Event_t ThisEvent)
+{
+  SubscriberMask_t  Mask;
+  uint8_t           i;
+  bool              AllTaken = true;
+
+  if ((unsigned)ThisEvent.EventType >= ARRAY_SIZE(Subscribers))
+  {
+    return false;
+  }
+  Mask = Subscribers[ThisEvent.EventType];
+  for (i = 0; Mask != 0; i++, Mask >>= 1)
+  {
+    if ((Mask & 1) != 0)
+    {
+      if (EnQueueFIFO(i, ThisEvent) == true)
+      {
+        MarkReady(i); // show queue as non-empty
+      }
+      else
+      {
+        AllTaken = false;
+      }
+    }
+  }
+  return AllTaken;
+}
+
+#if NUM_SUBSCRIBER_LISTS > 0
+/****************************************************************************
+ Function
+   ES_ListSubscribe
+ Parameters
+   uint8_t : Which list (0 to NUM_SUBSCRIBER_LISTS - 1)
+   uint8_t : Which service joins it (index into ServDescList)
+ Returns
+   boolean : False if there is no such list or service
+ Description
+   adds the service to the list, so that ES_ListPost posts to it too
+ Notes
+   joining a list twice is the same as joining it once
+****************************************************************************/
+bool ES_ListSubscribe(uint8_t WhichList, uint8_t WhichService)
+{
+  if ((WhichList >= NUM_SUBSCRIBER_LISTS) ||
+      (WhichService >= ARRAY_SIZE(EventQueues)))
+  {
+    return false;
+  }
+  EnterCritical();
+  ListMembers[WhichList] |= (SubscriberMask_t)1 << WhichService;
+  ExitCritical();
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_ListUnsubscribe
+ Parameters
+   uint8_t : Which list (0 to NUM_SUBSCRIBER_LISTS - 1)
+   uint8_t : Which service leaves it (index into ServDescList)
+ Returns
+   boolean : False if there is no such list or service
+ Description
+   takes the service off the list. Events it was already sent stay in its
+   queue.
+ Notes
+****************************************************************************/
+bool ES_ListUnsubscribe(uint8_t WhichList, uint8_t WhichService)
+{
+  if ((WhichList >= NUM_SUBSCRIBER_LISTS) ||
+      (WhichService >= ARRAY_SIZE(EventQueues)))
+  {
+    return false;
+  }
+  EnterCritical();
+  ListMembers[WhichList] &= ~((SubscriberMask_t)1 << WhichService);
+  ExitCritical();
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_ListPost
+ Parameters
+   uint8_t : Which list (0 to NUM_SUBSCRIBER_LISTS - 1)
+   ES_Event : The Event to be posted
+ Returns
+   uint8_t : the number of members whose queues took the event
+ Description
+   posts the event to every service on the list. All of the queues and the
+   ready flags are updated in one critical region, so an ISR sees the post
+   land in every member or in none.
+ Notes
+   the queue statistics, EDF stamps and trace are brought up to date after
+   interrupts are back on. A member that coalesces the type counts as having
+   taken the event. A poster of an ES_Payload retains its block once for
+   each member that took the event.
+****************************************************************************/
+uint8_t ES_ListPost(uint8_t WhichList, ES_Event_t ThisEvent)
+{
+  SubscriberMask_t  Members;
+  SubscriberMask_t  Mask;
+  PostResult_t      Results[NUM_SERVICES];
+  ES_Event_t        Replaced[NUM_SERVICES];
+  uint8_t           NumTaken = 0;
+  uint8_t           i;
+
+  if (WhichList >= NUM_SUBSCRIBER_LISTS)
+  {
+    return 0;
+  }
+  EnterCritical();
+  Members = ListMembers[WhichList];
+  for (i = 0, Mask = Members; Mask != 0; i++, Mask >>= 1)
+  {
+    if ((Mask & 1) != 0)
+    {
+      Results[i] = EnQueueFIFOInCritical(i, ThisEvent, &Replaced[i]);
+      if (Results[i] != PostDropped)
+      {
+        MarkReadyInCritical(i);
+      }
+    }
+  }
+  ExitCritical();
+
+  for (i = 0, Mask = Members; Mask != 0; i++, Mask >>= 1)
+  {
+    if ((Mask & 1) != 0)
+    {
+      NotePost(i, ThisEvent, Results[i], false, &Replaced[i]);
+      if (Results[i] != PostDropped)
+      {
+        NumTaken++;
+      }
+    }
+  }
+  return NumTaken;
+}
+#endif
+
+/****************************************************************************
+ Function
+   ES_PostToService
+ Parameters
+   uint8_t : Which service to post to (index into ServDescList)
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if the post function failed during execution
+ Description
+   posts to one of the services' queues
+ Notes
+   used by the timer library to associate a timer with a state machine
+ Author
+   J. Edward Carryer, 01/16/12,
+****************************************************************************/
+bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
+{
+  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
+      (EnQueueFIFO(WhichService, TheEvent) == true))
+  {
+    MarkReady(WhichService); // show queue as non-empty
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PostToServiceLIFO
+ Parameters
+   uint8_t : Which service to post to (index into ServDescList)
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if the post function failed during execution
+ Description
+   Posts, using LIFO strategy, to one of the services' queues
+ Notes
+   used by the Defer/Recall event capability
+ Author
+   J. Edward Carryer, 11/02/13
+****************************************************************************/
+bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
+{
+  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
+      (EnQueueLIFO(WhichService, TheEvent) == true))
+  {
+    MarkReady(WhichService); // show queue as non-empty
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PostToServiceFront
+ Parameters
+   uint8_t : Which service to post to (index into ServDescList)
+   const ES_Event * : the events to post, in the order they are to be run
+   uint8_t : how many there are
+ Returns
+   boolean : False if there is no such service or its queue does not have
+   room for them all, in which case none are posted
+ Description
+   puts the events at the front of the service's queue, ahead of those
+   already waiting, in one step with interrupts off and in their own order
+ Notes
+   used by the Defer/Recall event capability. A refused block is not
+   counted as dropped, the caller still has the events.
+****************************************************************************/
+bool ES_PostToServiceFront(uint8_t WhichService, const ES_Event_t *pEvents,
+    uint8_t NumEvents)
+{
+  bool    Accepted;
+  uint8_t i;
+
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return false;
+  }
+  EnterCritical();
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    Accepted = ES_RingEnQueueFrontInCritical(EventQueues[WhichService].pRing,
+        pEvents, NumEvents);
+  }
+  else
+  {
+    Accepted = ES_EnQueueFrontInCritical(EventQueues[WhichService].pMem,
+        pEvents, NumEvents);
+  }
+  if (Accepted && (NumEvents > 0))
+  {
+    MarkReadyInCritical(WhichService);
+  }
+  ExitCritical();
+
+  // last first, as though each had been posted LIFO
+  for (i = NumEvents; Accepted && (i > 0); i--)
+  {
+    NotePost(WhichService, pEvents[i - 1], PostQueued, true, NULL);
+  }
+  return Accepted;
+}
+
+/****************************************************************************
+ Function
+   ES_GetQueueRoom
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+ Returns
+   uint16_t : how many more events its queue will take, 0 if there is no
+   such service
+ Description
+   lets a caller with several events to post see first whether they all fit
+ Notes
+   only ES_Run takes events, so from a run function the room can shrink
+   after the call, when an interrupt posts, but it never grows
+****************************************************************************/
+uint16_t ES_GetQueueRoom(uint8_t WhichService)
+{
+  uint16_t Room;
+
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return 0;
+  }
+  EnterCritical();
+  Room = QueueCapacity(WhichService) - QueueDepth(WhichService);
+  ExitCritical();
+  return Room;
+}
+
+/****************************************************************************
+ Function
+   ES_AttachISRQueue
+ Parameters
+   uint8_t : Which service the queue feeds (index into ServDescList)
+   ES_SPSCQueue_t * : an initialized single producer, single consumer queue
+ Returns
+   boolean : False if the service does not exist or already has one
+ Description
+   gives a service a second, interrupt fed, queue. One ISR posts to it with
+   ES_PostToServiceFromISR and ES_Run delivers from it ahead of the
+   service's ordinary queue.
+ Notes
+   call from the service's init function, before enabling the interrupt
+****************************************************************************/
+bool ES_AttachISRQueue(uint8_t WhichService, ES_SPSCQueue_t *pQueue)
+{
+  if ((WhichService >= ARRAY_SIZE(EventQueues)) ||
+      (ISRQueues[WhichService] != NULL) || (pQueue == NULL))
+  {
+    return false;
+  }
+  ISRQueues[WhichService] = pQueue;
+  ISRFedServices[NumISRFedServices++] = WhichService;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_PostToServiceFromISR
+ Parameters
+   uint8_t : Which service to post to (index into ServDescList)
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if there is no ISR queue or it is full
+ Description
+   posts to a service's interrupt fed queue without turning interrupts off
+ Notes
+   only one ISR may post to any one service this way
+****************************************************************************/
+bool ES_PostToServiceFromISR(uint8_t WhichService, ES_Event_t TheEvent)
+{
+  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
+      (ISRQueues[WhichService] != NULL))
+  {
+    if (ES_SPSCEnQueue(ISRQueues[WhichService], TheEvent))
+    {
+      QueueStats[WhichService].ISREnqueued++;
+#ifdef ES_TRACE
+      ES_TraceRecord(ES_TRACE_POST, WhichService, TheEvent);
+#endif
+      return true;
+    }
+    QueueStats[WhichService].ISRDropped++;
+  }
+  return false;
+}
+
+/****************************************************************************
+ Function
+   ES_GetQueueStats
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+   ES_QueueStats_t * : where to put the counts
+ Returns
+   boolean : False if there is no such service
+ Description
+   reports the traffic through a service's queues since start up, or the
+   last ES_ResetQueueStats
+ Notes
+   posts through ES_PostToServiceFromISR are in Enqueued and Dropped, but
+   PeakDepth and Capacity are for the SERV_n_QUEUE_SIZE queue only
+****************************************************************************/
+bool ES_GetQueueStats(uint8_t WhichService, ES_QueueStats_t *pStats)
+{
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return false;
+  }
+  EnterCritical();  // a consistent snapshot, ISRs post too
+  pStats->Enqueued  = QueueStats[WhichService].Enqueued +
+      QueueStats[WhichService].ISREnqueued;
+  pStats->Dropped   = QueueStats[WhichService].Dropped +
+      QueueStats[WhichService].ISRDropped;
+  pStats->PeakDepth = QueueStats[WhichService].PeakDepth;
+  pStats->Dequeued  = QueueStats[WhichService].Dequeued;
+  pStats->Coalesced = QueueStats[WhichService].Coalesced;
+  ExitCritical();
+  pStats->Capacity  = QueueCapacity(WhichService);
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_ResetQueueStats
+ Parameters
+   None
+ Returns
+   None
+ Description
+   zeroes every service's queue counts, the peak depths restart from the
+   number of events waiting now
+ Notes
+****************************************************************************/
+void ES_ResetQueueStats(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < ARRAY_SIZE(QueueStats); i++)
+  {
+    EnterCritical();
+    QueueStats[i].Enqueued    = 0;
+    QueueStats[i].Dropped     = 0;
+    QueueStats[i].PeakDepth   = QueueDepth(i);
+    QueueStats[i].Dequeued    = 0;
+    QueueStats[i].ISREnqueued = 0;
+    QueueStats[i].ISRDropped  = 0;
+    QueueStats[i].Coalesced   = 0;
+    ExitCritical();
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PrintQueueStats
+ Parameters
+   None
+ Returns
+   None
+ Description
+   prints one line of ES_GetQueueStats counts per service to the terminal
+ Notes
+   a peak at the queue size, or any drops, means SERV_n_QUEUE_SIZE is too
+   small for that service
+****************************************************************************/
+void ES_PrintQueueStats(void)
+{
+  ES_QueueStats_t Stats;
+  uint8_t         i;
+
+  DB_printf("\n\rserv\tsize\tpeak\tenqueued\tdequeued\tdropped\t"
+      "coalesced\n\r");
+  for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
+  {
+    ES_GetQueueStats(i, &Stats);
+    DB_printf("%u\t%u\t%u\t%u\t\t%u\t\t%u\t%u\n\r", i, Stats.Capacity,
+        Stats.PeakDepth, (unsigned int)Stats.Enqueued,
+        (unsigned int)Stats.Dequeued, (unsigned int)Stats.Dropped,
+        (unsigned int)Stats.Coalesced);
+  }
+}
+
+#ifdef ES_PROFILE
+/****************************************************************************
+ Function
+   ES_GetProfile
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+   ES_ProfileStats_t * : where to put the timings
+ Returns
+   boolean : False if there is no such service
+ Description
+   reports how long the service's run function has taken per call since
+   start up, or the last ES_ResetProfile
+ Notes
+   a batch run function counts as one call however many events it was given
+****************************************************************************/
+bool ES_GetProfile(uint8_t WhichService, ES_ProfileStats_t *pStats)
+{
+  if (WhichService >= ARRAY_SIZE(Profile))
+  {
+    return false;
+  }
+  *pStats = Profile[WhichService];
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_ResetProfile
+ Parameters
+   None
+ Returns
+   None
+ Description
+   forgets every service's timings
+ Notes
+****************************************************************************/
+void ES_ResetProfile(void)
+{
+  uint8_t i;
+  uint8_t Bucket;
+
+  for (i = 0; i < ARRAY_SIZE(Profile); i++)
+  {
+    Profile[i].Runs         = 0;
+    Profile[i].MinCounts    = 0;
+    Profile[i].MaxCounts    = 0;
+    Profile[i].TotalCounts  = 0;
+    for (Bucket = 0; Bucket < ES_PROFILE_BUCKETS; Bucket++)
+    {
+      Profile[i].Histogram[Bucket] = 0;
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PrintProfile
+ Parameters
+   None
+ Returns
+   None
+ Description
+   prints each service's run function timings to the terminal, in
+   microseconds, followed by the non-empty histogram buckets
+ Notes
+   bucket n holds the calls that took 2^n to 2^(n+1) - 1 core timer counts
+****************************************************************************/
+void ES_PrintProfile(void)
+{
+  ES_ProfileStats_t *pStats;
+  uint8_t           i;
+  uint8_t           Bucket;
+
+  DB_printf("\n\rserv\truns\tmin us\tmean us\tmax us\n\r");
+  for (i = 0; i < ARRAY_SIZE(Profile); i++)
+  {
+    pStats = &Profile[i];
+    DB_printf("%u\t%u\t%u\t%u\t%u\n\r", i, (unsigned int)pStats->Runs,
+        (unsigned int)(pStats->MinCounts / ES_PROFILE_COUNTS_PER_US),
+        (unsigned int)((pStats->Runs == 0) ? 0 :
+        (pStats->TotalCounts / pStats->Runs / ES_PROFILE_COUNTS_PER_US)),
+        (unsigned int)(pStats->MaxCounts / ES_PROFILE_COUNTS_PER_US));
+    DB_printf("\tcounts 2^n:");
+    for (Bucket = 0; Bucket < ES_PROFILE_BUCKETS; Bucket++)
+    {
+      if (pStats->Histogram[Bucket] != 0)
+      {
+        DB_printf(" %u:%u", Bucket, (unsigned int)pStats->Histogram[Bucket]);
+      }
+    }
+    DB_printf("\n\r");
+  }
+}
+#endif
+
+#ifdef ES_RUN_BUDGET
+/****************************************************************************
+ Function
+   ES_GetNumOverruns
+ Parameters
+   None
+ Returns
+   uint32_t : how many run function calls have gone over their budget
+ Description
+   counts every overrun since start up, including those that have since
+   dropped out of the log
+ Notes
+****************************************************************************/
+uint32_t ES_GetNumOverruns(void)
+{
+  return NumOverruns;
+}
+
+/****************************************************************************
+ Function
+   ES_GetOverruns
+ Parameters
+   ES_Overrun_t * : where to put the records
+   uint8_t : how many records there is room for
+ Returns
+   uint8_t : the number of records copied
+ Description
+   copies the most recent overruns from the log, newest first
+ Notes
+   at most ES_OVERRUN_LOG_SIZE are kept
+****************************************************************************/
+uint8_t ES_GetOverruns(ES_Overrun_t *pDest, uint8_t MaxRecords)
+{
+  uint8_t NumCopied = 0;
+
+  while ((NumCopied < MaxRecords) && (NumCopied < NumOverruns) &&
+      (NumCopied < ES_OVERRUN_LOG_SIZE))
+  {
+    pDest[NumCopied] =
+        Overruns[(NumOverruns - 1 - NumCopied) % ES_OVERRUN_LOG_SIZE];
+    NumCopied++;
+  }
+  return NumCopied;
+}
+
+/****************************************************************************
+ Function
+   ES_PrintOverruns
+ Parameters
+   None
+ Returns
+   None
+ Description
+   prints the overrun count and the logged overruns, newest first, to the
+   terminal, with the time taken in microseconds
+ Notes
+   a call that hung until the watchdog reset the chip shows as "wdt"
+****************************************************************************/
+void ES_PrintOverruns(void)
+{
+  const ES_Overrun_t  *pRecord;
+  uint8_t             i;
+
+  DB_printf("\n\r%u overruns\n\rtick\tserv\tevent\tparam\tus\n\r",
+      (unsigned int)NumOverruns);
+  for (i = 0; (i < NumOverruns) && (i < ES_OVERRUN_LOG_SIZE); i++)
+  {
+    pRecord = &Overruns[(NumOverruns - 1 - i) % ES_OVERRUN_LOG_SIZE];
+    DB_printf("%u\t%u\t%u\t%u\t", (unsigned int)pRecord->Tick,
+        pRecord->Service, pRecord->Event.EventType,
+        pRecord->Event.EventParam);
+    if (pRecord->Counts == ES_OVERRUN_WATCHDOG)
+    {
+      DB_printf("wdt\n\r");
+    }
+    else
+    {
+      DB_printf("%u\n\r",
+          (unsigned int)(pRecord->Counts / ES_PROFILE_COUNTS_PER_US));
+    }
+  }
+}
+#endif
+
+/****************************************************************************
+ Function
+   ES_AnyEventsPending
+ Parameters
+   None
+ Returns
+   boolean : True if any service has an event waiting, interrupt fed queues
+   included
+ Description
+   the last check a port makes before it puts the CPU to sleep
+ Notes
+   never enters a critical section itself, so it can be called with
+   interrupts already off. That is the only way a false answer still holds
+   when the CPU goes to sleep.
+****************************************************************************/
+bool ES_AnyEventsPending(void)
+{
+  uint8_t i;
+
+  if (IsAnyServiceReady())
+  {
+    return true;
+  }
+  for (i = 0; i < NumISRFedServices; i++)
+  {
+    if (ES_SPSCIsEmpty(ISRQueues[ISRFedServices[i]]) == false)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//*********************************
+// private functions
+//*********************************
+/****************************************************************************
+ Function
+   CheckISRQueues
+ Parameters
+   None
+ Returns
+   boolean : True if any service has events waiting
+ Description
+   marks the services with a non-empty interrupt fed queue as ready, then
+   reports whether any service at all is ready
+ Notes
+   only ES_Run touches Ready for the interrupt fed queues, so the ISRs
+   never have to
+****************************************************************************/
+static bool CheckISRQueues(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < NumISRFedServices; i++)
+  {
+    if (ES_SPSCIsEmpty(ISRQueues[ISRFedServices[i]]) == false)
+    {
+      MarkReady(ISRFedServices[i]);
+    }
+  }
+  return IsAnyServiceReady();
+}
+
 /****************************************************************************
  Function
-   ES_Run
+   DeQueueISREvent
  Parameters
-   None
+   uint8_t : Which service to take an event for
+   ES_Event_t * : where to put the event
  Returns
-   ES_Return_t : FailedRun is any of the run functions failed during execution
+   boolean : True if an event came from the service's interrupt fed queue
  Description
-   This is the main framework function. It searches through the services
-   to find one with a non-empty queue and then executes the
-   service to process the event in its queue.
-   while all the queues are empty, it searches for system generated or
-   user generated events or moves bytes from buffer to UART.
+   takes the next event from the interrupt fed queue, if there is one, and
+   marks the service idle if that emptied both of its queues
  Notes
-   this function only returns in case of an error
- Author
-   J. Edward Carryer, 10/23/11,
+   an ISR post that lands after the check is picked up by CheckISRQueues
 ****************************************************************************/
-ES_Return_t ES_Run(void)
+static bool DeQueueISREvent(uint8_t WhichService, ES_Event_t *pEvent)
 {
-  // make these static to improve speed
-  uint8_t         HighestPrior;
-  static ES_Event_t ThisEvent;
+  if ((ISRQueues[WhichService] == NULL) ||
+      (ES_SPSCDeQueue(ISRQueues[WhichService], pEvent) == false))
+  {
+    return false;
+  }
+  QueueStats[WhichService].Dequeued++;
+  if (ES_SPSCIsEmpty(ISRQueues[WhichService]) &&
+      IsQueueEmpty(WhichService))
+  {
+    MarkEmpty(WhichService);
+  }
+  return true;
+}
 
-  while (1)  // stay here unless we detect an error condition
-  { // loop through the list executing the run functions for services
-    // with a non-empty queue. Process any pending ints before testing
-    // Ready
-    while ((_HW_Process_Pending_Ints()) && (Ready != 0))
+/****************************************************************************
+ Function
+   InitQueue, EnQueueFIFO, EnQueueLIFO, DeQueue, DeQueueBatch, IsQueueEmpty
+ Parameters
+   uint8_t : Which service's queue (index into EventQueues), then as for
+   the ES_Queue.c function of the same name
+ Returns
+   as for the ES_Queue.c function of the same name
+ Description
+   pass the operation on to ES_RingQueue.c or ES_Queue.c, whichever kind of
+   queue the service was configured with, and keep QueueStats
+ Notes
+****************************************************************************/
+static void InitQueue(uint8_t WhichService)
+{
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    ES_RingInit(EventQueues[WhichService].pRing);
+  }
+  else
+  {
+    ES_InitQueue(EventQueues[WhichService].pMem,
+        EventQueues[WhichService].Size);
+  }
+}
+
+static bool EnQueueFIFO(uint8_t WhichService, ES_Event_t Event2Add)
+{
+  PostResult_t  Result;
+  ES_Event_t    Replaced;
+
+  if (IsCoalesced(WhichService, Event2Add.EventType))
+  {
+    // the search and the overwrite must not be split by an ISR post
+    EnterCritical();
+    Result = EnQueueFIFOInCritical(WhichService, Event2Add, &Replaced);
+    ExitCritical();
+  }
+  else if (EventQueues[WhichService].pRing != NULL)
+  {
+    Result = ES_RingEnQueueFIFO(EventQueues[WhichService].pRing, Event2Add) ?
+        PostQueued : PostDropped;
+  }
+  else
+  {
+    Result = ES_EnQueueFIFO(EventQueues[WhichService].pMem, Event2Add) ?
+        PostQueued : PostDropped;
+  }
+  NotePost(WhichService, Event2Add, Result, false, &Replaced);
+  return Result != PostDropped;
+}
+
+static bool EnQueueLIFO(uint8_t WhichService, ES_Event_t Event2Add)
+{
+  bool Accepted;
+
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    Accepted = ES_RingEnQueueLIFO(EventQueues[WhichService].pRing, Event2Add);
+  }
+  else
+  {
+    Accepted = ES_EnQueueLIFO(EventQueues[WhichService].pMem, Event2Add);
+  }
+  NotePost(WhichService, Event2Add, Accepted ? PostQueued : PostDropped, true,
+      NULL);
+  return Accepted;
+}
+
+// EnQueueFIFO without the bookkeeping, for a caller that has interrupts off
+// and calls NotePost once they are back on. An event of a type the service
+// coalesces overwrites the waiting one of that type, which is copied to
+// *pReplaced, and takes a new entry only if there is none.
+static PostResult_t EnQueueFIFOInCritical(uint8_t WhichService,
+    ES_Event_t Event2Add, ES_Event_t *pReplaced)
+{
+  ES_RingQueue_t  *pRing = EventQueues[WhichService].pRing;
+  bool            Accepted;
+
+  if (IsCoalesced(WhichService, Event2Add.EventType))
+  {
+    if (pRing != NULL)
     {
-      HighestPrior = ES_GetMSBitSet(Ready);
-      if (ES_DeQueue(EventQueues[HighestPrior].pMem, &ThisEvent) == 0)
-      {
-        Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
-      }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugSetLine1();
+      Accepted = ES_RingReplaceInCritical(pRing, Event2Add, pReplaced);
+    }
+    else
+    {
+      Accepted = ES_ReplaceInCritical(EventQueues[WhichService].pMem,
+          Event2Add, pReplaced);
+    }
+    if (Accepted)
+    {
+      return PostCoalesced;
+    }
+  }
+  if (pRing != NULL)
+  {
+    Accepted = ES_RingEnQueueFIFOInCritical(pRing, Event2Add);
+  }
+  else
+  {
+    Accepted = ES_EnQueueFIFOInCritical(EventQueues[WhichService].pMem,
+        Event2Add);
+  }
+  return Accepted ? PostQueued : PostDropped;
+}
+
+// true if the service's SERV_n_COALESCE has the event's type
+static bool IsCoalesced(uint8_t WhichService, ES_EventType_t EventType)
+{
+  return ((unsigned)EventType < ARRAY_SIZE(Coalescers)) &&
+         (((Coalescers[EventType] >> WhichService) & 1) != 0);
+}
+
+// the bookkeeping for a post, each piece takes its own critical region.
+// *pReplaced is only read for a coalesced post, whose overwritten event
+// gives back its payload block if it had one.
+static void NotePost(uint8_t WhichService, ES_Event_t Event2Add,
+    PostResult_t Result, bool AtFront, const ES_Event_t *pReplaced)
+{
+#ifdef EDF_DISPATCH
+  // a coalesced event keeps the stamp of the one it overwrote
+  if (Result == PostQueued)
+  {
+    AddStamp(WhichService, AtFront);
+  }
 #endif
-      if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
-          ES_NO_EVENT)
-      {
-        return FailedRun;
-      }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugClearLine1();
+#ifdef ES_TRACE
+  if (Result != PostDropped)
+  {
+    ES_TraceRecord(ES_TRACE_POST, WhichService, Event2Add);
+  }
 #endif
-    }
+  CountPost(WhichService, Result);
+  // ES_PAYLOAD_EVENTS only has bits for the first 64 event types
+  if ((Result == PostCoalesced) && ((unsigned)pReplaced->EventType < 64) &&
+      ((((uint64_t)ES_PAYLOAD_EVENTS >> pReplaced->EventType) & 1) != 0))
+  {
+    ES_PayloadRelease(pReplaced->EventParam);
+  }
+}
 
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-    _HW_DebugSetLine2();
+static uint16_t DeQueue(uint8_t WhichService, ES_Event_t *pReturnEvent)
+{
+  // only ES_Run takes events, so if it is not empty now the take succeeds
+  if (IsQueueEmpty(WhichService) == false)
+  {
+    QueueStats[WhichService].Dequeued++;
+#ifdef EDF_DISPATCH
+    DropStamps(WhichService, 1);
 #endif
-    // all the queues are empty, so look for new user detected events
-    if (!ES_CheckUserEvents()) // no new user events
-    {
-      Terminal_MoveBuffer2UART(); // try moving bytes, if available, to UART
-    }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-    _HW_DebugClearLine2();
+  }
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    return ES_RingDeQueue(EventQueues[WhichService].pRing, pReturnEvent);
+  }
+  return ES_DeQueue(EventQueues[WhichService].pMem, pReturnEvent);
+}
+
+static uint8_t DeQueueBatch(uint8_t WhichService, ES_Event_t *pDest,
+    uint8_t MaxEvents)
+{
+  uint8_t NumTaken;
+
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    NumTaken = (uint8_t)ES_RingDeQueueBatch(EventQueues[WhichService].pRing,
+        pDest, MaxEvents);
+  }
+  else
+  {
+    NumTaken = ES_DeQueueBatch(EventQueues[WhichService].pMem, pDest,
+        MaxEvents);
+  }
+  QueueStats[WhichService].Dequeued += NumTaken;
+#ifdef EDF_DISPATCH
+  DropStamps(WhichService, NumTaken);
 #endif
+  return NumTaken;
+}
+
+static bool IsQueueEmpty(uint8_t WhichService)
+{
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    return ES_RingIsEmpty(EventQueues[WhichService].pRing);
+  }
+  return ES_IsQueueEmpty(EventQueues[WhichService].pMem);
+}
+
+static uint16_t QueueDepth(uint8_t WhichService)
+{
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    return ES_RingDepth(EventQueues[WhichService].pRing);
+  }
+  return ES_QueueDepth(EventQueues[WhichService].pMem);
+}
+
+static uint16_t QueueCapacity(uint8_t WhichService)
+{
+  if (EventQueues[WhichService].pRing != NULL)
+  {
+    return EventQueues[WhichService].pRing->Mask + 1;
   }
+  return EventQueues[WhichService].Size - 1; // less the ES_Queue header
 }
 
 /****************************************************************************
  Function
-   ES_PostAll
+   CountPost
  Parameters
-   ES_Event : The Event to be posted
+   uint8_t : Which service was posted to
+   bool : whether its queue took the event
  Returns
-   boolean : False if any of the post functions failed during execution
+   None
  Description
-   posts to all of the services' queues
+   counts a post, a coalesced post or a drop, and raises the service's
+   peak depth to the number of events now waiting
  Notes
-
- Author
-   J. Edward Carryer, 01/15/12,
+   a separate critical region from the queue's own, which can not nest.
+   Depth read after the post is still a depth the queue really reached.
 ****************************************************************************/
-bool ES_PostAll(ES_Event_t ThisEvent)
+static void CountPost(uint8_t WhichService, PostResult_t Result)
 {
-  uint8_t i;
-  // loop through the list executing the post functions
-  for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
+  uint16_t Depth;
+
+  EnterCritical();
+  if (Result == PostCoalesced)
   {
-    if (ES_EnQueueFIFO(EventQueues[i].pMem, ThisEvent) != true)
-    {
-      break; // this is a failed post
-    }
-    else
+    QueueStats[WhichService].Coalesced++;
+  }
+  else if (Result == PostQueued)
+  {
+    QueueStats[WhichService].Enqueued++;
+    Depth = QueueDepth(WhichService);
+    if (Depth > QueueStats[WhichService].PeakDepth)
     {
-      Ready |= BitNum2SetMask[i]; // show queue as non-empty
+      QueueStats[WhichService].PeakDepth = Depth;
     }
   }
-  if (i == ARRAY_SIZE(EventQueues))    // if no failures
+  else
   {
-    return true;
+    QueueStats[WhichService].Dropped++;
   }
-  else
+  ExitCritical();
+}
+
+#ifdef ES_PROFILE
+/****************************************************************************
+ Function
+   RecordRunTime
+ Parameters
+   uint8_t : Which service's run function was timed
+   uint32_t : how many core timer counts it took
+ Returns
+   None
+ Description
+   adds one call to the service's timings
+ Notes
+   the bucket is the number of the highest bit set in Counts, found 16 bits
+   at a time with ES_GetMSBitSet
+****************************************************************************/
+static void RecordRunTime(uint8_t WhichService, uint32_t Counts)
+{
+  ES_ProfileStats_t *pStats = &Profile[WhichService];
+  uint8_t           Bucket = 0;
+
+  if ((pStats->Runs == 0) || (Counts < pStats->MinCounts))
   {
-    return false;
+    pStats->MinCounts = Counts;
+  }
+  if (Counts > pStats->MaxCounts)
+  {
+    pStats->MaxCounts = Counts;
+  }
+  pStats->Runs++;
+  pStats->TotalCounts += Counts;
+  if ((Counts >> 16) != 0)
+  {
+    Bucket = 16 + ES_GetMSBitSet((uint16_t)(Counts >> 16));
   }
+  else if (Counts != 0)
+  {
+    Bucket = ES_GetMSBitSet((uint16_t)Counts);
+  }
+  if (Bucket >= ES_PROFILE_BUCKETS)
+  {
+    Bucket = ES_PROFILE_BUCKETS - 1;
+  }
+  pStats->Histogram[Bucket]++;
 }
+#endif
 
+#ifdef ES_RUN_BUDGET
 /****************************************************************************
  Function
-   ES_PostToService
+   LogOverrun
  Parameters
-   uint8_t : Which service to post to (index into ServDescList)
-   ES_Event : The Event to be posted
+   uint8_t : Which service's run function went over its budget
+   ES_Event_t : the event it was called with
+   uint32_t : how many core timer counts it took, ES_OVERRUN_WATCHDOG if it
+              never returned
  Returns
-   boolean : False if the post function failed during execution
+   None
  Description
-   posts to one of the services' queues
+   adds a record to the overrun log, over the oldest once it is full
  Notes
-   used by the timer library to associate a timer with a state machine
- Author
-   J. Edward Carryer, 01/16/12,
 ****************************************************************************/
-bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
+static void LogOverrun(uint8_t WhichService, ES_Event_t ThisEvent,
+    uint32_t Counts)
 {
-  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueFIFO(EventQueues[WhichService].pMem, TheEvent) ==
-        true))
+  ES_Overrun_t *pRecord = &Overruns[NumOverruns % ES_OVERRUN_LOG_SIZE];
+
+  pRecord->Tick     = ES_Timer_GetTime64();
+  pRecord->Counts   = Counts;
+  pRecord->Event    = ThisEvent;
+  pRecord->Service  = WhichService;
+  NumOverruns++;
+}
+#endif
+
+#ifdef EDF_DISPATCH
+/****************************************************************************
+ Function
+   GetEarliestDeadline
+ Parameters
+   None
+ Returns
+   uint8_t : the ready service whose next event has the earliest deadline
+ Description
+   works out the absolute deadline of the event each ready service would be
+   handed next, and picks the earliest
+ Notes
+   a tie goes to the higher numbered service, as it would without
+   EDF_DISPATCH. Deadlines are compared as a 16 bit difference, so the tick
+   count wrapping does not matter as long as no wait gets near 32768 ticks.
+****************************************************************************/
+static uint8_t GetEarliestDeadline(void)
+{
+  uint16_t  Now = ES_Timer_GetTime();
+  uint16_t  Posted;
+  uint16_t  Deadline;
+  uint16_t  Earliest = 0;
+  uint16_t  GroupsRemaining = ReadyGroups();
+  uint16_t  Remaining;
+  uint8_t   Group;
+  uint8_t   Which;
+  uint8_t   Choice = 0;
+  bool      Found = false;
+
+  while (GroupsRemaining != 0)
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
-    return true;
+    Group = ES_GetMSBitSet(GroupsRemaining);
+    Remaining = ReadyInGroup(Group);
+    while (Remaining != 0)
+    {
+      Which = (Group << 4) + ES_GetMSBitSet(Remaining);
+      Posted = Now;
+      if ((ISRQueues[Which] != NULL) && !ES_SPSCIsEmpty(ISRQueues[Which]))
+      { // interrupt events go first, see DeQueueISREvent
+        if (!ISRHeadStamped[Which])
+        {
+          ISRHeadSince[Which]   = Now;
+          ISRHeadStamped[Which] = true;
+        }
+        Posted = ISRHeadSince[Which];
+      }
+      else if (PostStamps[Which].Count != 0)
+      {
+        Posted = PostStamps[Which].Ticks[PostStamps[Which].Oldest];
+      }
+      Deadline = Posted + ServDeadlines[Which];
+      if (!Found || ((int16_t)(Deadline - Earliest) < 0))
+      {
+        Earliest  = Deadline;
+        Choice    = Which;
+        Found     = true;
+      }
+      Remaining &= BitNum2ClrMask[Which & 0x0F];
+    }
+    GroupsRemaining &= BitNum2ClrMask[Group];
+  }
+  return Choice;
+}
+
+/****************************************************************************
+ Function
+   NoteDispatched
+ Parameters
+   uint8_t : the service that has just been handed its event(s)
+ Returns
+   None
+ Description
+   restarts the stamp for the service's interrupt fed queue, if it has one,
+   for the event that is now at the front of it
+ Notes
+   the ordinary queue's stamps are taken off as its events are
+****************************************************************************/
+static void NoteDispatched(uint8_t WhichService)
+{
+  if ((ISRQueues[WhichService] == NULL) ||
+      ES_SPSCIsEmpty(ISRQueues[WhichService]))
+  {
+    ISRHeadStamped[WhichService] = false;
   }
   else
   {
-    return false;
+    ISRHeadSince[WhichService] = ES_Timer_GetTime();
   }
 }
 
 /****************************************************************************
  Function
-   ES_PostToServiceLIFO
+   AddStamp, DropStamps
  Parameters
-   uint8_t : Which service to post to (index into ServDescList)
-   ES_Event : The Event to be posted
+   uint8_t : the service whose queue took or gave up events
+   bool : true if the event went to the front of the queue (AddStamp)
+   uint8_t : how many events were taken from the front (DropStamps)
  Returns
-   boolean : False if the post function failed during execution
+   None
  Description
-   Posts, using LIFO strategy, to one of the services' queues
+   keep the post stamps in step with the queue
  Notes
-   used by the Defer/Recall event capability
- Author
-   J. Edward Carryer, 11/02/13
+   services may post from ISRs, so both run with interrupts off
 ****************************************************************************/
-bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
+static void AddStamp(uint8_t WhichService, bool AtFront)
 {
-  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueLIFO(EventQueues[WhichService].pMem, TheEvent) ==
-        true))
+  PostStamps_t *pStamps = &PostStamps[WhichService];
+
+  EnterCritical();
+  if (pStamps->Count < EDF_STAMP_DEPTH)
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
-    return true;
+    if (AtFront)
+    {
+      pStamps->Oldest = (pStamps->Oldest + EDF_STAMP_DEPTH - 1) %
+          EDF_STAMP_DEPTH;
+      pStamps->Ticks[pStamps->Oldest] = ES_Timer_GetTime();
+    }
+    else
+    {
+      pStamps->Ticks[(pStamps->Oldest + pStamps->Count) % EDF_STAMP_DEPTH] =
+          ES_Timer_GetTime();
+    }
+    pStamps->Count++;
   }
-  else
+  ExitCritical();
+}
+
+static void DropStamps(uint8_t WhichService, uint8_t NumStamps)
+{
+  PostStamps_t *pStamps = &PostStamps[WhichService];
+
+  EnterCritical();
+  if (NumStamps > pStamps->Count)
   {
-    return false;
+    NumStamps = pStamps->Count;
   }
+  pStamps->Oldest = (pStamps->Oldest + NumStamps) % EDF_STAMP_DEPTH;
+  pStamps->Count -= NumStamps;
+  ExitCritical();
 }
+#endif
 
-//*********************************
-// private functions
-//*********************************
 #if 0
 /****************************************************************************
  Function
@@ -33,6 +33,7 @@
 #include "ES_Types.h"
 #include "ES_General.h"
 #include "ES_Timers.h"
+#include "ES_LookupTables.h"
 #include "bitdefs.h"
 
 /*----------------------------- Module Defines ----------------------------*/
@@ -76,7 +77,7 @@ uint8_t const Nybble2MSBitNum[15] = {
 };
 
 /*------------------------------ Module Code ------------------------------*/
-uint8_t ES_GetMSBitSet(uint16_t Val2Check)
+uint8_t ES_GetMSBitSetTable(uint16_t Val2Check)
 {
   int8_t  LoopCntr;
   uint8_t Nybble2Test;
@@ -111,6 +112,7 @@ void main(void)
 {
   uint16_t  Counter = 0;
   uint8_t   MSBit;
+  uint16_t  Mismatches = 0;
 
   puts( "Testing the MSB Look-up function\n\r");
   puts( __TIME__ " " __DATE__);
@@ -122,8 +124,12 @@ void main(void)
   {
     MSBit = ES_GetMSBitSet(Counter);
     printf("the MSB set in %u is bit %d\n\r", Counter, MSBit);
+    if (MSBit != ES_GetMSBitSetTable(Counter))
+    {
+      Mismatches++;
+    }
   }
+  printf("%u mismatches between the clz and table versions\n\r", Mismatches);
 }
-
 #endif
 /*------------------------------ End of File ------------------------------*/
@@ -0,0 +1,203 @@
+/****************************************************************************
+ Module
+     ES_Payload.c
+ Description
+     A pool of NUM_PAYLOAD_BLOCKS reference counted blocks of
+     PAYLOAD_BLOCK_SIZE bytes, handed out by handle so that an event can
+     carry more than its 16 bit EventParam
+ Notes
+     a handle is the block index + 1, so ES_PAYLOAD_NONE (0) is never a
+     block. Free blocks are kept on a list threaded through NextFree.
+     Counts and the list are only touched with interrupts off, but
+     EnterCritical and ExitCritical do not nest on the PIC32, so none of
+     these may be called from an ISR or with interrupts already off.
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Payload.h"
+#include "../FrameworkHeaders/ES_Port.h" /* get the macros for EnterCritical and ExitCritical */
+
+/*----------------------------- Module Defines ----------------------------*/
+#if NUM_PAYLOAD_BLOCKS > 255
+#error NUM_PAYLOAD_BLOCKS must be no more than 255
+#endif
+
+#define END_OF_LIST 0xFF
+
+// blocks are stored as words so that any record type is aligned
+#define WORDS_PER_BLOCK ((PAYLOAD_BLOCK_SIZE + 3) / 4)
+
+/*---------------------------- Module Variables ---------------------------*/
+#if NUM_PAYLOAD_BLOCKS > 0
+static uint32_t Blocks[NUM_PAYLOAD_BLOCKS][WORDS_PER_BLOCK];
+static uint8_t  RefCounts[NUM_PAYLOAD_BLOCKS];
+static uint8_t  NextFree[NUM_PAYLOAD_BLOCKS];
+#endif
+static uint8_t  FreeList = END_OF_LIST;
+static uint8_t  NumFree;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_PayloadInit
+ Parameters
+   None
+ Returns
+   None
+ Description
+   puts every block back on the free list
+ Notes
+   called by ES_Initialize, before any service init runs
+****************************************************************************/
+void ES_PayloadInit(void)
+{
+#if NUM_PAYLOAD_BLOCKS > 0
+  uint8_t i;
+
+  for (i = 0; i < NUM_PAYLOAD_BLOCKS; i++)
+  {
+    RefCounts[i]  = 0;
+    NextFree[i]   = i + 1;
+  }
+  NextFree[NUM_PAYLOAD_BLOCKS - 1] = END_OF_LIST;
+  FreeList  = 0;
+  NumFree   = NUM_PAYLOAD_BLOCKS;
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_PayloadAlloc
+ Parameters
+   None
+ Returns
+   uint16_t : the handle of a block, or ES_PAYLOAD_NONE if none are free
+ Description
+   takes a block from the pool with a reference count of 1, held by the
+   caller
+ Notes
+   the block's contents are whatever its last user left in it
+****************************************************************************/
+uint16_t ES_PayloadAlloc(void)
+{
+  uint16_t Handle = ES_PAYLOAD_NONE;
+
+#if NUM_PAYLOAD_BLOCKS > 0
+  EnterCritical();
+  if (FreeList != END_OF_LIST)
+  {
+    Handle              = FreeList + 1;
+    RefCounts[FreeList] = 1;
+    FreeList            = NextFree[FreeList];
+    NumFree--;
+  }
+  ExitCritical();
+#endif
+  return Handle;
+}
+
+/****************************************************************************
+ Function
+   ES_PayloadGet
+ Parameters
+   uint16_t Handle : a handle from ES_PayloadAlloc, usually an EventParam
+ Returns
+   void * : the block, or NULL for ES_PAYLOAD_NONE or a bad handle
+ Description
+   see above
+ Notes
+   only valid while the caller holds a reference
+****************************************************************************/
+void *ES_PayloadGet(uint16_t Handle)
+{
+#if NUM_PAYLOAD_BLOCKS > 0
+  if ((Handle != ES_PAYLOAD_NONE) && (Handle <= NUM_PAYLOAD_BLOCKS))
+  {
+    return Blocks[Handle - 1];
+  }
+#endif
+  return NULL;
+}
+
+/****************************************************************************
+ Function
+   ES_PayloadRetain
+ Parameters
+   uint16_t Handle : the block to add a reference to
+ Returns
+   bool : false if the block is free or already has 255 references, in
+   which case none is added
+ Description
+   adds a reference, one for each service the block is posted to
+ Notes
+   a count that wrapped to 0 would free the block while it was still held
+****************************************************************************/
+bool ES_PayloadRetain(uint16_t Handle)
+{
+  bool Retained = false;
+
+#if NUM_PAYLOAD_BLOCKS > 0
+  if ((Handle != ES_PAYLOAD_NONE) && (Handle <= NUM_PAYLOAD_BLOCKS))
+  {
+    EnterCritical();
+    if ((RefCounts[Handle - 1] > 0) && (RefCounts[Handle - 1] < UINT8_MAX))
+    {
+      RefCounts[Handle - 1]++;
+      Retained = true;
+    }
+    ExitCritical();
+  }
+#endif
+  return Retained;
+}
+
+/****************************************************************************
+ Function
+   ES_PayloadRelease
+ Parameters
+   uint16_t Handle : the block to drop a reference to
+ Returns
+   None
+ Description
+   drops a reference, returning the block to the pool when the last one
+   goes
+ Notes
+   releasing a block that is already free is ignored
+****************************************************************************/
+void ES_PayloadRelease(uint16_t Handle)
+{
+#if NUM_PAYLOAD_BLOCKS > 0
+  if ((Handle != ES_PAYLOAD_NONE) && (Handle <= NUM_PAYLOAD_BLOCKS))
+  {
+    uint8_t Index = Handle - 1;
+
+    EnterCritical();
+    if ((RefCounts[Index] > 0) && (--RefCounts[Index] == 0))
+    {
+      NextFree[Index] = FreeList;
+      FreeList        = Index;
+      NumFree++;
+    }
+    ExitCritical();
+  }
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_PayloadNumFree
+ Parameters
+   None
+ Returns
+   uint8_t : the number of blocks left in the pool
+ Description
+   see above
+ Notes
+   a count that falls over time means some receiver is not releasing
+****************************************************************************/
+uint8_t ES_PayloadNumFree(void)
+{
+  return NumFree;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -52,7 +52,11 @@
 #pragma config POSCMOD = OFF            // Primary Oscillator Configuration (Primary osc disabled)
 #pragma config OSCIOFNC = OFF           // CLKO Output Signal Active on the OSCO Pin (Disabled)
 #pragma config FCKSM = CSDCMD           // Clock Switching and Monitor Selection (Clock Switch Disabled, FSCM Disabled)
+#ifdef ES_BUDGET_WATCHDOG
+#pragma config WDTPS = PS1024           // Watchdog Timer Postscaler (1:1024, about 1s)
+#else
 #pragma config WDTPS = PS1048576        // Watchdog Timer Postscaler (1:1048576)
+#endif
 #pragma config WDTSPGM = STOP           // Watchdog Timer Stop During Flash Programming (WDT stops during Flash programming)
 #pragma config WINDIS = NORMAL          // Watchdog Timer Window Mode (Watchdog Timer is in non-Window mode)
 #pragma config FWDTEN = OFF             // Watchdog Timer Enable (WDT Disabled)
@@ -98,9 +102,11 @@
 #include <stdint.h>         // for exact size data types
 #include <stdbool.h>        // for the bool data type
 
+#include "ES_Configure.h"   // for the TICKLESS_IDLE settings
 #include "ES_Port.h"        // the header file for this module
 #include "ES_Types.h"       // framework type definitions
 #include "ES_Timers.h"      // framework timer prototypes
+#include "ES_Framework.h"   // for ES_AnyEventsPending
 
 #include "terminal.h"       // terminal prototypes for init function
 
@@ -111,17 +117,27 @@
 // need to post events from the interrupt response routine. This is necessary
 // for compilers like HTC for the midrange PICs which do not produce re-entrant
 // code so cannot post directly to the queues from within the interrupt resp.
-static volatile uint8_t TickCount;
+// 16 bits because waking from a tickless sleep can add many ticks at once
+static volatile uint16_t TickCount;
 
-// Global tick count to monitor number of SysTick Interrupts
-// make uint16_t to maintain backwards compatibility and not overly burden
-// 8 and 16 bit processors
-static volatile uint16_t SysTickCounter = 0;
+// Global tick count to monitor number of SysTick Interrupts. The low 32 bits
+// and a count of the times they have wrapped make up the 64 bit monotonic
+// tick count; _HW_GetTickCount still hands out the low 16 bits to maintain
+// backwards compatibility
+static volatile uint32_t SysTickCounter = 0;
+static volatile uint32_t SysTickWraps = 0;
 
 // Rate value that needs to be continually added to the compare register to 
 // ensure the interrupts occur periodically
 static volatile TimerRate_t tickPeriod; 
 
+#ifdef TICKLESS_IDLE
+// while asleep, the number of tick periods the compare register has been
+// pushed out beyond the next regular tick. Non-zero only between _HW_Idle
+// programming a sleep and the ticks being accounted for on waking.
+static volatile uint16_t ExtraTicks;
+#endif
+
 // This variable is used to store the state of the interrupt mask when
 // doing EnterCritical/ExitCritical pairs
 // uint8_t _INTCON_temp;
@@ -132,6 +148,18 @@ static volatile TimerRate_t tickPeriod;
  ***************************************************************************/
 
 //#define LED_DEBUG
+
+#ifdef TICKLESS_IDLE
+// core timer counts needed to get the compare register re-programmed, the
+// same conservative figure the tick ISR uses
+#define COMPARE_MARGIN 12
+#endif
+
+/*---------------------------- Module Functions ---------------------------*/
+static inline void CountTicks(uint16_t NumTicks);
+#ifdef TICKLESS_IDLE
+static void ResumeTicking(void);
+#endif
 /****************************************************************************
  Function
     _HW_PIC32Init
@@ -231,7 +259,7 @@ void _HW_Timer_Init(const TimerRate_t Rate)
 void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
 {
   static uint32_t deltaTime; // static for speed
-  static uint8_t intsThatShouldHaveHappened;
+  static uint16_t intsThatShouldHaveHappened;
   
   // clear interrupt flag using the atomic write to the CLR version of the
   // interrupt flag register
@@ -281,10 +309,15 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
     _CP0_SET_COMPARE(_CP0_GET_COMPARE() + 
       (intsThatShouldHaveHappened * tickPeriod));
   }// end if (deltaTime < tickPeriod - 12)
+#ifdef TICKLESS_IDLE
+  // this compare was pushed out by a tickless sleep, so the ticks in
+  // between went by without an interrupt
+  intsThatShouldHaveHappened += ExtraTicks;
+  ExtraTicks = 0;
+#endif
   ExitCritical();
   // and keep our tick counters going
-  TickCount += intsThatShouldHaveHappened;
-  SysTickCounter += intsThatShouldHaveHappened;
+  CountTicks(intsThatShouldHaveHappened);
 
 #ifdef LED_DEBUG
   // Toggle debug line
@@ -309,7 +342,109 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
 ****************************************************************************/
 uint16_t _HW_GetTickCount(void)
 {
-  return SysTickCounter;
+  return (uint16_t)SysTickCounter;
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickCount64()
+ Parameters
+    none
+ Returns
+    uint64_t   count of number of system ticks that have occurred.
+ Description
+    the full width tick count, it will not wrap in the life of the product
+ Notes
+    the two halves are read without turning interrupts off. CountTicks
+    bumps SysTickWraps before it stores the wrapped count, so if the high
+    half reads the same on both sides of the low half, the pair is good.
+****************************************************************************/
+uint64_t _HW_GetTickCount64(void)
+{
+  uint32_t High;
+  uint32_t Low;
+
+  do
+  {
+    High = SysTickWraps;
+    Low = SysTickCounter;
+  } while (High != SysTickWraps);
+  return ((uint64_t)High << 32) | Low;
+}
+
+/****************************************************************************
+ Function
+    _HW_GetCycleCount()
+ Parameters
+    none
+ Returns
+    uint32_t   the core timer count, at half the system clock
+ Description
+    a free running count for timing short stretches of code, such as the
+    ES_PROFILE timing of the run functions
+ Notes
+    wraps every 214 seconds at 20MHz, take differences not absolute values
+****************************************************************************/
+uint32_t _HW_GetCycleCount(void)
+{
+  return _CP0_GET_COUNT();
+}
+
+/****************************************************************************
+ Function
+    _HW_WatchdogInit
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    turns the watchdog timer on, for ES_BUDGET_WATCHDOG. It is left off by
+    FWDTEN, so only builds that ask for it get it.
+ Notes
+    the period is set by WDTPS in the configuration bits, about 1s
+****************************************************************************/
+void _HW_WatchdogInit(void)
+{
+  _HW_WatchdogClear();
+  WDTCONbits.ON = 1;
+}
+
+/****************************************************************************
+ Function
+    _HW_WatchdogClear
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    restarts the watchdog period
+ Notes
+    the key must go to the upper half of WDTCON in one 16 bit write. A
+    store to WDTCONbits.WDTCLRKEY would be a 32 bit read-modify-write, which
+    does not clear it.
+****************************************************************************/
+void _HW_WatchdogClear(void)
+{
+  *((volatile uint16_t *)&WDTCON + 1) = 0x5743;
+}
+
+/****************************************************************************
+ Function
+    _HW_WatchdogCausedReset
+ Parameters
+    none
+ Returns
+    bool true if the last reset was a watchdog time out
+ Description
+    reads and clears the watchdog flag in RCON, so it answers true once
+ Notes
+****************************************************************************/
+bool _HW_WatchdogCausedReset(void)
+{
+  bool WasWatchdog = (RCONbits.WDTO != 0);
+
+  RCONbits.WDTO = 0;
+  return WasWatchdog;
 }
 
 /****************************************************************************
@@ -335,8 +470,19 @@ uint16_t _HW_GetTickCount(void)
 ****************************************************************************/
 bool _HW_Process_Pending_Ints(void)
 {
+  uint16_t Skipped;
+
   // in the case where there was a long delay in getting to this function,
-  // multiple interrupts may have occurred (TickCount > 1), so process them all
+  // multiple interrupts may have occurred (TickCount > 1). The timers are
+  // moved past all but the last in one step, up to the next expiry, and
+  // the remainder processed one at a time
+  if (TickCount > 1)
+  {
+    Skipped = ES_Timer_SkipTicks(TickCount - 1);
+    EnterCritical();
+    TickCount -= Skipped;
+    ExitCritical();
+  }
   while (TickCount > 0)
   {
     /* call the framework tick response to actually run the timers */
@@ -346,6 +492,65 @@ bool _HW_Process_Pending_Ints(void)
   return true;  // always return true to allow loop test in ES_Run to proceed
 }
 
+/****************************************************************************
+ Function
+     _HW_Idle
+ Parameters
+     none
+ Returns
+     none.
+ Description
+     called from ES_Run when all of the queues are empty and none of the
+     event checkers found anything. Gives the port a place to wait for the
+     next interrupt.
+ Notes
+     Without TICKLESS_IDLE there is nothing to do, the event checkers must
+     keep polling. With it, the core timer compare is pushed out to the next
+     timer expiry (at most TICKLESS_MAX_TICKS) and the CPU waits. Any
+     interrupt ends the wait early. WAIT is executed with interrupts off; the
+     PIC32 still wakes on a pending interrupt and carries on from the next
+     instruction, so an interrupt that lands after the last check can not be
+     slept through. The ISR runs once interrupts are back on.
+ ****************************************************************************/
+void _HW_Idle(void)
+{
+#ifdef TICKLESS_IDLE
+  uint32_t SleepTicks;
+
+  if (Terminal_IsTxPending())
+  {
+    return; // the UART FIFO needs topping up from ES_Run
+  }
+  // this takes its own critical section, so ask before turning ints off
+  SleepTicks = ES_Timer_GetTicksToNextTimeout();
+  if ((SleepTicks == 0) || (SleepTicks > TICKLESS_MAX_TICKS))
+  {
+    SleepTicks = TICKLESS_MAX_TICKS;
+  }
+  // keep the compare within half of the core timer's range, and the count
+  // of ticks slept through well inside 16 bits
+  if (SleepTicks > (INT32_MAX / tickPeriod))
+  {
+    SleepTicks = INT32_MAX / tickPeriod;
+  }
+  if (SleepTicks > INT16_MAX)
+  {
+    SleepTicks = INT16_MAX;
+  }
+  __builtin_disable_interrupts();
+  // a tick or an event that arrived since ES_Run looked needs running now
+  if ((SleepTicks > 1) && (TickCount == 0) && !ES_AnyEventsPending())
+  {
+    // the compare already holds the next regular tick, push it out
+    ExtraTicks = (uint16_t)(SleepTicks - 1);
+    _CP0_SET_COMPARE(_CP0_GET_COMPARE() + (ExtraTicks * tickPeriod));
+    _wait();
+    ResumeTicking();
+  }
+  __builtin_enable_interrupts();
+#endif
+}
+
 /****************************************************************************
  Function
      _HW_ConsoleInit
@@ -365,6 +570,79 @@ void _HW_ConsoleInit(void)
   Terminal_HWInit();
 }
 
+#ifdef TICKLESS_IDLE
+/****************************************************************************
+ Function
+     ResumeTicking
+ Parameters
+     none
+ Returns
+     none.
+ Description
+     called with interrupts off on waking from a tickless sleep. If the
+     core timer woke us its ISR will count the sleep once interrupts are
+     back on. If something else did, count the tick periods that went by
+     and put the compare back on the next regular tick.
+ Notes
+     a tick due within COMPARE_MARGIN counts as gone by, so the new compare
+     is never programmed for a time that has already passed
+ ****************************************************************************/
+static void ResumeTicking(void)
+{
+  uint32_t FirstTick;
+  uint32_t SinceFirst;
+  uint16_t Passed = 0;
+
+  if ((ExtraTicks == 0) || (IFS0bits.CTIF != 0))
+  {
+    return;
+  }
+  // the regular tick that the sleep put off
+  FirstTick = _CP0_GET_COMPARE() - (ExtraTicks * tickPeriod);
+  SinceFirst = _CP0_GET_COUNT() + COMPARE_MARGIN - FirstTick;
+  if ((int32_t)SinceFirst >= 0)
+  {
+    Passed = (SinceFirst / tickPeriod) + 1;
+  }
+  if (Passed < ExtraTicks)
+  {
+    _CP0_SET_COMPARE(FirstTick + (Passed * tickPeriod));
+    ExtraTicks = 0;
+  }
+  else
+  { // all but the last went by, leave that one to the ISR as usual
+    Passed = ExtraTicks;
+    ExtraTicks = 0;
+  }
+  CountTicks(Passed);
+}
+#endif
+
+/****************************************************************************
+ Function
+     CountTicks
+ Parameters
+     uint16_t NumTicks, the number of ticks that have just gone by
+ Returns
+     none.
+ Description
+     adds NumTicks to the pending count for _HW_Process_Pending_Ints and to
+     the tick clock
+ Notes
+     only ever called with interrupts off or from the tick ISR
+ ****************************************************************************/
+static inline void CountTicks(uint16_t NumTicks)
+{
+  uint32_t NewCount = SysTickCounter + NumTicks;
+
+  TickCount += NumTicks;
+  if (NewCount < SysTickCounter)
+  {
+    SysTickWraps++; // before the low half, see _HW_GetTickCount64
+  }
+  SysTickCounter = NewCount;
+}
+
 #if 0 // moved to terminal.c
 /****************************************************************************
  Function
@@ -104,6 +104,70 @@ bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
   }
 }
 
+/****************************************************************************
+ Function
+   ES_EnQueueFIFOInCritical
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Add : event to be added to the Queue
+ Returns
+   bool : true if the add was successful, false if not
+ Description
+   ES_EnQueueFIFO for a caller that already has interrupts off, so that it
+   can post to several queues in one critical region
+ Notes
+****************************************************************************/
+bool ES_EnQueueFIFOInCritical(ES_Event_t *pBlock, ES_Event_t Event2Add)
+{
+  pQueue_t pThisQueue = (pQueue_t)pBlock;
+
+  if (pThisQueue->NumEntries >= pThisQueue->QueueSize)
+  {
+    return false;
+  }
+  // 1+ to step past the Queue struct at the beginning of the block
+  pBlock[1 + ((pThisQueue->CurrentIndex + pThisQueue->NumEntries)
+      % pThisQueue->QueueSize)] = Event2Add;
+  pThisQueue->NumEntries++;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_ReplaceInCritical
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event NewEvent : event to put in place of the waiting one
+   ES_Event * pOldEvent : where to put the event it replaces
+ Returns
+   bool : true if an event of NewEvent's type was waiting and was replaced,
+   false if there was none and the Queue is unchanged
+ Description
+   overwrites the newest waiting event of the same type with NewEvent, in
+   its place in the Queue, for a caller that already has interrupts off
+ Notes
+****************************************************************************/
+bool ES_ReplaceInCritical(ES_Event_t *pBlock, ES_Event_t NewEvent,
+    ES_Event_t *pOldEvent)
+{
+  pQueue_t  pThisQueue = (pQueue_t)pBlock;
+  uint8_t   Which;
+  uint8_t   Slot;
+
+  for (Which = pThisQueue->NumEntries; Which > 0; Which--)
+  {
+    Slot = 1 + ((pThisQueue->CurrentIndex + Which - 1) %
+        pThisQueue->QueueSize);
+    if (pBlock[Slot].EventType == NewEvent.EventType)
+    {
+      *pOldEvent    = pBlock[Slot];
+      pBlock[Slot]  = NewEvent;
+      return true;
+    }
+  }
+  return false;
+}
+
 /****************************************************************************
  Function
    ES_EnQueueLIFO
@@ -154,6 +218,44 @@ bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
   }
 }
 
+/****************************************************************************
+ Function
+   ES_EnQueueFrontInCritical
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   const ES_Event * pEvents : the events to add, in the order they are to
+     be removed
+   uint8_t NumEvents : how many there are
+ Returns
+   bool : true if they all fit and were added, false if none were
+ Description
+   puts the events ahead of those already in the Queue, so the next DeQueue
+   takes pEvents[0], for a caller that already has interrupts off
+ Notes
+   all or nothing, the Queue is unchanged if there is not room for them all
+****************************************************************************/
+bool ES_EnQueueFrontInCritical(ES_Event_t *pBlock, const ES_Event_t *pEvents,
+    uint8_t NumEvents)
+{
+  pQueue_t  pThisQueue = (pQueue_t)pBlock;
+  uint8_t   i;
+
+  if (NumEvents > (pThisQueue->QueueSize - pThisQueue->NumEntries))
+  {
+    return false;
+  }
+  // back the read index up by NumEvents, wrapping, then copy in order
+  pThisQueue->CurrentIndex = (uint8_t)((pThisQueue->CurrentIndex +
+      pThisQueue->QueueSize - NumEvents) % pThisQueue->QueueSize);
+  for (i = 0; i < NumEvents; i++)
+  {
+    pBlock[1 + ((pThisQueue->CurrentIndex + i) % pThisQueue->QueueSize)] =
+        pEvents[i];
+  }
+  pThisQueue->NumEntries += NumEvents;
+  return true;
+}
+
 /****************************************************************************
  Function
    ES_DeQueue
@@ -205,6 +307,148 @@ uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent)
   return NumLeft;
 }
 
+/****************************************************************************
+ Function
+   ES_DeQueueBatch
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event * pDest : where to copy the events pulled from the queue
+   uint8_t MaxEvents : how many events pDest has room for
+ Returns
+   The number of events copied to pDest
+ Description
+   pulls up to MaxEvents entries from the Queue, oldest first, and copies
+   them in order to pDest
+ Notes
+   one critical region for the whole batch rather than one per event
+****************************************************************************/
+uint8_t ES_DeQueueBatch(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents)
+{
+  pQueue_t  pThisQueue;
+  uint8_t   NumTaken = 0;
+
+  pThisQueue = (pQueue_t)pBlock;
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  while ((pThisQueue->NumEntries > 0) && (NumTaken < MaxEvents))
+  {
+    pDest[NumTaken++] = pBlock[1 + pThisQueue->CurrentIndex];
+    pThisQueue->CurrentIndex++;
+    if (pThisQueue->CurrentIndex >= pThisQueue->QueueSize)
+    {
+      pThisQueue->CurrentIndex = 0;
+    }
+    pThisQueue->NumEntries--;
+  }
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return NumTaken;
+}
+
+/****************************************************************************
+ Function
+   ES_DeQueueMatching
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event * pDest : where to copy the events pulled from the queue
+   uint8_t MaxEvents : how many events pDest has room for
+   ES_EventType_t WhichType : the type to pull, ES_NO_EVENT for any type
+ Returns
+   The number of events copied to pDest
+ Description
+   pulls up to MaxEvents entries of WhichType from the Queue, from the
+   extraction point on, and copies them in order to pDest. The entries left
+   behind close up and keep their order.
+ Notes
+   one pass over the Queue in one critical region
+****************************************************************************/
+uint8_t ES_DeQueueMatching(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents, ES_EventType_t WhichType)
+{
+  pQueue_t    pThisQueue;
+  ES_Event_t  ThisEvent;
+  uint8_t     NumTaken = 0;
+  uint8_t     NumKept = 0;
+  uint8_t     i;
+
+  pThisQueue = (pQueue_t)pBlock;
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  for (i = 0; i < pThisQueue->NumEntries; i++)
+  {
+    ThisEvent = pBlock[1 + ((pThisQueue->CurrentIndex + i) %
+        pThisQueue->QueueSize)];
+    if ((NumTaken < MaxEvents) &&
+        ((WhichType == ES_NO_EVENT) || (ThisEvent.EventType == WhichType)))
+    {
+      pDest[NumTaken++] = ThisEvent;
+    }
+    else
+    {
+      pBlock[1 + ((pThisQueue->CurrentIndex + NumKept) %
+          pThisQueue->QueueSize)] = ThisEvent;
+      NumKept++;
+    }
+  }
+  pThisQueue->NumEntries = NumKept;
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return NumTaken;
+}
+
+/****************************************************************************
+ Function
+   ES_PeekMatching
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event * pDest : where to copy the events, NULL to only count them
+   uint8_t MaxEvents : how many events pDest has room for
+   ES_EventType_t WhichType : the type to look for, ES_NO_EVENT for any type
+ Returns
+   The number of events found, at most MaxEvents
+ Description
+   ES_DeQueueMatching without the DeQueue: copies the first MaxEvents
+   entries of WhichType to pDest in order and leaves the Queue as it was
+ Notes
+   a later ES_DeQueueMatching of as many events takes these same ones,
+   provided nothing has been added to the Queue in between
+****************************************************************************/
+uint8_t ES_PeekMatching(ES_Event_t *pBlock, ES_Event_t *pDest,
+    uint8_t MaxEvents, ES_EventType_t WhichType)
+{
+  pQueue_t    pThisQueue;
+  ES_Event_t  ThisEvent;
+  uint8_t     NumFound = 0;
+  uint8_t     i;
+
+  pThisQueue = (pQueue_t)pBlock;
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  for (i = 0; (i < pThisQueue->NumEntries) && (NumFound < MaxEvents); i++)
+  {
+    ThisEvent = pBlock[1 + ((pThisQueue->CurrentIndex + i) %
+        pThisQueue->QueueSize)];
+    if ((WhichType == ES_NO_EVENT) || (ThisEvent.EventType == WhichType))
+    {
+      if (pDest != NULL)
+      {
+        pDest[NumFound] = ThisEvent;
+      }
+      NumFound++;
+    }
+  }
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return NumFound;
+}
+
 /****************************************************************************
  Function
    ES_IsQueueEmpty
@@ -227,6 +471,22 @@ bool ES_IsQueueEmpty(ES_Event_t *pBlock)
   return pThisQueue->NumEntries == 0;
 }
 
+/****************************************************************************
+ Function
+   ES_QueueDepth
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+ Returns
+   uint8_t : the number of entries in the Queue
+ Description
+   see above
+ Notes
+****************************************************************************/
+uint8_t ES_QueueDepth(ES_Event_t *pBlock)
+{
+  return ((pQueue_t)pBlock)->NumEntries;
+}
+
 #if 0
 /****************************************************************************
  Function
@@ -0,0 +1,288 @@
+/****************************************************************************
+ Module
+     ES_RingQueue.c
+ Description
+     Implements a FIFO circular buffer of ES_Event_t whose size is a power
+     of 2, so that wrapping an index is a mask rather than a % or a test
+ Notes
+     the control fields live in their own struct, not in the first event of
+     the block, and are 16 bits wide so a queue may hold up to 32768 events.
+     Locking follows ES_Queue.c: posts always run with interrupts off, takes
+     only when POST_FROM_INTS is defined.
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_RingQueue.h"
+#include "../FrameworkHeaders/ES_Port.h" /* get the macros for EnterCritical and ExitCritical */
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_RingInit
+ Parameters
+   ES_RingQueue_t * pQueue : a queue declared with ES_RING_QUEUE
+ Returns
+   nothing
+ Description
+   empties the queue
+ Notes
+****************************************************************************/
+void ES_RingInit(ES_RingQueue_t *pQueue)
+{
+  pQueue->Head        = 0;
+  pQueue->NumEntries  = 0;
+}
+
+/****************************************************************************
+ Function
+   ES_RingEnQueueFIFO
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to add to
+   ES_Event_t Event2Add : event to be added to the queue
+ Returns
+   bool : true if the add was successful, false if the queue was full
+ Description
+   if it will fit, adds Event2Add to the end of the queue
+ Notes
+****************************************************************************/
+bool ES_RingEnQueueFIFO(ES_RingQueue_t *pQueue, ES_Event_t Event2Add)
+{
+  bool ReturnVal;
+
+  EnterCritical();  // save interrupt state, turn ints off
+  ReturnVal = ES_RingEnQueueFIFOInCritical(pQueue, Event2Add);
+  ExitCritical();    // restore saved interrupt state
+  return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+   ES_RingEnQueueFIFOInCritical
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to add to
+   ES_Event_t Event2Add : event to be added to the queue
+ Returns
+   bool : true if the add was successful, false if the queue was full
+ Description
+   ES_RingEnQueueFIFO for a caller that already has interrupts off, so that
+   it can post to several queues in one critical region
+ Notes
+****************************************************************************/
+bool ES_RingEnQueueFIFOInCritical(ES_RingQueue_t *pQueue,
+    ES_Event_t Event2Add)
+{
+  if (pQueue->NumEntries > pQueue->Mask)
+  {
+    return false;
+  }
+  pQueue->pSlots[(pQueue->Head + pQueue->NumEntries) & pQueue->Mask] =
+      Event2Add;
+  pQueue->NumEntries++;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RingReplaceInCritical
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to look in
+   ES_Event_t NewEvent : event to put in place of the waiting one
+   ES_Event_t * pOldEvent : where to put the event it replaces
+ Returns
+   bool : true if an event of NewEvent's type was waiting and was replaced,
+   false if there was none and the queue is unchanged
+ Description
+   overwrites the newest waiting event of the same type with NewEvent, in
+   its place in the queue, for a caller that already has interrupts off
+ Notes
+****************************************************************************/
+bool ES_RingReplaceInCritical(ES_RingQueue_t *pQueue, ES_Event_t NewEvent,
+    ES_Event_t *pOldEvent)
+{
+  uint16_t    Which;
+  ES_Event_t  *pSlot;
+
+  for (Which = pQueue->NumEntries; Which > 0; Which--)
+  {
+    pSlot = &pQueue->pSlots[(pQueue->Head + Which - 1) & pQueue->Mask];
+    if (pSlot->EventType == NewEvent.EventType)
+    {
+      *pOldEvent  = *pSlot;
+      *pSlot      = NewEvent;
+      return true;
+    }
+  }
+  return false;
+}
+
+/****************************************************************************
+ Function
+   ES_RingEnQueueLIFO
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to add to
+   ES_Event_t Event2Add : event to be added to the queue
+ Returns
+   bool : true if the add was successful, false if the queue was full
+ Description
+   if it will fit, adds Event2Add at the extraction point, making it the
+   next event to be removed
+ Notes
+****************************************************************************/
+bool ES_RingEnQueueLIFO(ES_RingQueue_t *pQueue, ES_Event_t Event2Add)
+{
+  bool ReturnVal = false;
+
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  if (pQueue->NumEntries <= pQueue->Mask)
+  {
+    pQueue->Head = (pQueue->Head - 1) & pQueue->Mask;
+    pQueue->pSlots[pQueue->Head] = Event2Add;
+    pQueue->NumEntries++;
+    ReturnVal = true;
+  }
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+   ES_RingEnQueueFrontInCritical
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to add to
+   const ES_Event_t * pEvents : the events to add, in the order they are to
+     be removed
+   uint16_t NumEvents : how many there are
+ Returns
+   bool : true if they all fit and were added, false if none were
+ Description
+   puts the events ahead of those already in the queue, so the next DeQueue
+   takes pEvents[0], for a caller that already has interrupts off
+ Notes
+   all or nothing, the queue is unchanged if there is not room for them all
+****************************************************************************/
+bool ES_RingEnQueueFrontInCritical(ES_RingQueue_t *pQueue,
+    const ES_Event_t *pEvents, uint16_t NumEvents)
+{
+  uint16_t i;
+
+  if (NumEvents > (uint16_t)(pQueue->Mask + 1 - pQueue->NumEntries))
+  {
+    return false;
+  }
+  pQueue->Head = (pQueue->Head - NumEvents) & pQueue->Mask;
+  for (i = 0; i < NumEvents; i++)
+  {
+    pQueue->pSlots[(pQueue->Head + i) & pQueue->Mask] = pEvents[i];
+  }
+  pQueue->NumEntries += NumEvents;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RingDeQueue
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to take from
+   ES_Event_t * pReturnEvent : used to return the event pulled from the queue
+ Returns
+   The number of entries remaining in the queue
+ Description
+   pulls the oldest entry from the queue, ES_NO_EVENT if the queue was empty
+ Notes
+****************************************************************************/
+uint16_t ES_RingDeQueue(ES_RingQueue_t *pQueue, ES_Event_t *pReturnEvent)
+{
+  uint16_t NumLeft = 0;
+
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  if (pQueue->NumEntries > 0)
+  {
+    *pReturnEvent = pQueue->pSlots[pQueue->Head];
+    pQueue->Head  = (pQueue->Head + 1) & pQueue->Mask;
+    NumLeft       = --pQueue->NumEntries;
+  }
+  else
+  {
+    pReturnEvent->EventType   = ES_NO_EVENT;
+    pReturnEvent->EventParam  = 0;
+  }
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return NumLeft;
+}
+
+/****************************************************************************
+ Function
+   ES_RingDeQueueBatch
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to take from
+   ES_Event_t * pDest : where to copy the events pulled from the queue
+   uint16_t MaxEvents : how many events pDest has room for
+ Returns
+   The number of events copied to pDest
+ Description
+   pulls up to MaxEvents entries from the queue, oldest first, and copies
+   them in order to pDest
+ Notes
+   one critical region for the whole batch rather than one per event
+****************************************************************************/
+uint16_t ES_RingDeQueueBatch(ES_RingQueue_t *pQueue, ES_Event_t *pDest,
+    uint16_t MaxEvents)
+{
+  uint16_t NumTaken = 0;
+
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  while ((pQueue->NumEntries > 0) && (NumTaken < MaxEvents))
+  {
+    pDest[NumTaken++] = pQueue->pSlots[pQueue->Head];
+    pQueue->Head      = (pQueue->Head + 1) & pQueue->Mask;
+    pQueue->NumEntries--;
+  }
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return NumTaken;
+}
+
+/****************************************************************************
+ Function
+   ES_RingIsEmpty
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to check
+ Returns
+   bool : true if the queue is empty
+ Description
+   see above
+ Notes
+****************************************************************************/
+bool ES_RingIsEmpty(ES_RingQueue_t *pQueue)
+{
+  return pQueue->NumEntries == 0;
+}
+
+/****************************************************************************
+ Function
+   ES_RingDepth
+ Parameters
+   ES_RingQueue_t * pQueue : the queue to check
+ Returns
+   uint16_t : the number of entries in the queue
+ Description
+   see above
+ Notes
+****************************************************************************/
+uint16_t ES_RingDepth(ES_RingQueue_t *pQueue)
+{
+  return pQueue->NumEntries;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,156 @@
+/****************************************************************************
+ Module
+     ES_SPSCQueue.c
+ Description
+     Implements a wait-free FIFO of ES_Event_t for exactly one producer and
+     one consumer, normally an ISR posting to a service.
+ Notes
+     Head and Tail are free running 16 bit counts; the slot is the count
+     masked by size - 1, and Head - Tail is the number of entries. Each side
+     only ever writes its own index, so neither side needs to turn interrupts
+     off. The producer stores the event before publishing the new Head and
+     the consumer reads the event before publishing the new Tail. On the
+     single core PIC32 the acquire/release only has to stop the compiler
+     from reordering; on a multi-core host it also orders the memory.
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_SPSCQueue.h"
+#include "../FrameworkHeaders/ES_Port.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_SPSC_SIZE 32768U
+
+#define LoadAcquire(Index) __atomic_load_n(&(Index), __ATOMIC_ACQUIRE)
+#define StoreRelease(Index, Value) \
+  __atomic_store_n(&(Index), (Value), __ATOMIC_RELEASE)
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_SPSCInit
+ Parameters
+   ES_SPSCQueue_t * pQueue : the queue to initialize
+   ES_Event_t * pSlots : the storage for the entries
+   uint16_t Size : the number of entries in pSlots, a power of 2
+ Returns
+   bool : false if Size is not a power of 2 (or is 0 or too big)
+ Description
+   sets up an empty queue over pSlots
+ Notes
+   call before the interrupt that feeds the queue is enabled
+****************************************************************************/
+bool ES_SPSCInit(ES_SPSCQueue_t *pQueue, ES_Event_t *pSlots, uint16_t Size)
+{
+  if ((Size == 0) || (Size > MAX_SPSC_SIZE) || ((Size & (Size - 1)) != 0))
+  {
+    return false;
+  }
+  pQueue->Head    = 0;
+  pQueue->Tail    = 0;
+  pQueue->Mask    = Size - 1;
+  pQueue->pSlots  = pSlots;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_SPSCEnQueue
+ Parameters
+   ES_SPSCQueue_t * pQueue : the queue to add to
+   ES_Event_t Event2Add : event to be added to the queue
+ Returns
+   bool : true if the add was successful, false if the queue was full
+ Description
+   producer side, if it will fit, adds Event2Add to the queue
+ Notes
+   safe to call from an ISR, never masks interrupts
+****************************************************************************/
+bool ES_SPSCEnQueue(ES_SPSCQueue_t *pQueue, ES_Event_t Event2Add)
+{
+  uint16_t Head = pQueue->Head; // ours, no need for ordering
+  uint16_t Tail = LoadAcquire(pQueue->Tail);
+
+  if ((uint16_t)(Head - Tail) > pQueue->Mask)
+  {
+    return false; // full
+  }
+  pQueue->pSlots[Head & pQueue->Mask] = Event2Add;
+  StoreRelease(pQueue->Head, (uint16_t)(Head + 1));
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_SPSCDeQueue
+ Parameters
+   ES_SPSCQueue_t * pQueue : the queue to take from
+   ES_Event_t * pReturnEvent : used to return the event pulled from the queue
+ Returns
+   bool : true if an event was returned, false if the queue was empty
+ Description
+   consumer side, pulls the oldest entry from the queue
+ Notes
+****************************************************************************/
+bool ES_SPSCDeQueue(ES_SPSCQueue_t *pQueue, ES_Event_t *pReturnEvent)
+{
+  uint16_t Tail = pQueue->Tail; // ours, no need for ordering
+  uint16_t Head = LoadAcquire(pQueue->Head);
+
+  if (Head == Tail)
+  {
+    return false; // empty
+  }
+  *pReturnEvent = pQueue->pSlots[Tail & pQueue->Mask];
+  StoreRelease(pQueue->Tail, (uint16_t)(Tail + 1));
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_SPSCDeQueueBatch
+ Parameters
+   ES_SPSCQueue_t * pQueue : the queue to take from
+   ES_Event_t * pDest : where to copy the events pulled from the queue
+   uint16_t MaxEvents : how many events pDest has room for
+ Returns
+   uint16_t the number of events copied to pDest
+ Description
+   consumer side, pulls up to MaxEvents entries, oldest first
+ Notes
+   Tail is published once for the whole batch
+****************************************************************************/
+uint16_t ES_SPSCDeQueueBatch(ES_SPSCQueue_t *pQueue, ES_Event_t *pDest,
+    uint16_t MaxEvents)
+{
+  uint16_t Tail = pQueue->Tail;
+  uint16_t Head = LoadAcquire(pQueue->Head);
+  uint16_t NumTaken = 0;
+
+  while ((Tail != Head) && (NumTaken < MaxEvents))
+  {
+    pDest[NumTaken++] = pQueue->pSlots[Tail & pQueue->Mask];
+    Tail++;
+  }
+  StoreRelease(pQueue->Tail, Tail);
+  return NumTaken;
+}
+
+/****************************************************************************
+ Function
+   ES_SPSCIsEmpty
+ Parameters
+   ES_SPSCQueue_t * pQueue : the queue to check
+ Returns
+   bool : true if the queue is empty
+ Description
+   see above
+ Notes
+   only meaningful to the consumer, the producer may add to it at any time
+****************************************************************************/
+bool ES_SPSCIsEmpty(ES_SPSCQueue_t *pQueue)
+{
+  return LoadAcquire(pQueue->Head) == pQueue->Tail;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
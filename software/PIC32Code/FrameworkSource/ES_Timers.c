@@ -3,12 +3,22 @@
      ES_Timers.c
 
  Description
-     This is a module implementing  8 16 bit timers all using the RTI
-     timebase
+     This is a module implementing up to 64 (255 with the timing wheel)
+     32 bit timers all using the RTI timebase, and the tick clocks
 
  Notes
      Everything is done in terms of RTI Ticks, which can change from
      application to application.
+     By default every tick walks every active timer, which is cheap for the
+     handful of timers most projects run. Defining TIMER_WHEEL_SIZE in
+     ES_Configure.h swaps in a hashed timing wheel (see Footnotes), where a
+     tick only looks at the timers filed under that tick's slot.
+     NUM_DYNAMIC_TIMERS more timers, numbered from MAX_NUM_TIMERS up, are
+     handed out at run time by ES_Timer_Alloc and post to the service they
+     were allocated for rather than to a TIMERn_RESP_FUNC. Their timeouts
+     carry a generation count that ES_Timer_Free bumps, so a timeout left in
+     a queue by a freed timer is dropped rather than delivered to whoever
+     gets the timer next.
 
  History
  When           Who     What/Why
@@ -53,45 +63,118 @@
 /*--------------------------- External Variables --------------------------*/
 
 /*----------------------------- Module Defines ----------------------------*/
+#ifndef NUM_DYNAMIC_TIMERS
+#define NUM_DYNAMIC_TIMERS 0
+#endif
+// the fixed timers followed by the pool for ES_Timer_Alloc
+#define NUM_TIMERS (MAX_NUM_TIMERS + NUM_DYNAMIC_TIMERS)
+#define IsDynamic(Num) ((Num) >= MAX_NUM_TIMERS)
+// the owner of a dynamic timer that is in the pool
+#define NO_OWNER 0xFF
+// the walks over the active flags take a bit, clear it and look again.
+// Each clz waits on the last clear, and on the host BenchMSBit has the
+// nybble table ahead per tick, so the timers keep it even where ES_Run
+// uses clz.
+#define TimerMSBit(Val2Check) ES_GetMSBitSetTable(Val2Check)
 
-/*------------------------------ Module Types -----------------------------*/
+#ifdef TIMER_WHEEL_SIZE
+#if NUM_TIMERS > 255
+#error "the timing wheel supports at most 255 timers"
+#endif
+#if (TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) != 0
+#error "TIMER_WHEEL_SIZE must be a power of 2"
+#endif
+#define WHEEL_MASK (TIMER_WHEEL_SIZE - 1)
+// marks the end of a slot's list, timer numbers stop at 254
+#define NO_TIMER 0xFF
+#elif NUM_TIMERS > 64
+#error "more than 64 timers needs the timing wheel, define TIMER_WHEEL_SIZE"
+#endif
 
-/*
-   the size of Tflag sets the number of timers, uint8 = 8, uint16 = 16 ...)
-   to add more timers, you will need to change the data type and modify
-   the initialization of TMR_TimerArray and TMR_MaskArray
-*/
+// only the first 64 timers have their own response function, any beyond that
+// share TIMER_EXTRA_RESP_FUNC and are told apart by the EventParam
+#if MAX_NUM_TIMERS > 64
+#define NUM_RESP_FUNCS 64
+#define PostFuncFor(Num) \
+  (((Num) < NUM_RESP_FUNCS) ? Timer2PostFunc[(Num)] : TIMER_EXTRA_RESP_FUNC)
+#else
+#define NUM_RESP_FUNCS MAX_NUM_TIMERS
+#define PostFuncFor(Num) (Timer2PostFunc[(Num)])
+#endif
 
-typedef uint16_t Tflag_t;
+/*------------------------------ Module Types -----------------------------*/
 
-typedef uint16_t Timer_t; // sets size of timers to 16 bits
+typedef uint32_t Timer_t; // sets size of timers to 32 bits
 
 /*---------------------------- Module Functions ---------------------------*/
+static void StartCounting(uint8_t Num);
+static void StopCounting(uint8_t Num);
+static void PostTimeout(uint8_t Num);
+static bool HasService(uint8_t Num);
+#ifdef TIMER_WHEEL_SIZE
+static void LinkTimer(uint8_t Num);
+static void UnlinkTimer(uint8_t Num);
+#endif
 
 /*---------------------------- Module Variables ---------------------------*/
-static Timer_t TMR_TimerArray[sizeof(Tflag_t) * BITS_PER_BYTE] =
-{
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0
-};
+static Timer_t TMR_TimerArray[NUM_TIMERS];
+
+// the reload for a periodic timer, 0 for a one-shot
+static Timer_t TMR_Period[NUM_TIMERS];
+// set while a periodic timer's last ES_TIMEOUT is waiting in a queue, an
+// expiry that finds it set is an overrun and is counted instead of posted
+static bool     TMR_TimeoutQueued[NUM_TIMERS];
+static uint16_t TMR_Overruns[NUM_TIMERS];
 
-static Tflag_t TMR_ActiveFlags;
+#if NUM_DYNAMIC_TIMERS > 0
+// the service each dynamic timer posts to, NO_OWNER while it is in the pool
+static uint8_t  DynamicOwner[NUM_DYNAMIC_TIMERS];
+// a stack of the dynamic timers in the pool, the top one is handed out next
+static uint8_t  DynamicFree[NUM_DYNAMIC_TIMERS];
+static uint8_t  NumDynamicFree;
+// bumped by every free, the high byte of the timer's timeout EventParams
+static uint8_t  DynamicGen[NUM_DYNAMIC_TIMERS];
+#endif
 
-static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
+/*
+   up to 16 timers the active flags are a single word. Beyond that they are a
+   two level bitmap (see ES_LookupTables.h), where word 0 says which groups of
+   16 timers have any active. Either way the code below walks the active
+   timers a group at a time, the single word case being one group. The wheel
+   keeps the flags up to date too, but only to answer 'is it running'.
+*/
+#if NUM_TIMERS > 16
+static uint16_t TMR_ActiveFlags[ES_BITMAP_SIZE(NUM_TIMERS)];
+
+#define ActiveGroups()        (TMR_ActiveFlags[0])
+#define ActiveInGroup(Group)  (TMR_ActiveFlags[(Group) + 1])
+#define SetActive(Num)        ES_BitmapSet(TMR_ActiveFlags, (Num))
+#define ClearActive(Num)      ES_BitmapClear(TMR_ActiveFlags, (Num))
+#define IsActive(Num)         \
+  ((TMR_ActiveFlags[((Num) >> 4) + 1] & BitNum2SetMask[(Num) & 0x0F]) != 0)
+#else
+static uint16_t TMR_ActiveFlags;
+
+#define ActiveGroups()        ((TMR_ActiveFlags != 0) ? BIT0HI : 0)
+#define ActiveInGroup(Group)  (TMR_ActiveFlags)
+#define SetActive(Num)        (TMR_ActiveFlags |= BitNum2SetMask[(Num)])
+#define ClearActive(Num)      (TMR_ActiveFlags &= BitNum2ClrMask[(Num)])
+#define IsActive(Num)         ((TMR_ActiveFlags & BitNum2SetMask[(Num)]) != 0)
+#endif
+
+#ifdef TIMER_WHEEL_SIZE
+// each slot heads a doubly linked list of the timers that expire on a tick
+// that maps to it, the links are timer numbers
+static uint8_t  WheelSlots[TIMER_WHEEL_SIZE];
+static uint8_t  TMR_Next[NUM_TIMERS];
+static uint8_t  TMR_Prev[NUM_TIMERS];
+// the value of WheelNow on the tick that the timer expires
+static uint32_t TMR_Expiry[NUM_TIMERS];
+// ticks seen by ES_Timer_Tick_Resp
+static uint32_t WheelNow;
+#endif
+
+static pPostFunc const Timer2PostFunc[NUM_RESP_FUNCS] =
 {
   TIMER0_RESP_FUNC,
   TIMER1_RESP_FUNC,
@@ -109,6 +192,56 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
   TIMER13_RESP_FUNC,
   TIMER14_RESP_FUNC,
   TIMER15_RESP_FUNC
+#if MAX_NUM_TIMERS > 16
+  , TIMER16_RESP_FUNC
+  , TIMER17_RESP_FUNC
+  , TIMER18_RESP_FUNC
+  , TIMER19_RESP_FUNC
+  , TIMER20_RESP_FUNC
+  , TIMER21_RESP_FUNC
+  , TIMER22_RESP_FUNC
+  , TIMER23_RESP_FUNC
+  , TIMER24_RESP_FUNC
+  , TIMER25_RESP_FUNC
+  , TIMER26_RESP_FUNC
+  , TIMER27_RESP_FUNC
+  , TIMER28_RESP_FUNC
+  , TIMER29_RESP_FUNC
+  , TIMER30_RESP_FUNC
+  , TIMER31_RESP_FUNC
+  , TIMER32_RESP_FUNC
+  , TIMER33_RESP_FUNC
+  , TIMER34_RESP_FUNC
+  , TIMER35_RESP_FUNC
+  , TIMER36_RESP_FUNC
+  , TIMER37_RESP_FUNC
+  , TIMER38_RESP_FUNC
+  , TIMER39_RESP_FUNC
+  , TIMER40_RESP_FUNC
+  , TIMER41_RESP_FUNC
+  , TIMER42_RESP_FUNC
+  , TIMER43_RESP_FUNC
+  , TIMER44_RESP_FUNC
+  , TIMER45_RESP_FUNC
+  , TIMER46_RESP_FUNC
+  , TIMER47_RESP_FUNC
+  , TIMER48_RESP_FUNC
+  , TIMER49_RESP_FUNC
+  , TIMER50_RESP_FUNC
+  , TIMER51_RESP_FUNC
+  , TIMER52_RESP_FUNC
+  , TIMER53_RESP_FUNC
+  , TIMER54_RESP_FUNC
+  , TIMER55_RESP_FUNC
+  , TIMER56_RESP_FUNC
+  , TIMER57_RESP_FUNC
+  , TIMER58_RESP_FUNC
+  , TIMER59_RESP_FUNC
+  , TIMER60_RESP_FUNC
+  , TIMER61_RESP_FUNC
+  , TIMER62_RESP_FUNC
+  , TIMER63_RESP_FUNC
+#endif
 };
 
 /*------------------------------ Module Code ------------------------------*/
@@ -130,6 +263,25 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
 ****************************************************************************/
 void ES_Timer_Init(TimerRate_t Rate)
 {
+#if defined(TIMER_WHEEL_SIZE) || (NUM_DYNAMIC_TIMERS > 0)
+  uint16_t i;
+#endif
+
+#ifdef TIMER_WHEEL_SIZE
+  for (i = 0; i < TIMER_WHEEL_SIZE; i++)
+  {
+    WheelSlots[i] = NO_TIMER;
+  }
+#endif
+#if NUM_DYNAMIC_TIMERS > 0
+  // stacked so that the lowest numbered timer is handed out first
+  for (i = 0; i < NUM_DYNAMIC_TIMERS; i++)
+  {
+    DynamicOwner[i] = NO_OWNER;
+    DynamicFree[i]  = (uint8_t)(NUM_TIMERS - 1 - i);
+  }
+  NumDynamicFree = NUM_DYNAMIC_TIMERS;
+#endif
   // call the hardware init routine
   _HW_Timer_Init(Rate);
 }
@@ -139,28 +291,40 @@ void ES_Timer_Init(TimerRate_t Rate)
      ES_Timer_SetTimer
  Parameters
      unsigned char Num, the number of the timer to set.
-     unsigned int NewTime, the new time to set on that timer
+     uint32_t NewTime, the new time to set on that timer
  Returns
      ES_Timer_ERR if requested timer does not exist or has no service
      ES_Timer_OK  otherwise
  Description
      sets the time for a timer, but does not make it active.
  Notes
-     None.
+     a running timer starts over with the new time. A periodic timer becomes
+     a one-shot.
  Author
      J. Edward Carryer, 02/24/97 17:11
 ****************************************************************************/
-ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint32_t NewTime)
 {
   /* tried to set a timer that doesn't exist */
   if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
       /* tried to set a timer without a service */
-      (Timer2PostFunc[Num] == TIMER_UNUSED) ||
+      !HasService(Num) ||
       (NewTime == 0))   /* no time being set */
   {
     return ES_Timer_ERR;
   }
-  TMR_TimerArray[Num] = NewTime;
+  if (IsActive(Num))
+  {
+    StopCounting(Num);
+    TMR_Period[Num] = 0;
+    TMR_TimerArray[Num] = NewTime;
+    StartCounting(Num);
+  }
+  else
+  {
+    TMR_Period[Num] = 0;
+    TMR_TimerArray[Num] = NewTime;
+  }
   return ES_Timer_OK;
 }
 
@@ -172,10 +336,9 @@ ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
  Returns
      ES_Timer_ERR for error ES_Timer_OK for success
  Description
-     simply sets the active flag in TMR_ActiveFlags to (re)start a
-     stopped timer.
+     (re)starts a stopped timer with whatever time it had left
  Notes
-     None.
+     starting a running timer changes nothing
  Author
      J. Edward Carryer, 02/24/97 14:45
 ****************************************************************************/
@@ -188,7 +351,7 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
   {
     return ES_Timer_ERR;
   }
-  TMR_ActiveFlags |= BitNum2SetMask[Num];  /* set timer as active */
+  StartCounting(Num);
   return ES_Timer_OK;
 }
 
@@ -200,10 +363,9 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
  Returns
      ES_Timer_ERR for error (timer doesn't exist) ES_Timer_OK for success.
  Description
-     simply clears the bit in TMR_ActiveFlags associated with this
-     timer. This will cause it to stop counting.
+     stops the timer counting, the time left is kept for StartTimer
  Notes
-     None.
+     a periodic timer stays periodic, StartTimer picks up where it left off
  Author
      J. Edward Carryer, 02/24/97 14:48
 ****************************************************************************/
@@ -213,7 +375,7 @@ ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
   {
     return ES_Timer_ERR;    /* tried to set a timer that doesn't exist */
   }
-  TMR_ActiveFlags &= BitNum2ClrMask[Num];  /* set timer as inactive */
+  StopCounting(Num);
   return ES_Timer_OK;
 }
 
@@ -222,33 +384,199 @@ ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
      ES_Timer_InitTimer
  Parameters
      unsigned char Num, the number of the timer to start
-     unsigned int NewTime, the number of ticks to be counted
+     uint32_t NewTime, the number of ticks to be counted
  Returns
      ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise.
  Description
      sets the NewTime into the chosen timer and sets the timer active to
      begin counting.
  Notes
-     None.
+     the timer is a one-shot, even if it was periodic before
  Author
      J. Edward Carryer, 02/24/97 14:51
 ****************************************************************************/
-ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint32_t NewTime)
 {
   /* tried to set a timer that doesn't exist */
   if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
       /* tried to set a timer without a service */
-      (Timer2PostFunc[Num] == TIMER_UNUSED) ||
+      !HasService(Num) ||
       /* tried to set a timer without putting any time on it */
       (NewTime == 0))
   {
     return ES_Timer_ERR;
   }
+  StopCounting(Num);
+  TMR_Period[Num] = 0;
   TMR_TimerArray[Num] = NewTime;
-  TMR_ActiveFlags     |= BitNum2SetMask[Num]; /* set timer as active */
+  StartCounting(Num);
   return ES_Timer_OK;
 }
 
+/****************************************************************************
+ Function
+     ES_Timer_InitPeriodic
+ Parameters
+     uint8_t Num, the number of the timer to start
+     uint32_t Period, the number of ticks between timeouts
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise.
+ Description
+     starts the timer as a periodic one. It posts ES_TIMEOUT every Period
+     ticks until it is stopped or re-initialized, and clears its overrun
+     count.
+ Notes
+     The timer reloads itself on the tick it expires, so the period does not
+     stretch by however long the service takes to get to the timeout. If
+     the last timeout is still queued when the next expiry comes round, that
+     expiry is counted (ES_Timer_GetOverruns) rather than posted.
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_InitPeriodic(uint8_t Num, uint32_t Period)
+{
+  if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
+      !HasService(Num) ||
+      (Period == 0))
+  {
+    return ES_Timer_ERR;
+  }
+  StopCounting(Num);
+  TMR_Period[Num] = Period;
+  TMR_TimerArray[Num] = Period;
+  TMR_Overruns[Num] = 0;
+  StartCounting(Num);
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetOverruns
+ Parameters
+     uint8_t Num, the number of the timer
+ Returns
+     uint16_t the expiries of the periodic timer that were not posted
+     because the previous ES_TIMEOUT was still queued, or could not be
+     posted, since ES_Timer_InitPeriodic. Stops at 65535.
+ Description
+     lets a service, or whoever is tuning it, see that it is not keeping up
+     with its timer
+ Notes
+     always 0 for a one-shot timer
+****************************************************************************/
+uint16_t ES_Timer_GetOverruns(uint8_t Num)
+{
+  if (Num >= ARRAY_SIZE(TMR_TimerArray))
+  {
+    return 0;
+  }
+  return TMR_Overruns[Num];
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_TimeoutDispatched
+ Parameters
+     uint16_t Param, the EventParam of the ES_TIMEOUT
+ Returns
+     bool false if the timeout is from a dynamic timer that has been freed
+     since it was posted, true otherwise
+ Description
+     called by ES_Run as it hands an ES_TIMEOUT to a service, so that the
+     timer's next expiry can be posted again
+ Notes
+     not for use by services. ES_Run drops the timeouts this turns down.
+****************************************************************************/
+bool ES_Timer_TimeoutDispatched(uint16_t Param)
+{
+  uint8_t Num = ES_TIMER_HANDLE(Param);
+
+  if (Num >= ARRAY_SIZE(TMR_TimeoutQueued))
+  {
+    return true;
+  }
+#if NUM_DYNAMIC_TIMERS > 0
+  if (IsDynamic(Num) && ((Param >> 8) != DynamicGen[Num - MAX_NUM_TIMERS]))
+  {
+    return false; // the timer has a new owner, the flag is theirs
+  }
+#endif
+  TMR_TimeoutQueued[Num] = false;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_Alloc
+ Parameters
+     uint8_t WhichService, the service (index into ServDescList) that the
+     timer's ES_TIMEOUT events go to
+ Returns
+     ES_TimerHandle_t the timer number to use with the other ES_Timer
+     functions, ES_TIMER_NO_HANDLE if the pool is empty or there is no such
+     service
+ Description
+     takes a timer from the pool of NUM_DYNAMIC_TIMERS and binds it to
+     WhichService, stopped and with no time on it
+ Notes
+     the handle is the low byte of the EventParam of the timer's ES_TIMEOUT
+     events (ES_TIMER_HANDLE), the high byte is its generation. Call from
+     the services, not from an ISR.
+****************************************************************************/
+ES_TimerHandle_t ES_Timer_Alloc(uint8_t WhichService)
+{
+#if NUM_DYNAMIC_TIMERS > 0
+  uint8_t Num;
+
+  if ((WhichService >= NUM_SERVICES) || (NumDynamicFree == 0))
+  {
+    return ES_TIMER_NO_HANDLE;
+  }
+  Num = DynamicFree[--NumDynamicFree];
+  DynamicOwner[Num - MAX_NUM_TIMERS] = WhichService;
+  TMR_TimerArray[Num]     = 0;
+  TMR_Period[Num]         = 0;
+  TMR_TimeoutQueued[Num]  = false;
+  TMR_Overruns[Num]       = 0;
+  return Num;
+#else
+  return ES_TIMER_NO_HANDLE;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_Free
+ Parameters
+     ES_TimerHandle_t Handle, a timer from ES_Timer_Alloc
+ Returns
+     ES_Timer_ERR if Handle is not an allocated dynamic timer, ES_Timer_OK
+     otherwise
+ Description
+     stops the timer and puts it back in the pool
+ Notes
+     a timeout that was posted before the free is dropped by ES_Run, even
+     if the handle has been allocated again by then. The generation is 8
+     bits, so that only fails if the timer is freed 256 times while the
+     timeout waits.
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_Free(ES_TimerHandle_t Handle)
+{
+#if NUM_DYNAMIC_TIMERS > 0
+  if ((Handle >= NUM_TIMERS) || !IsDynamic(Handle) ||
+      (DynamicOwner[Handle - MAX_NUM_TIMERS] == NO_OWNER))
+  {
+    return ES_Timer_ERR;
+  }
+  StopCounting(Handle);
+  TMR_TimerArray[Handle] = 0; // so StartTimer cannot bring it back
+  DynamicOwner[Handle - MAX_NUM_TIMERS] = NO_OWNER;
+  DynamicGen[Handle - MAX_NUM_TIMERS]++; // retires any queued timeouts
+  DynamicFree[NumDynamicFree++] = Handle;
+  return ES_Timer_OK;
+#else
+  return ES_Timer_ERR;
+#endif
+}
+
 /****************************************************************************
  Function
      ES_Timer_GetTime
@@ -270,6 +598,157 @@ uint16_t ES_Timer_GetTime(void)
   return _HW_GetTickCount();
 }
 
+/****************************************************************************
+ Function
+     ES_Timer_GetTime64
+ Parameters
+     None.
+ Returns
+     uint64_t the number of ticks since the framework was initialized
+ Description
+     a monotonic clock that will not wrap in the life of the product, for
+     time stamps and elapsed time math over any interval
+ Notes
+     kept by the port alongside the 16 bit count, reading it is a couple of
+     loads and never turns interrupts off
+****************************************************************************/
+uint64_t ES_Timer_GetTime64(void)
+{
+  return _HW_GetTickCount64();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetTicksToNextTimeout
+ Parameters
+     None.
+ Returns
+     uint32_t the number of ticks until the next active timer expires, 0 if
+     no timers are active
+ Description
+     lets the port know how long the framework can sleep before a timer
+     needs attention
+ Notes
+     a timer with 1 tick left expires on the very next tick
+****************************************************************************/
+#ifdef TIMER_WHEEL_SIZE
+uint32_t ES_Timer_GetTicksToNextTimeout(void)
+{
+  uint16_t  Ahead;
+  uint32_t  Left;
+  uint32_t  Soonest = 0;
+  uint8_t   TimerNum;
+
+  EnterCritical();
+  /* the first slot ahead holding a timer due within this turn of the wheel
+     has the answer. Timers further out are seen on the way round, so after
+     a full turn the soonest of them is the answer */
+  for (Ahead = 1; Ahead <= TIMER_WHEEL_SIZE; Ahead++)
+  {
+    TimerNum = WheelSlots[(WheelNow + Ahead) & WHEEL_MASK];
+    while (TimerNum != NO_TIMER)
+    {
+      Left = TMR_Expiry[TimerNum] - WheelNow;
+      if (Left == Ahead)
+      {
+        ExitCritical();
+        return Left;
+      }
+      if ((Soonest == 0) || (Left < Soonest))
+      {
+        Soonest = Left;
+      }
+      TimerNum = TMR_Next[TimerNum];
+    }
+  }
+  ExitCritical();
+  return Soonest;
+}
+#else
+uint32_t ES_Timer_GetTicksToNextTimeout(void)
+{
+  uint16_t  GroupsRemaining = ActiveGroups();
+  uint16_t  Remaining;
+  uint8_t   Group;
+  uint8_t   TimerNum;
+  uint32_t  Soonest = 0;
+
+  while (GroupsRemaining != 0)
+  {
+    Group = TimerMSBit(GroupsRemaining);
+    Remaining = ActiveInGroup(Group);
+    while (Remaining != 0)
+    {
+      TimerNum = (Group << 4) + TimerMSBit(Remaining);
+      if ((Soonest == 0) || (TMR_TimerArray[TimerNum] < Soonest))
+      {
+        Soonest = TMR_TimerArray[TimerNum];
+      }
+      Remaining &= BitNum2ClrMask[TimerNum & 0x0F];
+    }
+    GroupsRemaining &= BitNum2ClrMask[Group];
+  }
+  return Soonest;
+}
+#endif
+
+/****************************************************************************
+ Function
+     ES_Timer_SkipTicks
+ Parameters
+     uint32_t NumTicks, the number of ticks that have gone by unprocessed
+ Returns
+     uint32_t how many of those ticks were accounted for. Each of the rest
+     still needs its own call to ES_Timer_Tick_Resp.
+ Description
+     moves every active timer on by as many of NumTicks as it can in one
+     step, stopping one tick short of the next expiry so that the timeout is
+     still posted by ES_Timer_Tick_Resp
+ Notes
+     lets the port catch up on a run of ticks, after a tickless sleep for
+     instance, without a call to ES_Timer_Tick_Resp for every one of them
+****************************************************************************/
+uint32_t ES_Timer_SkipTicks(uint32_t NumTicks)
+{
+  uint32_t  Soonest = ES_Timer_GetTicksToNextTimeout();
+#ifndef TIMER_WHEEL_SIZE
+  uint16_t  GroupsRemaining;
+  uint16_t  Remaining;
+  uint8_t   Group;
+  uint8_t   TimerNum;
+#endif
+
+  if ((Soonest != 0) && (NumTicks >= Soonest))
+  {
+    NumTicks = Soonest - 1;
+  }
+  if (NumTicks == 0)
+  {
+    return 0;
+  }
+#ifdef TIMER_WHEEL_SIZE
+  // nothing is filed under the slots passed over, so only the hand moves
+  EnterCritical();
+  WheelNow += NumTicks;
+  ExitCritical();
+#else
+  GroupsRemaining = ActiveGroups();
+  while (GroupsRemaining != 0)
+  {
+    Group = TimerMSBit(GroupsRemaining);
+    Remaining = ActiveInGroup(Group);
+    while (Remaining != 0)
+    {
+      TimerNum = (Group << 4) + TimerMSBit(Remaining);
+      TMR_TimerArray[TimerNum] -= NumTicks;
+      Remaining &= BitNum2ClrMask[TimerNum & 0x0F];
+    }
+    GroupsRemaining &= BitNum2ClrMask[Group];
+  }
+#endif
+  return NumTicks;
+}
+
 /****************************************************************************
  Function
      ES_Timer_Tick_Resp
@@ -286,39 +765,224 @@ uint16_t ES_Timer_GetTime(void)
      prevent further counting.
  Notes
      Called from _Timer_Int_Resp in ES_Port.c.
+     With the timing wheel only the timers filed under this tick's slot are
+     looked at, and only those due now are taken off it.
  Author
      J. Edward Carryer, 02/24/97 15:06
 ****************************************************************************/
+#ifdef TIMER_WHEEL_SIZE
+void ES_Timer_Tick_Resp(void)
+{
+  static uint8_t    NextTimer2Process;
+  static uint8_t    Following;
+
+  WheelNow++;
+  NextTimer2Process = WheelSlots[WheelNow & WHEEL_MASK];
+  while (NextTimer2Process != NO_TIMER)
+  {
+    // the post may restart this timer, so step past it first
+    Following = TMR_Next[NextTimer2Process];
+    if (TMR_Expiry[NextTimer2Process] == WheelNow)
+    {
+      UnlinkTimer(NextTimer2Process);
+      if (TMR_Period[NextTimer2Process] != 0)
+      { // periodic, file it a period on from this expiry to hold the phase
+        TMR_Expiry[NextTimer2Process] += TMR_Period[NextTimer2Process];
+        LinkTimer(NextTimer2Process);
+      }
+      else
+      {
+        ClearActive(NextTimer2Process);
+        TMR_TimerArray[NextTimer2Process] = 0;
+      }
+      PostTimeout(NextTimer2Process);
+    }
+    NextTimer2Process = Following;
+  }
+}
+#else
 void ES_Timer_Tick_Resp(void)
 {
-  static Tflag_t  NeedsProcessing;
+  static uint16_t GroupsToProcess;
+  static uint16_t NeedsProcessing;
+  static uint8_t  Group;
   static uint8_t  NextTimer2Process;
-  static ES_Event_t NewEvent;
 
-  if (TMR_ActiveFlags != 0) /* if !=0 , then at least 1 timer is active */
+  // start by getting a list of the groups with an active timer
+  GroupsToProcess = ActiveGroups();
+  while (GroupsToProcess != 0) /* if !=0 , then at least 1 timer is active */
   {
-    // start by getting a list of all the active timers
-    NeedsProcessing = TMR_ActiveFlags;
+    Group = TimerMSBit(GroupsToProcess);
+    // then a list of all the active timers in that group
+    NeedsProcessing = ActiveInGroup(Group);
     do
     {
       // find the MSB that is set
-      NextTimer2Process = ES_GetMSBitSet(NeedsProcessing);
+      NextTimer2Process = (Group << 4) + TimerMSBit(NeedsProcessing);
       /* decrement that timer, check if timed out */
       if (--TMR_TimerArray[NextTimer2Process] == 0)
       {
-        NewEvent.EventType  = ES_TIMEOUT;
-        NewEvent.EventParam = NextTimer2Process;
-        /* post the timeout event to the right Service */
-        Timer2PostFunc[NextTimer2Process](NewEvent);
-        /* and stop counting */
-        TMR_ActiveFlags &= BitNum2ClrMask[NextTimer2Process];
+        if (TMR_Period[NextTimer2Process] != 0)
+        { // periodic, reload on the tick it expired to hold the phase
+          TMR_TimerArray[NextTimer2Process] = TMR_Period[NextTimer2Process];
+          PostTimeout(NextTimer2Process);
+        }
+        else
+        {
+          /* post the timeout event to the right Service */
+          PostTimeout(NextTimer2Process);
+          /* and stop counting */
+          ClearActive(NextTimer2Process);
+        }
       }
       // mark off the active timer that we just processed
-      NeedsProcessing &= BitNum2ClrMask[NextTimer2Process];
+      NeedsProcessing &= BitNum2ClrMask[NextTimer2Process & 0x0F];
     } while (NeedsProcessing != 0);
+    GroupsToProcess &= BitNum2ClrMask[Group];
+  }
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// posts ES_TIMEOUT to the timer's service, or counts an overrun for a
+// periodic timer whose last timeout has not been taken yet
+static void PostTimeout(uint8_t Num)
+{
+  static ES_Event_t NewEvent;
+  bool Posted = false;
+
+  NewEvent.EventType  = ES_TIMEOUT;
+  NewEvent.EventParam = Num;
+#if NUM_DYNAMIC_TIMERS > 0
+  if (IsDynamic(Num))
+  {
+    NewEvent.EventParam |= (uint16_t)DynamicGen[Num - MAX_NUM_TIMERS] << 8;
+  }
+#endif
+#ifdef ES_TRACE
+  ES_TraceRecord(ES_TRACE_TIMEOUT, ES_TRACE_NO_SERVICE, NewEvent);
+#endif
+  if ((TMR_Period[Num] == 0) || !TMR_TimeoutQueued[Num])
+  {
+#if NUM_DYNAMIC_TIMERS > 0
+    if (IsDynamic(Num))
+    {
+      Posted = ES_PostToService(DynamicOwner[Num - MAX_NUM_TIMERS], NewEvent);
+    }
+    else
+#endif
+    {
+      Posted = PostFuncFor(Num)(NewEvent);
+    }
+  }
+  if (TMR_Period[Num] != 0)
+  {
+    if (Posted)
+    {
+      TMR_TimeoutQueued[Num] = true;
+    }
+    else if (TMR_Overruns[Num] < UINT16_MAX)
+    { // still queued from last time, or the queue was full
+      TMR_Overruns[Num]++;
+    }
+  }
+}
+
+// true if a timeout from timer Num has somewhere to go
+static bool HasService(uint8_t Num)
+{
+#if NUM_DYNAMIC_TIMERS > 0
+  if (IsDynamic(Num))
+  {
+    return DynamicOwner[Num - MAX_NUM_TIMERS] != NO_OWNER;
+  }
+#endif
+  return PostFuncFor(Num) != TIMER_UNUSED;
+}
+
+/*
+   StartCounting and StopCounting are the only places the API touches a
+   timer's running state. The scan only needs the active flag; the wheel
+   files the timer under its expiry slot, turning the time left into an
+   expiry tick and back.
+*/
+#ifdef TIMER_WHEEL_SIZE
+static void StartCounting(uint8_t Num)
+{
+  EnterCritical();
+  if (!IsActive(Num))
+  {
+    TMR_Expiry[Num] = WheelNow + TMR_TimerArray[Num];
+    LinkTimer(Num);
+    SetActive(Num);
   }
+  ExitCritical();
 }
 
+static void StopCounting(uint8_t Num)
+{
+  EnterCritical();
+  if (IsActive(Num))
+  {
+    TMR_TimerArray[Num] = TMR_Expiry[Num] - WheelNow;
+    UnlinkTimer(Num);
+    ClearActive(Num);
+  }
+  ExitCritical();
+}
+
+// adds Num to the front of the list for the slot its expiry maps to
+static void LinkTimer(uint8_t Num)
+{
+  uint8_t *pHead = &WheelSlots[TMR_Expiry[Num] & WHEEL_MASK];
+
+  TMR_Prev[Num] = NO_TIMER;
+  TMR_Next[Num] = *pHead;
+  if (*pHead != NO_TIMER)
+  {
+    TMR_Prev[*pHead] = Num;
+  }
+  *pHead = Num;
+}
+
+static void UnlinkTimer(uint8_t Num)
+{
+  if (TMR_Prev[Num] == NO_TIMER)
+  {
+    WheelSlots[TMR_Expiry[Num] & WHEEL_MASK] = TMR_Next[Num];
+  }
+  else
+  {
+    TMR_Next[TMR_Prev[Num]] = TMR_Next[Num];
+  }
+  if (TMR_Next[Num] != NO_TIMER)
+  {
+    TMR_Prev[TMR_Next[Num]] = TMR_Prev[Num];
+  }
+}
+#else
+static void StartCounting(uint8_t Num)
+{
+  SetActive(Num);
+}
+
+static void StopCounting(uint8_t Num)
+{
+  ClearActive(Num);
+}
+#endif
+
 /*------------------------------- Footnotes -------------------------------*/
+/*
+   The timing wheel. A timer that expires on tick E is filed in slot
+   E & (TIMER_WHEEL_SIZE - 1), so each tick only has to look at one slot.
+   A timer further out than one turn of the wheel shares its slot with ones
+   due sooner and is passed over, once per turn, until its tick comes round.
+   The work per tick is about (active timers / TIMER_WHEEL_SIZE) rather than
+   (active timers), and starting or stopping a timer is a handful of stores.
+   The wheel costs one byte per slot plus four bytes per timer.
+*/
 /*------------------------------ End of file ------------------------------*/
 
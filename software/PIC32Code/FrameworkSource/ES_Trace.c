@@ -0,0 +1,159 @@
+/****************************************************************************
+ Module
+     ES_Trace.c
+ Description
+     The flight recorder: ES_Run, the posts and the timers write a record
+     of everything they do into a RAM ring of ES_TRACE_SIZE records, which
+     ES_TraceDump streams out over the terminal on request
+ Notes
+     a record is claimed with an atomic add on the free running record
+     count, so posts from ISRs are recorded without turning interrupts off.
+     An ISR that lands between the clock read and the claim leaves two
+     records a few counts out of order, the decoder allows for that.
+     Only built with ES_TRACE defined, the wire format is in ES_Trace.h.
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Trace.h"
+#include "../FrameworkHeaders/ES_Port.h"
+#include "../FrameworkHeaders/terminal.h"
+
+#ifdef ES_TRACE
+/*----------------------------- Module Defines ----------------------------*/
+#if (ES_TRACE_SIZE & (ES_TRACE_SIZE - 1)) != 0
+#error ES_TRACE_SIZE must be a power of 2
+#endif
+#if ES_TRACE_SIZE > 32768
+#error ES_TRACE_SIZE must be no more than 32768
+#endif
+#if NUM_SERVICES > ES_TRACE_NO_SERVICE
+#error the trace records have room for only 63 services
+#endif
+
+// records sent between drains of the terminal's transmit buffer, which
+// overwrites its oldest bytes when it is full
+#define RECORDS_PER_CHUNK ((XMIT_BUFFER_SIZE / 2) / ES_TRACE_RECORD_SIZE)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void DrainTerminal(void);
+static void SendWord(uint32_t Word, uint8_t NumBytes);
+
+/*---------------------------- Module Variables ---------------------------*/
+static ES_TraceRecord_t Records[ES_TRACE_SIZE];
+static uint32_t         NumRecorded;  // free running, the slot is masked
+static volatile bool    Paused;       // while a dump reads the ring
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_TraceRecord
+ Parameters
+   ES_TraceKind_t Kind : what happened
+   uint8_t WhichService : to which service, ES_TRACE_NO_SERVICE if none
+   ES_Event_t ThisEvent : the event involved
+ Returns
+   None
+ Description
+   adds a time stamped record to the ring, over the oldest once it is full
+ Notes
+   safe to call from an ISR, never masks interrupts. Does nothing while
+   ES_TraceDump runs.
+****************************************************************************/
+void ES_TraceRecord(ES_TraceKind_t Kind, uint8_t WhichService,
+    ES_Event_t ThisEvent)
+{
+  uint32_t          Now;
+  ES_TraceRecord_t  *pRecord;
+
+  if (Paused)
+  {
+    return;
+  }
+  Now = _HW_GetCycleCount();
+  pRecord = &Records[__atomic_fetch_add(&NumRecorded, 1, __ATOMIC_RELAXED) &
+      (ES_TRACE_SIZE - 1)];
+  pRecord->Time         = Now;
+  pRecord->EventParam   = ThisEvent.EventParam;
+  pRecord->EventType    = (uint8_t)ThisEvent.EventType;
+  pRecord->KindService  = (uint8_t)((Kind << 6) |
+      (WhichService & ES_TRACE_NO_SERVICE));
+}
+
+/****************************************************************************
+ Function
+   ES_TraceDump
+ Parameters
+   None
+ Returns
+   None
+ Description
+   sends the header and every record in the ring, oldest first, over the
+   terminal. Recording stops for the dump and then carries on.
+ Notes
+   waits for the UART as it goes, about 0.4s at 115200 baud for 512
+   records, so nothing else runs until it is done
+****************************************************************************/
+void ES_TraceDump(void)
+{
+  uint32_t                Last;
+  uint32_t                Which;
+  uint16_t                Count;
+  const ES_TraceRecord_t  *pRecord;
+
+  Paused = true;
+  Last = __atomic_load_n(&NumRecorded, __ATOMIC_RELAXED);
+  Count = (Last < ES_TRACE_SIZE) ? (uint16_t)Last : ES_TRACE_SIZE;
+
+  DrainTerminal(); // anything printed before the dump goes first
+  Terminal_WriteByte('E');
+  Terminal_WriteByte('S');
+  Terminal_WriteByte('T');
+  Terminal_WriteByte('R');
+  Terminal_WriteByte(ES_TRACE_VERSION);
+  Terminal_WriteByte(ES_TRACE_RECORD_SIZE);
+  SendWord(Count, 2);
+  SendWord(ES_PROFILE_COUNTS_PER_US, 2);
+  for (Which = Last - Count; Which != Last; Which++)
+  {
+    if (((Which - (Last - Count)) % RECORDS_PER_CHUNK) == 0)
+    {
+      DrainTerminal();
+    }
+    pRecord = &Records[Which & (ES_TRACE_SIZE - 1)];
+    SendWord(pRecord->Time, 4);
+    SendWord(pRecord->EventParam, 2);
+    Terminal_WriteByte(pRecord->EventType);
+    Terminal_WriteByte(pRecord->KindService);
+  }
+  DrainTerminal();
+  Paused = false;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// waits until the UART has taken everything in the transmit buffer. A big
+// dump takes far longer than the watchdog period, so keep clearing it.
+static void DrainTerminal(void)
+{
+  do
+  {
+#ifdef ES_BUDGET_WATCHDOG
+    _HW_WatchdogClear();
+#endif
+    Terminal_MoveBuffer2UART();
+  } while (Terminal_IsTxPending());
+}
+
+// the low NumBytes of Word, least significant first
+static void SendWord(uint32_t Word, uint8_t NumBytes)
+{
+  while (NumBytes-- > 0)
+  {
+    Terminal_WriteByte((uint8_t)Word);
+    Word >>= 8;
+  }
+}
+#endif /* ES_TRACE */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -187,6 +187,19 @@ void Terminal_MoveBuffer2UART( void )
   }
 }
 
+/*******************************************************************************
+ * Function: Terminal_IsTxPending
+ * Arguments: none
+ * Returns true if the circular buffer still holds bytes for the UART
+ * 
+ * Description: lets the idle code know that Terminal_MoveBuffer2UART needs to
+ *              keep being called, so this is no time to sleep
+ ******************************************************************************/
+bool Terminal_IsTxPending(void)
+{
+  return !circular_buf_empty(xmitBufferHandle);
+}
+
 void __attribute__((noreturn)) _fassert(int nLineNumber,
                                         const char * sFileName,
                                         const char * sFailedExpression,
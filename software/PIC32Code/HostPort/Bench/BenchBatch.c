@@ -0,0 +1,143 @@
+/****************************************************************************
+ Module
+     BenchBatch.c
+ Description
+     Events per second through the real ES_Run, one event per RunFunc call
+     against a whole queue per batch RunFunc call.
+ Notes
+     Built against BenchBatchConfigure.h. An event checker posts bursts of
+     EV_BENCH to one of the two sink services whenever the queues are empty;
+     for each burst size it times BENCH_EVENTS events to the plain sink and
+     then the same number to the batch sink. The host port runs free so the
+     tick handler does not read the wall clock on every dispatch.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_HostPort.h"
+
+#include "BenchTimer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define BENCH_EVENTS 4000000UL
+
+/*---------------------------- Module Functions ---------------------------*/
+static void NextPhase(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint8_t BurstSizes[] = { 1, 2, 4, 8, 16, 32 };
+
+static uint8_t  PlainPriority;
+static uint8_t  BatchPriority;
+static uint32_t EventsRun;
+static uint32_t BatchCalls;
+
+// phase 2n is burst size n to the plain sink, 2n+1 the same to the batch sink
+static uint8_t  Phase;
+static uint32_t EventsPosted;
+static uint64_t PhaseStart;
+static double   PlainRate;
+
+/*------------------------------ Module Code ------------------------------*/
+bool InitPlainSink(uint8_t Priority)
+{
+  PlainPriority = Priority;
+  return true;
+}
+
+ES_Event_t RunPlainSink(ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent = { ES_NO_EVENT, 0 };
+  EventsRun += (ThisEvent.EventType == EV_BENCH);
+  return ReturnEvent;
+}
+
+bool InitBatchSink(uint8_t Priority)
+{
+  BatchPriority = Priority;
+  return true;
+}
+
+ES_Event_t RunBatchSink(ES_Event_t ThisEvent)
+{
+  return RunPlainSink(ThisEvent);
+}
+
+ES_Event_t RunBatchSinkBatch(const ES_Event_t *pEvents, uint8_t NumEvents)
+{
+  ES_Event_t ReturnEvent = { ES_NO_EVENT, 0 };
+  uint8_t i;
+
+  for (i = 0; i < NumEvents; i++)
+  {
+    EventsRun += (pEvents[i].EventType == EV_BENCH);
+  }
+  BatchCalls++;
+  return ReturnEvent;
+}
+
+bool BenchProducer(void)
+{
+  ES_Event_t  NewEvent = { EV_BENCH, 0 };
+  uint8_t     Target = (Phase & 1) ? BatchPriority : PlainPriority;
+  uint8_t     i;
+
+  if (EventsPosted >= BENCH_EVENTS)
+  {
+    NextPhase();
+    Target = (Phase & 1) ? BatchPriority : PlainPriority;
+  }
+  for (i = 0; i < BurstSizes[Phase >> 1]; i++)
+  {
+    NewEvent.EventParam = i;
+    ES_PostToService(Target, NewEvent);
+  }
+  EventsPosted += BurstSizes[Phase >> 1];
+  return true;
+}
+
+int main(void)
+{
+  _HW_HostSetMode(HostFreeRun);
+  _HW_PIC32Init();
+  if (ES_Initialize(ES_Timer_RATE_1mS) != Success)
+  {
+    puts("framework failed to initialize");
+    return EXIT_FAILURE;
+  }
+  printf("%6s %14s %14s %8s\n", "burst", "plain ev/s", "batch ev/s", "ratio");
+  PhaseStart = Bench_Nanos();
+  ES_Run();
+  puts("ES_Run returned");
+  return EXIT_FAILURE;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static void NextPhase(void)
+{
+  double Rate = (double)EventsRun * 1e9 / (double)(Bench_Nanos() - PhaseStart);
+
+  if ((Phase & 1) == 0)
+  {
+    PlainRate = Rate;
+  }
+  else
+  {
+    printf("%6u %14.0f %14.0f %8.2f\n", BurstSizes[Phase >> 1], PlainRate, Rate,
+        Rate / PlainRate);
+  }
+  if (++Phase >= 2 * ARRAY_SIZE(BurstSizes))
+  {
+    printf("batch calls in the last phase: %u\n", (unsigned)BatchCalls);
+    exit(EXIT_SUCCESS);
+  }
+  EventsRun     = 0;
+  EventsPosted  = 0;
+  BatchCalls    = 0;
+  PhaseStart    = Bench_Nanos();
+}
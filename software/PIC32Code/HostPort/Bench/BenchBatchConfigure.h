@@ -0,0 +1,80 @@
+/****************************************************************************
+ Module
+     BenchBatchConfigure.h
+ Description
+     ES_Configure.h stand-in for BenchBatch. The Makefile forces this in
+     ahead of every framework source, and because it claims the
+     ES_CONFIGURE_H guard the project's own configuration is never seen.
+ Notes
+     two services with the same work to do, one taking its events one at a
+     time and one taking them a queue at a time
+*****************************************************************************/
+#ifndef ES_CONFIGURE_H
+#define ES_CONFIGURE_H
+
+#define BENCH_QUEUE_SIZE 32
+
+#define MAX_NUM_SERVICES 16
+#define NUM_SERVICES 2
+
+#define BATCH_RUN_MAX_EVENTS BENCH_QUEUE_SIZE
+
+#define SERV_0_HEADER "BenchBatchConfigure.h"
+#define SERV_0_INIT InitPlainSink
+#define SERV_0_RUN RunPlainSink
+#define SERV_0_QUEUE_SIZE BENCH_QUEUE_SIZE
+
+#define SERV_1_HEADER "BenchBatchConfigure.h"
+#define SERV_1_INIT InitBatchSink
+#define SERV_1_RUN RunBatchSink
+#define SERV_1_BATCH_RUN RunBatchSinkBatch
+#define SERV_1_QUEUE_SIZE BENCH_QUEUE_SIZE
+
+typedef enum
+{
+  ES_NO_EVENT = 0,
+  ES_ERROR,
+  ES_INIT,
+  ES_TIMEOUT,
+  ES_SHORT_TIMEOUT,
+  ES_NEW_KEY,
+  EV_BENCH
+}ES_EventType_t;
+
+#define NUM_DIST_LISTS 0
+
+#include <stdbool.h>
+bool BenchProducer(void);
+#define EVENT_CHECK_LIST BenchProducer
+
+#define MAX_NUM_TIMERS 16
+#define TIMER_UNUSED ((pPostFunc)0)
+#define TIMER0_RESP_FUNC TIMER_UNUSED
+#define TIMER1_RESP_FUNC TIMER_UNUSED
+#define TIMER2_RESP_FUNC TIMER_UNUSED
+#define TIMER3_RESP_FUNC TIMER_UNUSED
+#define TIMER4_RESP_FUNC TIMER_UNUSED
+#define TIMER5_RESP_FUNC TIMER_UNUSED
+#define TIMER6_RESP_FUNC TIMER_UNUSED
+#define TIMER7_RESP_FUNC TIMER_UNUSED
+#define TIMER8_RESP_FUNC TIMER_UNUSED
+#define TIMER9_RESP_FUNC TIMER_UNUSED
+#define TIMER10_RESP_FUNC TIMER_UNUSED
+#define TIMER11_RESP_FUNC TIMER_UNUSED
+#define TIMER12_RESP_FUNC TIMER_UNUSED
+#define TIMER13_RESP_FUNC TIMER_UNUSED
+#define TIMER14_RESP_FUNC TIMER_UNUSED
+#define TIMER15_RESP_FUNC TIMER_UNUSED
+
+#endif /* ES_CONFIGURE_H */
+
+// the bench services, outside the guard so SERV_n_HEADER can pull them in
+// once ES_Events.h has defined ES_Event_t
+#if defined(ES_Events_H) && !defined(BENCH_BATCH_SERVICES_H)
+#define BENCH_BATCH_SERVICES_H
+bool InitPlainSink(uint8_t Priority);
+ES_Event_t RunPlainSink(ES_Event_t ThisEvent);
+bool InitBatchSink(uint8_t Priority);
+ES_Event_t RunBatchSink(ES_Event_t ThisEvent);
+ES_Event_t RunBatchSinkBatch(const ES_Event_t *pEvents, uint8_t NumEvents);
+#endif
@@ -0,0 +1,241 @@
+/****************************************************************************
+ Module
+     BenchDeadline.c
+ Description
+     Worst case queueing delay per service through the real ES_Run. Built
+     twice, as BenchDeadlineFP (the default fixed priority dispatch) and as
+     BenchDeadlineEDF (EDF_DISPATCH defined), so the two can be compared.
+ Notes
+     The bench is its own port: time is a simulated microsecond clock with a
+     1 ms tick, a service's run function moves the clock on by the time its
+     event takes, and the tick 'interrupt' posts the events whose arrival
+     time has come. Arrival times and run times are jittered from a fixed
+     seed, so both builds see exactly the same load. The delay of an event
+     is from its post to the call of its run function. The run fails if an
+     event is lost.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define US_PER_TICK 1000
+#define RUN_TIME_US 60000000ULL   // a simulated minute
+#define MAX_WAITING 64
+
+/*------------------------------ Module Types -----------------------------*/
+typedef struct
+{
+  const char *Name;
+  uint32_t    Period;       // mean time between bursts, us
+  uint8_t     Burst;        // events per burst
+  uint32_t    Cost;         // mean run time per event, us
+  uint32_t    Deadline;     // SERV_n_DEADLINE, in ticks
+}Source_t;
+
+typedef struct
+{
+  uint64_t NextArrival;
+  uint64_t Waiting[MAX_WAITING];  // post times of the events still queued
+  uint8_t  Head;
+  uint8_t  NumWaiting;
+  uint32_t Served;
+  uint64_t TotalDelay;
+  uint64_t WorstDelay;
+  uint32_t Missed;
+  uint32_t ArrivalSeed;           // each source draws from its own two
+  uint32_t CostSeed;              // sequences, whatever order things run in
+}SourceState_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint32_t Jitter(uint32_t *pSeed, uint32_t Mean);
+static void Report(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+// service 0 is the lowest priority
+static const Source_t Sources[NUM_SERVICES] =
+{
+  { "usb",      50000, 1, 4000, SERV_0_DEADLINE },
+  { "sensor",    5000, 1, 2500, SERV_1_DEADLINE },
+  { "display",  10000, 3, 1000, SERV_2_DEADLINE },
+  { "pump",     20000, 1,  300, SERV_3_DEADLINE }
+};
+
+static SourceState_t  State[NUM_SERVICES];
+static uint64_t       Clock;  // us
+static uint64_t       BusyTime;
+
+/*------------------------------ Module Code ------------------------------*/
+bool InitBenchSink(uint8_t Priority)
+{
+  State[Priority].ArrivalSeed = 12345 + Priority;
+  State[Priority].CostSeed    = 54321 + Priority;
+  State[Priority].NextArrival = Jitter(&State[Priority].ArrivalSeed,
+      Sources[Priority].Period);
+  return true;
+}
+
+ES_Event_t RunBenchSink(ES_Event_t ThisEvent)
+{
+  ES_Event_t      ReturnEvent = { ES_NO_EVENT, 0 };
+  uint8_t         Which = (uint8_t)ThisEvent.EventParam;
+  SourceState_t  *pState = &State[Which];
+  uint64_t        Delay;
+  uint32_t        Cost;
+
+  if (pState->NumWaiting == 0)
+  {
+    printf("%s ran an event it was never sent\n", Sources[Which].Name);
+    exit(EXIT_FAILURE);
+  }
+  Delay = Clock - pState->Waiting[pState->Head];
+  pState->Head = (pState->Head + 1) % MAX_WAITING;
+  pState->NumWaiting--;
+  pState->Served++;
+  pState->TotalDelay += Delay;
+  if (Delay > pState->WorstDelay)
+  {
+    pState->WorstDelay = Delay;
+  }
+  if (Delay > (uint64_t)Sources[Which].Deadline * US_PER_TICK)
+  {
+    pState->Missed++;
+  }
+  Cost = Jitter(&pState->CostSeed, Sources[Which].Cost);
+  Clock     += Cost;
+  BusyTime  += Cost;
+  return ReturnEvent;
+}
+
+bool BenchNoEvents(void)
+{
+  return false;
+}
+
+// the port, just enough of it for ES_Run
+void _HW_Timer_Init(const TimerRate_t Rate)
+{
+}
+
+uint16_t _HW_GetTickCount(void)
+{
+  return (uint16_t)(Clock / US_PER_TICK);
+}
+
+uint64_t _HW_GetTickCount64(void)
+{
+  return Clock / US_PER_TICK;
+}
+
+unsigned int _HW_HostDisableInts(void)
+{
+  return 0;
+}
+
+unsigned int _HW_HostEnableInts(void)
+{
+  return 0;
+}
+
+// posts every event whose arrival time has come, there are no timers
+bool _HW_Process_Pending_Ints(void)
+{
+  ES_Event_t      NewEvent = { EV_BENCH, 0 };
+  SourceState_t  *pState;
+  uint8_t         Which;
+  uint8_t         i;
+
+  if (Clock >= RUN_TIME_US)
+  {
+    Report();
+    exit(EXIT_SUCCESS);
+  }
+  for (Which = 0; Which < NUM_SERVICES; Which++)
+  {
+    pState = &State[Which];
+    while (pState->NextArrival <= Clock)
+    {
+      for (i = 0; i < Sources[Which].Burst; i++)
+      {
+        NewEvent.EventParam = Which;
+        if ((pState->NumWaiting == MAX_WAITING) ||
+            !ES_PostToService(Which, NewEvent))
+        {
+          printf("%s lost an event, its queue was full\n", Sources[Which].Name);
+          exit(EXIT_FAILURE);
+        }
+        pState->Waiting[(pState->Head + pState->NumWaiting) % MAX_WAITING] =
+            pState->NextArrival;
+        pState->NumWaiting++;
+      }
+      pState->NextArrival += Jitter(&pState->ArrivalSeed,
+          Sources[Which].Period);
+    }
+  }
+  return true;
+}
+
+// nothing queued, so skip to the next arrival
+void _HW_Idle(void)
+{
+  uint64_t  Next = State[0].NextArrival;
+  uint8_t   Which;
+
+  for (Which = 1; Which < NUM_SERVICES; Which++)
+  {
+    if (State[Which].NextArrival < Next)
+    {
+      Next = State[Which].NextArrival;
+    }
+  }
+  Clock = Next;
+}
+
+int main(void)
+{
+  if (ES_Initialize(ES_Timer_RATE_1mS) != Success)
+  {
+    puts("framework failed to initialize");
+    return EXIT_FAILURE;
+  }
+  ES_Run();
+  puts("ES_Run returned");
+  return EXIT_FAILURE;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// uniform from half to one and a half times Mean
+static uint32_t Jitter(uint32_t *pSeed, uint32_t Mean)
+{
+  *pSeed = *pSeed * 1103515245UL + 12345UL;
+  return Mean / 2 + (uint32_t)(((uint64_t)((*pSeed >> 8) & 0xFFFFFF) * Mean)
+         >> 24);
+}
+
+static void Report(void)
+{
+  uint8_t Which;
+
+#ifdef EDF_DISPATCH
+  puts("earliest deadline first");
+#else
+  puts("fixed priority");
+#endif
+  printf("%4s %-8s %8s %10s %10s %8s %8s\n", "serv", "name", "deadline",
+      "worst ms", "mean ms", "events", "missed");
+  for (Which = 0; Which < NUM_SERVICES; Which++)
+  {
+    printf("%4u %-8s %8u %10.2f %10.2f %8u %8u\n", (unsigned)Which,
+        Sources[Which].Name, (unsigned)Sources[Which].Deadline,
+        State[Which].WorstDelay / 1000.0,
+        State[Which].Served ?
+        (double)State[Which].TotalDelay / State[Which].Served / 1000.0 : 0.0,
+        (unsigned)State[Which].Served, (unsigned)State[Which].Missed);
+  }
+  printf("busy %.1f%% of the time\n", 100.0 * BusyTime / Clock);
+}
@@ -0,0 +1,11 @@
+/****************************************************************************
+ Module
+     BenchDeadlineEDFConfigure.h
+ Description
+     ES_Configure.h stand-in for BenchDeadlineEDF, the same set up as
+     BenchDeadlineFPConfigure.h with earliest deadline first dispatch
+ Notes
+*****************************************************************************/
+#define EDF_DISPATCH
+
+#include "BenchDeadlineFPConfigure.h"
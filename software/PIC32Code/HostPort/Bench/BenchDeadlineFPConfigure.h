@@ -0,0 +1,93 @@
+/****************************************************************************
+ Module
+     BenchDeadlineFPConfigure.h
+ Description
+     ES_Configure.h stand-in for BenchDeadlineFP, the dispatch latency bench
+     with the default fixed priority dispatch. BenchDeadlineEDFConfigure.h
+     turns on EDF_DISPATCH on top of this.
+ Notes
+     four services with the same init and run functions, modelled loosely on
+     the SmartPot's USB, sensor, display and pump services. The deadlines are
+     in ticks and only matter with EDF_DISPATCH.
+*****************************************************************************/
+#ifndef ES_CONFIGURE_H
+#define ES_CONFIGURE_H
+
+#define BENCH_QUEUE_SIZE 32
+
+#define MAX_NUM_SERVICES 16
+#define NUM_SERVICES 4
+
+#define BATCH_RUN_MAX_EVENTS 1
+#define EDF_DEFAULT_DEADLINE 1000
+#define EDF_STAMP_DEPTH BENCH_QUEUE_SIZE
+
+#define SERV_0_HEADER "BenchDeadlineFPConfigure.h"
+#define SERV_0_INIT InitBenchSink
+#define SERV_0_RUN RunBenchSink
+#define SERV_0_QUEUE_SIZE BENCH_QUEUE_SIZE
+#define SERV_0_DEADLINE 50
+
+#define SERV_1_HEADER "BenchDeadlineFPConfigure.h"
+#define SERV_1_INIT InitBenchSink
+#define SERV_1_RUN RunBenchSink
+#define SERV_1_QUEUE_SIZE BENCH_QUEUE_SIZE
+#define SERV_1_DEADLINE 20
+
+#define SERV_2_HEADER "BenchDeadlineFPConfigure.h"
+#define SERV_2_INIT InitBenchSink
+#define SERV_2_RUN RunBenchSink
+#define SERV_2_QUEUE_SIZE BENCH_QUEUE_SIZE
+#define SERV_2_DEADLINE 20
+
+#define SERV_3_HEADER "BenchDeadlineFPConfigure.h"
+#define SERV_3_INIT InitBenchSink
+#define SERV_3_RUN RunBenchSink
+#define SERV_3_QUEUE_SIZE BENCH_QUEUE_SIZE
+#define SERV_3_DEADLINE 5
+
+typedef enum
+{
+  ES_NO_EVENT = 0,
+  ES_ERROR,
+  ES_INIT,
+  ES_TIMEOUT,
+  ES_SHORT_TIMEOUT,
+  ES_NEW_KEY,
+  EV_BENCH
+}ES_EventType_t;
+
+#define NUM_DIST_LISTS 0
+
+#include <stdbool.h>
+bool BenchNoEvents(void);
+#define EVENT_CHECK_LIST BenchNoEvents
+
+#define MAX_NUM_TIMERS 16
+#define TIMER_UNUSED ((pPostFunc)0)
+#define TIMER0_RESP_FUNC TIMER_UNUSED
+#define TIMER1_RESP_FUNC TIMER_UNUSED
+#define TIMER2_RESP_FUNC TIMER_UNUSED
+#define TIMER3_RESP_FUNC TIMER_UNUSED
+#define TIMER4_RESP_FUNC TIMER_UNUSED
+#define TIMER5_RESP_FUNC TIMER_UNUSED
+#define TIMER6_RESP_FUNC TIMER_UNUSED
+#define TIMER7_RESP_FUNC TIMER_UNUSED
+#define TIMER8_RESP_FUNC TIMER_UNUSED
+#define TIMER9_RESP_FUNC TIMER_UNUSED
+#define TIMER10_RESP_FUNC TIMER_UNUSED
+#define TIMER11_RESP_FUNC TIMER_UNUSED
+#define TIMER12_RESP_FUNC TIMER_UNUSED
+#define TIMER13_RESP_FUNC TIMER_UNUSED
+#define TIMER14_RESP_FUNC TIMER_UNUSED
+#define TIMER15_RESP_FUNC TIMER_UNUSED
+
+#endif /* ES_CONFIGURE_H */
+
+// the bench service, outside the guard so SERV_n_HEADER can pull it in once
+// ES_Events.h has defined ES_Event_t
+#if defined(ES_Events_H) && !defined(BENCH_DEADLINE_SERVICES_H)
+#define BENCH_DEADLINE_SERVICES_H
+bool InitBenchSink(uint8_t Priority);
+ES_Event_t RunBenchSink(ES_Event_t ThisEvent);
+#endif
@@ -0,0 +1,134 @@
+/****************************************************************************
+ Module
+     BenchQueue.c
+ Description
+     Cost of a post and a take on an ES_Queue (% indexed, header in the
+     first event) against an ES_RingQueue (mask indexed) of the same
+     capacity. Each round fills the queue to capacity and drains it again,
+     so every index wraps at least once.
+ Notes
+     EnterCritical/ExitCritical are stubbed out here; on the PIC32 they are
+     one instruction each, the same for both queues.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_Queue.h"
+#include "ES_RingQueue.h"
+
+#include "BenchTimer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define BENCH_EVENTS 20000000UL
+#define MAX_CAPACITY 128
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint16_t Capacities[] = { 4, 8, 32, 128 };
+
+// one extra event for the ES_Queue header
+static ES_Event_t Block[MAX_CAPACITY + 1];
+ES_RING_QUEUE(Ring, MAX_CAPACITY);
+
+/*------------------------------ Module Code ------------------------------*/
+// the bench does not link the host port
+unsigned int _HW_HostDisableInts(void)
+{
+  return 0;
+}
+
+unsigned int _HW_HostEnableInts(void)
+{
+  return 0;
+}
+
+static uint64_t TimeBlock(uint16_t Capacity, uint32_t *pSum)
+{
+  ES_Event_t  ThisEvent = { ES_NEW_KEY, 0 };
+  uint64_t    Start;
+  uint32_t    Rounds;
+  uint16_t    i;
+
+  ES_InitQueue(Block, (uint8_t)(Capacity + 1));
+  Start = Bench_Cycles();
+  for (Rounds = BENCH_EVENTS / Capacity; Rounds > 0; Rounds--)
+  {
+    for (i = 0; i < Capacity; i++)
+    {
+      ThisEvent.EventParam = i;
+      ES_EnQueueFIFO(Block, ThisEvent);
+    }
+    for (i = 0; i < Capacity; i++)
+    {
+      ES_DeQueue(Block, &ThisEvent);
+      *pSum += ThisEvent.EventParam;
+    }
+    // start the next round one slot on so the wrap point moves around
+    ES_EnQueueFIFO(Block, ThisEvent);
+    ES_DeQueue(Block, &ThisEvent);
+  }
+  return Bench_Cycles() - Start;
+}
+
+static uint64_t TimeRing(uint16_t Capacity, uint32_t *pSum)
+{
+  ES_Event_t  ThisEvent = { ES_NEW_KEY, 0 };
+  uint64_t    Start;
+  uint32_t    Rounds;
+  uint16_t    i;
+
+  ES_RingInit(&Ring);
+  Ring.Mask = Capacity - 1;
+  Start = Bench_Cycles();
+  for (Rounds = BENCH_EVENTS / Capacity; Rounds > 0; Rounds--)
+  {
+    for (i = 0; i < Capacity; i++)
+    {
+      ThisEvent.EventParam = i;
+      ES_RingEnQueueFIFO(&Ring, ThisEvent);
+    }
+    for (i = 0; i < Capacity; i++)
+    {
+      ES_RingDeQueue(&Ring, &ThisEvent);
+      *pSum += ThisEvent.EventParam;
+    }
+    ES_RingEnQueueFIFO(&Ring, ThisEvent);
+    ES_RingDeQueue(&Ring, &ThisEvent);
+  }
+  return Bench_Cycles() - Start;
+}
+
+int main(void)
+{
+  uint32_t  BlockSum;
+  uint32_t  RingSum;
+  uint64_t  BlockCost;
+  uint64_t  RingCost;
+  uint8_t   i;
+
+  printf("%8s %14s %14s %8s\n", "capacity", "es_queue " BENCH_CYCLE_UNIT,
+      "ring " BENCH_CYCLE_UNIT, "ratio");
+  for (i = 0; i < ARRAY_SIZE(Capacities); i++)
+  {
+    // both queues must hand back the same events
+    uint16_t  Capacity = Capacities[i];
+    double    Pairs = (double)(BENCH_EVENTS / Capacity) * (Capacity + 1);
+
+    BlockSum  = 0;
+    RingSum   = 0;
+    BlockCost = TimeBlock(Capacity, &BlockSum);
+    RingCost  = TimeRing(Capacity, &RingSum);
+    if (BlockSum != RingSum)
+    {
+      printf("MISMATCH at capacity %u\n", (unsigned)Capacity);
+      return EXIT_FAILURE;
+    }
+    printf("%8u %14.2f %14.2f %8.2f\n", (unsigned)Capacity,
+        BlockCost / Pairs, RingCost / Pairs, (double)BlockCost / RingCost);
+  }
+  puts("(cost per post + take pair)");
+  Bench_Sink = BlockSum;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/****************************************************************************
+ Module
+     BenchSPSC.c
+ Description
+     Stress test and throughput for the ISR to service queues. A producer
+     thread stands in for the interrupt and a consumer thread for ES_Run.
+       spsc:   ES_SPSCEnQueue / ES_SPSCDeQueue, no locking at all
+       locked: ES_EnQueueFIFO / ES_DeQueue with EnterCritical/ExitCritical
+               mapped onto one mutex, the host equivalent of masking
+               interrupts around every post and every take
+     Each event carries a sequence number in EventParam; the consumer checks
+     that every one arrives once and in order and the bench fails otherwise.
+ Notes
+     The producer waits while the queue is full, so the rate reported is the
+     most the pair can sustain; a real ISR posting faster than that would
+     start losing events.
+     Both sides yield the CPU rather than spin when they can not make
+     progress, so the bench also finishes on a single core host, where the
+     numbers mostly show how many events each time slice gets through.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_Queue.h"
+#include "ES_SPSCQueue.h"
+
+#include "BenchTimer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define BENCH_EVENTS 4000000UL
+#define MAX_RING_SIZE 256
+
+typedef struct
+{
+  const char  *Name;
+  bool        (*Post)(ES_Event_t);
+  bool        (*Take)(ES_Event_t *);
+  void        (*Reset)(uint16_t);
+  uint32_t    Taken;
+  uint32_t    Errors;
+}Run_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool SPSCPost(ES_Event_t ThisEvent);
+static bool SPSCTake(ES_Event_t *pEvent);
+static void SPSCReset(uint16_t Size);
+static bool LockedPost(ES_Event_t ThisEvent);
+static bool LockedTake(ES_Event_t *pEvent);
+static void LockedReset(uint16_t Size);
+static void *Producer(void *pArg);
+static void *Consumer(void *pArg);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint16_t RingSizes[] = { 16, 64, 256 };
+
+static ES_SPSCQueue_t SPSCQueue;
+static ES_Event_t     SPSCSlots[MAX_RING_SIZE];
+
+// ES_Queue caps out at 255 entries plus the header
+static ES_Event_t     LockedBlock[MAX_RING_SIZE];
+static pthread_mutex_t IntLock = PTHREAD_MUTEX_INITIALIZER;
+
+static volatile bool  ProducerDone;
+
+/*------------------------------ Module Code ------------------------------*/
+// the bench does not link the host port, these stand in for its interrupt
+// mask so that EnterCritical/ExitCritical in ES_Queue.c take the mutex
+unsigned int _HW_HostDisableInts(void)
+{
+  pthread_mutex_lock(&IntLock);
+  return 0;
+}
+
+unsigned int _HW_HostEnableInts(void)
+{
+  pthread_mutex_unlock(&IntLock);
+  return 0;
+}
+
+static double Measure(Run_t *pRun, uint16_t Size)
+{
+  pthread_t ProducerThread;
+  pthread_t ConsumerThread;
+  uint64_t  Start;
+
+  pRun->Reset(Size);
+  pRun->Taken   = 0;
+  pRun->Errors  = 0;
+  ProducerDone  = false;
+  Start = Bench_Nanos();
+  pthread_create(&ConsumerThread, NULL, Consumer, pRun);
+  pthread_create(&ProducerThread, NULL, Producer, pRun);
+  pthread_join(ProducerThread, NULL);
+  pthread_join(ConsumerThread, NULL);
+  if (pRun->Taken != BENCH_EVENTS)
+  {
+    pRun->Errors++;
+  }
+  return (double)BENCH_EVENTS * 1e9 / (double)(Bench_Nanos() - Start);
+}
+
+int main(void)
+{
+  Run_t Runs[] = {
+    { "spsc",   SPSCPost,   SPSCTake,   SPSCReset },
+    { "locked", LockedPost, LockedTake, LockedReset },
+  };
+  uint8_t   i;
+  uint8_t   j;
+  uint32_t  Errors = 0;
+
+  printf("%-8s %6s %14s\n", "queue", "size", "posts/s");
+  for (i = 0; i < ARRAY_SIZE(RingSizes); i++)
+  {
+    for (j = 0; j < ARRAY_SIZE(Runs); j++)
+    {
+      // ES_Queue needs a slot for its header
+      uint16_t  Size = RingSizes[i] - (Runs[j].Reset == LockedReset);
+      double    Rate = Measure(&Runs[j], Size);
+
+      Errors += Runs[j].Errors;
+      printf("%-8s %6u %14.0f\n", Runs[j].Name, (unsigned)RingSizes[i], Rate);
+    }
+  }
+  if (Errors != 0)
+  {
+    printf("FAILED: %u events lost or out of order\n", (unsigned)Errors);
+    return EXIT_FAILURE;
+  }
+  puts("all events arrived once and in order");
+  return EXIT_SUCCESS;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static bool SPSCPost(ES_Event_t ThisEvent)
+{
+  return ES_SPSCEnQueue(&SPSCQueue, ThisEvent);
+}
+
+static bool SPSCTake(ES_Event_t *pEvent)
+{
+  return ES_SPSCDeQueue(&SPSCQueue, pEvent);
+}
+
+static void SPSCReset(uint16_t Size)
+{
+  ES_SPSCInit(&SPSCQueue, SPSCSlots, Size);
+}
+
+static bool LockedPost(ES_Event_t ThisEvent)
+{
+  return ES_EnQueueFIFO(LockedBlock, ThisEvent);
+}
+
+static bool LockedTake(ES_Event_t *pEvent)
+{
+  ES_DeQueue(LockedBlock, pEvent);
+  return pEvent->EventType != ES_NO_EVENT;
+}
+
+static void LockedReset(uint16_t Size)
+{
+  ES_InitQueue(LockedBlock, (uint8_t)(Size + 1));
+}
+
+static void *Producer(void *pArg)
+{
+  Run_t       *pRun = pArg;
+  ES_Event_t  NewEvent = { ES_NEW_KEY, 0 };
+  uint32_t    i;
+
+  for (i = 0; i < BENCH_EVENTS; i++)
+  {
+    NewEvent.EventParam = (uint16_t)i;
+    while (!pRun->Post(NewEvent))
+    {
+      sched_yield();
+    }
+  }
+  __atomic_store_n(&ProducerDone, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// every event must be the next in sequence
+static void *Consumer(void *pArg)
+{
+  Run_t       *pRun = pArg;
+  ES_Event_t  ThisEvent;
+  uint16_t    Expected = 0;
+  bool        Done = false;
+
+  for (;;)
+  {
+    if (pRun->Take(&ThisEvent))
+    {
+      if ((ThisEvent.EventType != ES_NEW_KEY) ||
+          (ThisEvent.EventParam != Expected))
+      {
+        pRun->Errors++;
+      }
+      Expected = ThisEvent.EventParam + 1;
+      pRun->Taken++;
+    }
+    else if (Done)
+    {
+      break;
+    }
+    else
+    {
+      // take one more look after seeing Done, the last posts may have
+      // landed after the empty check
+      Done = __atomic_load_n(&ProducerDone, __ATOMIC_ACQUIRE);
+      sched_yield();
+    }
+  }
+  return NULL;
+}
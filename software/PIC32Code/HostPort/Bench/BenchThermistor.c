@@ -0,0 +1,121 @@
+/****************************************************************************
+ Module
+     BenchThermistor.c
+ Description
+     Checks the Thermistor.c lookup table against the beta equation that
+     TemperatureSM used to evaluate on every sample, then times both:
+       table:    Thermistor_CountsToCentiC, integer only
+       equation: the old double precision code with log()
+ Notes
+     Fails if the table is more than 0.1 C from the equation anywhere from
+     -40 C to 100 C. The host has a hardware FPU, so the equation's cost
+     here badly understates the soft float one on the PIC32MK.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "Thermistor.h"
+
+#include "BenchTimer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define ADC_FULL_SCALE 4095
+#define REPS 2000
+#define MAX_ERROR_C 0.1
+#define RATED_LOW_C -40.0
+#define RATED_HIGH_C 100.0
+#define CORE_LOW_C -20.0
+#define CORE_HIGH_C 80.0
+
+/*------------------------------ Module Code ------------------------------*/
+// VoltageToTemperature as it was, in Celsius and without the rounding
+static double Equation(uint16_t Reading)
+{
+  double V_out = (double)Reading / 4095 * 3.3;
+  double R_thermistor = R1 / (3.3 - V_out) * V_out;
+  double T = BETA / (BETA / 298.1 - log(R_25 / R_thermistor)) - 273.1;
+
+  return T - T_CALIBRATE;
+}
+
+static uint64_t TimeTable(void)
+{
+  uint64_t Start = Bench_Cycles();
+  int32_t Sum = 0;
+  uint32_t Rep;
+  uint16_t Counts;
+
+  for (Rep = 0; Rep < REPS; Rep++)
+  {
+    for (Counts = 1; Counts < ADC_FULL_SCALE; Counts++)
+    {
+      Sum += Thermistor_CountsToCentiC(Counts);
+    }
+  }
+  Bench_Sink = (uint32_t)Sum;
+  return Bench_Cycles() - Start;
+}
+
+static uint64_t TimeEquation(void)
+{
+  uint64_t Start = Bench_Cycles();
+  double Sum = 0;
+  uint32_t Rep;
+  uint16_t Counts;
+
+  for (Rep = 0; Rep < REPS; Rep++)
+  {
+    for (Counts = 1; Counts < ADC_FULL_SCALE; Counts++)
+    {
+      Sum += Equation(Counts);
+    }
+  }
+  Bench_Sink = (uint32_t)Sum;
+  return Bench_Cycles() - Start;
+}
+
+int main(void)
+{
+  double    WorstRated = 0;
+  double    WorstCore = 0;
+  uint16_t  WorstCounts = 0;
+  uint16_t  Counts;
+  double    Conversions = (double)REPS * (ADC_FULL_SCALE - 1);
+
+  for (Counts = 1; Counts < ADC_FULL_SCALE; Counts++)
+  {
+    double Expected = Equation(Counts);
+    double Error = fabs(Thermistor_CountsToCentiC(Counts) / 100.0 - Expected);
+
+    if ((Expected < RATED_LOW_C) || (Expected > RATED_HIGH_C))
+    {
+      continue;
+    }
+    if (Error > WorstRated)
+    {
+      WorstRated = Error;
+      WorstCounts = Counts;
+    }
+    if ((Expected >= CORE_LOW_C) && (Expected <= CORE_HIGH_C) &&
+        (Error > WorstCore))
+    {
+      WorstCore = Error;
+    }
+  }
+  printf("worst error %.3f C from %.0f to %.0f C, %.3f C from %.0f to %.0f C\n",
+      WorstCore, CORE_LOW_C, CORE_HIGH_C, WorstRated, RATED_LOW_C,
+      RATED_HIGH_C);
+  if (WorstRated > MAX_ERROR_C)
+  {
+    printf("FAIL: %.3f C off at %u counts\n", WorstRated,
+        (unsigned)WorstCounts);
+    return 1;
+  }
+
+  printf("%-10s %12s\n", "variant", BENCH_CYCLE_UNIT "/conv");
+  printf("%-10s %12.2f\n", "table", (double)TimeTable() / Conversions);
+  printf("%-10s %12.2f\n", "equation", (double)TimeEquation() / Conversions);
+  return 0;
+}
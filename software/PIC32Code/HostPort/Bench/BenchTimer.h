@@ -0,0 +1,48 @@
+/****************************************************************************
+ Module
+     BenchTimer.h
+ Description
+     Small timing helpers shared by the host benchmarks. Cycles come from
+     the time stamp counter on x86 and are estimated from the monotonic
+     clock everywhere else.
+ Notes
+     header only, each benchmark is a single translation unit
+*****************************************************************************/
+#ifndef BENCH_TIMER_H
+#define BENCH_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC
+#endif
+
+static inline uint64_t Bench_Nanos(void)
+{
+  struct timespec Now;
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (uint64_t)Now.tv_sec * 1000000000ULL + (uint64_t)Now.tv_nsec;
+}
+
+static inline uint64_t Bench_Cycles(void)
+{
+#ifdef BENCH_HAS_TSC
+  return __rdtsc();
+#else
+  return Bench_Nanos();
+#endif
+}
+
+// name of the unit Bench_Cycles counts in, for the reports
+#ifdef BENCH_HAS_TSC
+#define BENCH_CYCLE_UNIT "cycles"
+#else
+#define BENCH_CYCLE_UNIT "ns"
+#endif
+
+// keeps the optimizer from discarding a result
+static volatile uint32_t Bench_Sink;
+
+#endif /* BENCH_TIMER_H */
@@ -0,0 +1,109 @@
+/****************************************************************************
+ Module
+     BenchTimerScanConfigure.h
+ Description
+     ES_Configure.h stand-in for BenchTimerScan, the timer module with its
+     default per-tick scan of the active timers. BenchTimerWheelConfigure.h
+     adds the timing wheel on top of this.
+ Notes
+     every timer posts to BenchTimeout. Only ES_Timers.c and
+     ES_LookupTables.c are built against it; service 0 is only there for
+     ES_ServiceHeaders.h.
+*****************************************************************************/
+#ifndef ES_CONFIGURE_H
+#define ES_CONFIGURE_H
+
+#define MAX_NUM_SERVICES 16
+#define NUM_SERVICES 1
+
+#define SERV_0_HEADER "BenchTimerScanConfigure.h"
+
+typedef enum
+{
+  ES_NO_EVENT = 0,
+  ES_ERROR,
+  ES_INIT,
+  ES_TIMEOUT,
+  ES_SHORT_TIMEOUT,
+  ES_NEW_KEY
+}ES_EventType_t;
+
+#define NUM_DIST_LISTS 0
+
+#ifndef MAX_NUM_TIMERS
+#define MAX_NUM_TIMERS 64
+#endif
+#define TIMER_UNUSED ((pPostFunc)0)
+#define TIMER0_RESP_FUNC BenchTimeout
+#define TIMER1_RESP_FUNC BenchTimeout
+#define TIMER2_RESP_FUNC BenchTimeout
+#define TIMER3_RESP_FUNC BenchTimeout
+#define TIMER4_RESP_FUNC BenchTimeout
+#define TIMER5_RESP_FUNC BenchTimeout
+#define TIMER6_RESP_FUNC BenchTimeout
+#define TIMER7_RESP_FUNC BenchTimeout
+#define TIMER8_RESP_FUNC BenchTimeout
+#define TIMER9_RESP_FUNC BenchTimeout
+#define TIMER10_RESP_FUNC BenchTimeout
+#define TIMER11_RESP_FUNC BenchTimeout
+#define TIMER12_RESP_FUNC BenchTimeout
+#define TIMER13_RESP_FUNC BenchTimeout
+#define TIMER14_RESP_FUNC BenchTimeout
+#define TIMER15_RESP_FUNC BenchTimeout
+#define TIMER16_RESP_FUNC BenchTimeout
+#define TIMER17_RESP_FUNC BenchTimeout
+#define TIMER18_RESP_FUNC BenchTimeout
+#define TIMER19_RESP_FUNC BenchTimeout
+#define TIMER20_RESP_FUNC BenchTimeout
+#define TIMER21_RESP_FUNC BenchTimeout
+#define TIMER22_RESP_FUNC BenchTimeout
+#define TIMER23_RESP_FUNC BenchTimeout
+#define TIMER24_RESP_FUNC BenchTimeout
+#define TIMER25_RESP_FUNC BenchTimeout
+#define TIMER26_RESP_FUNC BenchTimeout
+#define TIMER27_RESP_FUNC BenchTimeout
+#define TIMER28_RESP_FUNC BenchTimeout
+#define TIMER29_RESP_FUNC BenchTimeout
+#define TIMER30_RESP_FUNC BenchTimeout
+#define TIMER31_RESP_FUNC BenchTimeout
+#define TIMER32_RESP_FUNC BenchTimeout
+#define TIMER33_RESP_FUNC BenchTimeout
+#define TIMER34_RESP_FUNC BenchTimeout
+#define TIMER35_RESP_FUNC BenchTimeout
+#define TIMER36_RESP_FUNC BenchTimeout
+#define TIMER37_RESP_FUNC BenchTimeout
+#define TIMER38_RESP_FUNC BenchTimeout
+#define TIMER39_RESP_FUNC BenchTimeout
+#define TIMER40_RESP_FUNC BenchTimeout
+#define TIMER41_RESP_FUNC BenchTimeout
+#define TIMER42_RESP_FUNC BenchTimeout
+#define TIMER43_RESP_FUNC BenchTimeout
+#define TIMER44_RESP_FUNC BenchTimeout
+#define TIMER45_RESP_FUNC BenchTimeout
+#define TIMER46_RESP_FUNC BenchTimeout
+#define TIMER47_RESP_FUNC BenchTimeout
+#define TIMER48_RESP_FUNC BenchTimeout
+#define TIMER49_RESP_FUNC BenchTimeout
+#define TIMER50_RESP_FUNC BenchTimeout
+#define TIMER51_RESP_FUNC BenchTimeout
+#define TIMER52_RESP_FUNC BenchTimeout
+#define TIMER53_RESP_FUNC BenchTimeout
+#define TIMER54_RESP_FUNC BenchTimeout
+#define TIMER55_RESP_FUNC BenchTimeout
+#define TIMER56_RESP_FUNC BenchTimeout
+#define TIMER57_RESP_FUNC BenchTimeout
+#define TIMER58_RESP_FUNC BenchTimeout
+#define TIMER59_RESP_FUNC BenchTimeout
+#define TIMER60_RESP_FUNC BenchTimeout
+#define TIMER61_RESP_FUNC BenchTimeout
+#define TIMER62_RESP_FUNC BenchTimeout
+#define TIMER63_RESP_FUNC BenchTimeout
+
+#endif /* ES_CONFIGURE_H */
+
+// outside the guard so SERV_0_HEADER can pull these in once ES_Events.h has
+// defined ES_Event_t
+#if defined(ES_Events_H) && !defined(BENCH_TIMER_SERVICES_H)
+#define BENCH_TIMER_SERVICES_H
+bool BenchTimeout(ES_Event_t ThisEvent);
+#endif
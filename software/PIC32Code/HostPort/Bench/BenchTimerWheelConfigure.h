@@ -0,0 +1,14 @@
+/****************************************************************************
+ Module
+     BenchTimerWheelConfigure.h
+ Description
+     ES_Configure.h stand-in for BenchTimerWheel, the same set up as
+     BenchTimerScanConfigure.h with the timing wheel turned on and room for
+     the timers beyond 64 that only the wheel allows
+ Notes
+*****************************************************************************/
+#define MAX_NUM_TIMERS 250
+#define TIMER_WHEEL_SIZE 256
+#define TIMER_EXTRA_RESP_FUNC BenchTimeout
+
+#include "BenchTimerScanConfigure.h"
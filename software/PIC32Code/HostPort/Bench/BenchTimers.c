@@ -0,0 +1,152 @@
+/****************************************************************************
+ Module
+     BenchTimers.c
+ Description
+     Cost of ES_Timer_Tick_Resp against the number of armed timers. Built
+     twice, as BenchTimerScan (the default scan of every active timer) and as
+     BenchTimerWheel (TIMER_WHEEL_SIZE defined), so the two can be compared.
+ Notes
+     Each armed timer runs for a random 1 to BENCH_MAX_TIME ticks and is
+     restarted with a new random time as soon as it expires, the way a
+     service re-arms its timer, so the count stays constant. The time per
+     tick includes those restarts. Every timeout is checked against the tick
+     it was due on and the run fails on the first one that is early or late.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "BenchTimer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NUM_TICKS 1000000UL
+#define BENCH_MAX_TIME 5000
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint32_t RandomTime(void);
+static void ArmTimer(uint8_t Num);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint8_t ArmedCounts[] = { 1, 8, 16, 32, 64, 128, 250 };
+
+static uint32_t Seed = 12345;
+static uint32_t Now;
+static uint32_t DueAt[MAX_NUM_TIMERS];
+static uint8_t  Expired[MAX_NUM_TIMERS];
+static uint8_t  NumExpired;
+static uint32_t NumTimeouts;
+
+/*------------------------------ Module Code ------------------------------*/
+bool BenchTimeout(ES_Event_t ThisEvent)
+{
+  if (DueAt[ThisEvent.EventParam] != Now)
+  {
+    printf("timer %u expired on tick %u, due on %u\n",
+        (unsigned)ThisEvent.EventParam, (unsigned)Now,
+        (unsigned)DueAt[ThisEvent.EventParam]);
+    exit(EXIT_FAILURE);
+  }
+  Expired[NumExpired++] = (uint8_t)ThisEvent.EventParam;
+  return true;
+}
+
+// the framework's timer module only needs these from the port
+void _HW_Timer_Init(const TimerRate_t Rate)
+{
+}
+
+uint16_t _HW_GetTickCount(void)
+{
+  return (uint16_t)Now;
+}
+
+uint64_t _HW_GetTickCount64(void)
+{
+  return Now;
+}
+
+unsigned int _HW_HostDisableInts(void)
+{
+  return 0;
+}
+
+unsigned int _HW_HostEnableInts(void)
+{
+  return 0;
+}
+
+int main(void)
+{
+  uint8_t   Row;
+  uint8_t   NumArmed;
+  uint8_t   i;
+  uint32_t  Tick;
+  uint64_t  Start;
+  uint64_t  Cost;
+
+  ES_Timer_Init(ES_Timer_RATE_1mS);
+#ifdef TIMER_WHEEL_SIZE
+  printf("timing wheel, %u slots\n", (unsigned)TIMER_WHEEL_SIZE);
+#else
+  puts("scan of the active timers");
+#endif
+  printf("%6s %12s %10s\n", "armed", BENCH_CYCLE_UNIT "/tick", "timeouts");
+
+  for (Row = 0; Row < ARRAY_SIZE(ArmedCounts); Row++)
+  {
+    NumArmed = ArmedCounts[Row];
+    if (NumArmed > MAX_NUM_TIMERS)
+    {
+      break;
+    }
+    for (i = 0; i < NumArmed; i++)
+    {
+      ArmTimer(i);
+    }
+    NumTimeouts = 0;
+    Start = Bench_Cycles();
+    for (Tick = 0; Tick < NUM_TICKS; Tick++)
+    {
+      Now++;
+      NumExpired = 0;
+      ES_Timer_Tick_Resp();
+      NumTimeouts += NumExpired;
+      for (i = 0; i < NumExpired; i++)
+      {
+        ArmTimer(Expired[i]);
+      }
+    }
+    Cost = Bench_Cycles() - Start;
+    printf("%6u %12.2f %10u\n", (unsigned)NumArmed, (double)Cost / NUM_TICKS,
+        (unsigned)NumTimeouts);
+    for (i = 0; i < NumArmed; i++)
+    {
+      ES_Timer_StopTimer(i);
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static uint32_t RandomTime(void)
+{
+  Seed = Seed * 1103515245UL + 12345UL;
+  return (uint32_t)(1 + ((Seed >> 8) % BENCH_MAX_TIME));
+}
+
+static void ArmTimer(uint8_t Num)
+{
+  uint32_t Time = RandomTime();
+
+  DueAt[Num] = Now + Time;
+  if (ES_Timer_InitTimer(Num, Time) != ES_Timer_OK)
+  {
+    printf("could not start timer %u\n", (unsigned)Num);
+    exit(EXIT_FAILURE);
+  }
+}
@@ -0,0 +1,135 @@
+/****************************************************************************
+ Module
+     CheckHostClock.c
+ Description
+     Checks the host port's real-time clock math a long way into a run:
+       ticks:  _HW_SysTickIntHandler catches up to the wall clock
+       count:  the emulated core timer Count agrees with the ticks
+       idle:   _HW_Idle sleeps for a tick, not some wrapped length
+ Notes
+     Backdates the clock start by CHECK_HOURS rather than waiting. Before
+     the clock math was kept in core counts, the products of elapsed time
+     and clock rate overflowed 64 bits after about 922 s.
+     Links the real host ES_Port.c with stand-ins for the timer module, the
+     plant model and the terminal.
+     Build and run with 'make bench' from HostPort.
+*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <cp0defs.h>
+
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_Timers.h"
+#include "ES_HostPort.h"
+#include "terminal.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define CHECK_HOURS 2
+#define NS_PER_SEC 1000000000ULL
+#define TICKS_PER_SEC 1000ULL
+#define COUNTS_PER_TICK ((uint32_t)ES_Timer_RATE_1mS)
+// a tick either way for the time the checks themselves take
+#define TICK_SLACK 50
+// an idle pass sleeps a tick, or TICKLESS_MAX_TICKS with TICKLESS_IDLE;
+// allow plenty for the OS
+#define MAX_IDLE_MS 200
+// a wrapped wake time can mean a nap of hours, give up on it
+#define WATCHDOG_SECONDS 5
+
+/*------------------------------ Module Code ------------------------------*/
+// ES_Port.c only needs these from the rest of the build
+void ES_Timer_Tick_Resp(void)
+{
+}
+
+uint32_t ES_Timer_GetTicksToNextTimeout(void)
+{
+  return 1;
+}
+
+uint32_t ES_Timer_SkipTicks(uint32_t NumTicks)
+{
+  return 0;
+}
+
+void HostSFR_UpdateSensors(uint64_t Now)
+{
+}
+
+void HostSFR_ServiceADC(void)
+{
+}
+
+void Terminal_HWInit(void)
+{
+}
+
+static void TimedOut(int Signal)
+{
+  (void)Signal;
+  printf("FAIL: _HW_Idle was still asleep after %d s\n", WATCHDOG_SECONDS);
+  _exit(1);
+}
+
+static double NowMs(void)
+{
+  struct timespec Now;
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec * 1e3 + Now.tv_nsec / 1e6;
+}
+
+int main(void)
+{
+  uint64_t  Expected = CHECK_HOURS * 3600ULL * TICKS_PER_SEC;
+  uint64_t  Ticks;
+  uint32_t  CountTicks;
+  double    Start;
+  double    IdleMs;
+
+  _HW_HostSetMode(HostRealTime);
+  _HW_Timer_Init(ES_Timer_RATE_1mS);
+  _HW_HostBackdateClock(CHECK_HOURS * 3600ULL * NS_PER_SEC);
+
+  _HW_SysTickIntHandler();
+  Ticks = _HW_HostGetTicks();
+  printf("after %d h: %llu ticks, expected %llu\n", CHECK_HOURS,
+      (unsigned long long)Ticks, (unsigned long long)Expected);
+  if ((Ticks < Expected) || (Ticks > Expected + TICK_SLACK))
+  {
+    puts("FAIL: the tick count did not follow the wall clock");
+    return 1;
+  }
+
+  // Count wraps every 214 s, so compare in ticks modulo the wrap
+  CountTicks = _CP0_GET_COUNT() / COUNTS_PER_TICK;
+  if ((uint32_t)((CountTicks - (uint32_t)(Ticks % (0x100000000ULL /
+      COUNTS_PER_TICK))) + TICK_SLACK) > 2 * TICK_SLACK)
+  {
+    printf("FAIL: core Count is %u ticks, not near the tick count\n",
+        (unsigned)CountTicks);
+    return 1;
+  }
+
+  signal(SIGALRM, TimedOut);
+  alarm(WATCHDOG_SECONDS);
+  Start = NowMs();
+  _HW_Idle();
+  IdleMs = NowMs() - Start;
+  alarm(0);
+  printf("idle pass took %.2f ms\n", IdleMs);
+  if (IdleMs > MAX_IDLE_MS)
+  {
+    puts("FAIL: _HW_Idle slept far longer than a tick");
+    return 1;
+  }
+  if (_HW_HostGetTicks() < Ticks)
+  {
+    puts("FAIL: the clock went backwards");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+ Module
+     ES_HostPort.h
+ Description
+     header file for the host (POSIX) specific extensions of the ES_Port
+     interface. The standard port interface is still ES_Port.h; this adds the
+     controls that only make sense when the framework runs in a simulation.
+ Notes
+
+*****************************************************************************/
+#ifndef ES_HOST_PORT_H
+#define ES_HOST_PORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ES_Port.h"
+
+typedef enum
+{
+  HostRealTime,   /* ticks follow the wall clock, 1 tick per tick period */
+  HostFreeRun     /* when idle, jump straight to the next timer expiry */
+}HostClockMode_t;
+
+// simulation control
+void _HW_HostSetMode(HostClockMode_t Mode);
+void _HW_HostSetRunLimit(uint64_t Ticks);
+void _HW_HostBackdateClock(uint64_t Nanos);
+uint64_t _HW_HostGetTicks(void);
+uint64_t _HW_HostGetIdleCount(void);
+uint64_t _HW_HostGetWakeups(void);
+double _HW_HostGetWallSeconds(void);
+
+// plant model that feeds the analog inputs (HostSFR.c)
+void HostSFR_UpdateSensors(uint64_t Now);
+void HostSFR_ServiceADC(void);
+double HostSFR_GetSoilMoisture(void);
+
+// firmware interrupt handlers the host port runs itself (ADC_HAL.c)
+void ADC_EOS_ISR(void);
+
+// keystroke injection for the host terminal
+void Terminal_HostQueueKeys(const char *Keys);
+
+#endif /* ES_HOST_PORT_H */
@@ -0,0 +1,520 @@
+/****************************************************************************
+ Module
+   ES_Port.c (host port)
+
+ Revision
+   1.0.1
+
+ Description
+   Drop-in replacement for FrameworkSource/ES_Port.c that lets the Events &
+   Services framework and the SmartPot services run on a POSIX host. The
+   PIC32 core timer is replaced by a virtual clock that can either follow
+   the wall clock or, in free-running mode, skip directly to the next timer
+   expiry whenever the framework has nothing to do.
+
+ Notes
+   The emulated core timer runs at the same 20MHz as the PIC32 so that the
+   TimerRate_t constants in ES_Port.h keep their meaning.
+   There are no real interrupts on the host. The tick "interrupt" is polled
+   from _HW_Process_Pending_Ints, which ES_Run calls after every dispatch,
+   so every tick is seen by the framework in the same place it would be on
+   the target.
+   With TICKLESS_IDLE, _HW_Idle sleeps to the next timer expiry the way the
+   target does. Either way the port counts the core timer interrupts the
+   target would have taken, so the two can be compared.
+ ***************************************************************************/
+#include <xc.h>
+#include <cp0defs.h>
+#include <sys/attribs.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_Types.h"
+#include "ES_Timers.h"
+#include "ES_HostPort.h"
+
+#include "terminal.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// core timer counts per second, matches the comment on TimerRate_t
+#define CORE_TIMER_HZ 20000000UL
+#define NS_PER_SEC 1000000000ULL
+// the clock math goes through core counts of this many ns, so that no
+// product of a long elapsed time and a clock rate can overflow
+#define NS_PER_COUNT (NS_PER_SEC / CORE_TIMER_HZ)
+#if (NS_PER_SEC % CORE_TIMER_HZ) != 0
+#error "CORE_TIMER_HZ must divide 1 GHz evenly"
+#endif
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint64_t WallNanos(void);
+static uint64_t WallTicks(void);
+static void GenerateTicks(uint64_t NumTicks, uint64_t NumInts);
+
+/*---------------------------- Module Variables ---------------------------*/
+// same role as on the target: ticks that have happened but have not yet
+// been run through ES_Timer_Tick_Resp. Wider here because a free-running
+// jump can post thousands of ticks at once
+static volatile uint32_t TickCount;
+
+// Global tick count, kept at 16 bits to match _HW_GetTickCount on the PIC
+static volatile uint16_t SysTickCounter = 0;
+
+static TimerRate_t tickPeriod;
+
+// the virtual clock, in ticks since _HW_Timer_Init
+static uint64_t VirtualTicks;
+static uint64_t RunLimit = UINT64_MAX;
+static HostClockMode_t ClockMode = HostRealTime;
+static uint64_t StartNanos;
+static uint64_t IdleCount;
+// core timer interrupts the target would have taken
+static uint64_t Wakeups;
+static uint32_t CoreCompare;
+
+// models the IE bit in the status register
+static unsigned int IntsEnabled;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+    _HW_PIC32Init
+ Parameters
+    none
+ Returns
+     None.
+ Description
+    Initializes the host terminal, the stand-in for UART1
+ Notes
+    Name kept so that main() reads the same on host and target
+****************************************************************************/
+void _HW_PIC32Init(void)
+{
+  Terminal_HWInit();
+}
+
+/****************************************************************************
+ Function
+     _HW_Timer_Init
+ Parameters
+     TimerRate_t Rate set to one of the TMR_RATE_XX enum values to set the
+     Tick rate
+ Returns
+     None.
+ Description
+     Starts the virtual clock at the requested tick rate
+ Notes
+****************************************************************************/
+void _HW_Timer_Init(const TimerRate_t Rate)
+{
+  if (Rate > 0)
+  {
+    tickPeriod    = Rate;
+    VirtualTicks  = 0;
+    StartNanos    = WallNanos();
+    CoreCompare   = Rate;
+    IntsEnabled   = 1;
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_SysTickIntHandler
+ Parameters
+     none
+ Returns
+     None.
+ Description
+     stand-in for the core timer ISR. In real-time mode it posts however
+     many ticks the wall clock says have elapsed since the last call.
+ Notes
+     In free-running mode ticks are only generated by _HW_Idle, so this
+     does nothing.
+****************************************************************************/
+void _HW_SysTickIntHandler(void)
+{
+  uint64_t TicksDue;
+
+  if ((tickPeriod == ES_Timer_RATE_OFF) || (ClockMode != HostRealTime))
+  {
+    return;
+  }
+  TicksDue = WallTicks();
+  if (TicksDue > VirtualTicks)
+  {
+    GenerateTicks(TicksDue - VirtualTicks, TicksDue - VirtualTicks);
+  }
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickCount()
+ Parameters
+    none
+ Returns
+    uint16_t   count of number of system ticks that have occurred.
+ Description
+    wrapper for access to SysTickCounter
+ Notes
+
+****************************************************************************/
+uint16_t _HW_GetTickCount(void)
+{
+  return SysTickCounter;
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickCount64()
+ Parameters
+    none
+ Returns
+    uint64_t   count of number of system ticks that have occurred.
+ Description
+    the virtual clock is already 64 bits wide
+ Notes
+
+****************************************************************************/
+uint64_t _HW_GetTickCount64(void)
+{
+  return VirtualTicks;
+}
+
+/****************************************************************************
+ Function
+    _HW_GetCycleCount()
+ Parameters
+    none
+ Returns
+    uint32_t   the monotonic clock, in core timer counts
+ Description
+    counts at the target's core timer rate, from the wall clock in either
+    mode, so ES_PROFILE times what the host actually spent
+ Notes
+    unlike _HW_HostGetCoreCount this does not follow the virtual clock, which
+    stands still in free-running mode
+****************************************************************************/
+uint32_t _HW_GetCycleCount(void)
+{
+  return (uint32_t)(WallNanos() / NS_PER_COUNT);
+}
+
+/****************************************************************************
+ Function
+    _HW_WatchdogInit / _HW_WatchdogClear / _HW_WatchdogCausedReset
+ Parameters
+    none
+ Returns
+    _HW_WatchdogCausedReset: always false
+ Description
+    the host has no watchdog, a hung run function just hangs the simulation
+ Notes
+****************************************************************************/
+void _HW_WatchdogInit(void)
+{
+}
+
+void _HW_WatchdogClear(void)
+{
+}
+
+bool _HW_WatchdogCausedReset(void)
+{
+  return false;
+}
+
+/****************************************************************************
+ Function
+     _HW_Process_Pending_Ints
+ Parameters
+     none
+ Returns
+     always true.
+ Description
+     polls the virtual tick interrupt, then catches the framework timers up
+     on the pending ticks, exactly as the target does. Any ADC scan started
+     since the last poll completes here too.
+ Notes
+     this is also where the simulation ends once the run limit is reached
+****************************************************************************/
+bool _HW_Process_Pending_Ints(void)
+{
+  _HW_SysTickIntHandler();
+  if (TickCount > 0)
+  {
+    if (TickCount > 1)
+    {
+      TickCount -= ES_Timer_SkipTicks(TickCount - 1);
+    }
+    while (TickCount > 0)
+    {
+      ES_Timer_Tick_Resp();
+      TickCount--;
+    }
+    HostSFR_UpdateSensors(VirtualTicks);
+  }
+  HostSFR_ServiceADC();
+  if (VirtualTicks >= RunLimit)
+  {
+    exit(EXIT_SUCCESS);
+  }
+  return true;  // always return true to allow loop test in ES_Run to proceed
+}
+
+/****************************************************************************
+ Function
+     _HW_Idle
+ Parameters
+     none
+ Returns
+     none.
+ Description
+     called by ES_Run when every queue is empty and no event checker fired.
+     In real-time mode we sleep until the next tick is due, or with
+     TICKLESS_IDLE until the next timer expiry. In free-running mode we
+     advance the virtual clock straight to the next timer expiry, but
+     without TICKLESS_IDLE count a wakeup for every tick on the way.
+ Notes
+     with no timer running in free-running mode nothing can ever happen
+     again (there are no real inputs), so the simulation ends.
+     A tickless sleep is one wakeup however many ticks it covers.
+****************************************************************************/
+void _HW_Idle(void)
+{
+  uint64_t Sleep;
+
+  IdleCount++;
+  if (tickPeriod == ES_Timer_RATE_OFF)
+  {
+    return;
+  }
+  Sleep = ES_Timer_GetTicksToNextTimeout();
+  if ((ClockMode == HostFreeRun) && (Sleep == 0))
+  { // no timer running and no real inputs, so the run is over
+    exit(EXIT_SUCCESS);
+  }
+#ifdef TICKLESS_IDLE
+  if ((Sleep == 0) || (Sleep > TICKLESS_MAX_TICKS))
+  {
+    Sleep = TICKLESS_MAX_TICKS;
+  }
+#endif
+  if (ClockMode == HostFreeRun)
+  {
+    if (Sleep > (RunLimit - VirtualTicks))
+    {
+      Sleep = RunLimit - VirtualTicks;
+    }
+#ifdef TICKLESS_IDLE
+    GenerateTicks(Sleep, 1);
+#else
+    GenerateTicks(Sleep, Sleep);
+#endif
+  }
+  else
+  {
+#ifndef TICKLESS_IDLE
+    Sleep = 1;
+#endif
+    uint64_t WakeNanos = (VirtualTicks + Sleep) * tickPeriod * NS_PER_COUNT +
+        StartNanos;
+    uint64_t Now = WallNanos();
+    if (WakeNanos > Now)
+    {
+      struct timespec Nap;
+      Nap.tv_sec  = (WakeNanos - Now) / NS_PER_SEC;
+      Nap.tv_nsec = (WakeNanos - Now) % NS_PER_SEC;
+      nanosleep(&Nap, NULL);
+    }
+#ifdef TICKLESS_IDLE
+    // the ticks slept through arrive with the one interrupt
+    Sleep = WallTicks();
+    if (Sleep > VirtualTicks)
+    {
+      GenerateTicks(Sleep - VirtualTicks, 1);
+    }
+#endif
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_ConsoleInit
+ Parameters
+     none
+ Returns
+     none.
+ Description
+  Initializes the host terminal
+ Notes
+ ****************************************************************************/
+void _HW_ConsoleInit(void)
+{
+  Terminal_HWInit();
+}
+
+/****************************************************************************
+ Function
+     _HW_HostDisableInts / _HW_HostEnableInts
+ Parameters
+     none
+ Returns
+     unsigned int, the previous interrupt enable state
+ Description
+     host versions of __builtin_disable_interrupts/__builtin_enable_interrupts
+ Notes
+ ****************************************************************************/
+unsigned int _HW_HostDisableInts(void)
+{
+  unsigned int Prior = IntsEnabled;
+  IntsEnabled = 0;
+  return Prior;
+}
+
+unsigned int _HW_HostEnableInts(void)
+{
+  unsigned int Prior = IntsEnabled;
+  IntsEnabled = 1;
+  return Prior;
+}
+
+/****************************************************************************
+ Function
+     _HW_HostGetCoreCount / _HW_HostGetCoreCompare / _HW_HostSetCoreCompare
+ Parameters
+     Compare, the new value for the emulated Compare register
+ Returns
+     the emulated Count/Compare register
+ Description
+     the core timer as seen through the virtual clock
+ Notes
+     Count only advances in whole ticks in free-running mode
+ ****************************************************************************/
+uint32_t _HW_HostGetCoreCount(void)
+{
+  if (ClockMode == HostRealTime)
+  {
+    return (uint32_t)((WallNanos() - StartNanos) / NS_PER_COUNT);
+  }
+  return (uint32_t)(VirtualTicks * tickPeriod);
+}
+
+uint32_t _HW_HostGetCoreCompare(void)
+{
+  return CoreCompare;
+}
+
+void _HW_HostSetCoreCompare(uint32_t Compare)
+{
+  CoreCompare = Compare;
+}
+
+/****************************************************************************
+ Function
+     _HW_HostSetMode / _HW_HostSetRunLimit
+ Parameters
+     HostClockMode_t Mode, real-time or free-running
+     uint64_t Ticks, number of ticks after which the simulation exits
+ Returns
+     none.
+ Description
+     simulation controls, set these before calling ES_Initialize
+ Notes
+     the run limit ends the process with exit(), so register anything that
+     should report at the end with atexit()
+ ****************************************************************************/
+void _HW_HostSetMode(HostClockMode_t Mode)
+{
+  ClockMode = Mode;
+}
+
+void _HW_HostSetRunLimit(uint64_t Ticks)
+{
+  RunLimit = Ticks;
+}
+
+/****************************************************************************
+ Function
+     _HW_HostBackdateClock
+ Parameters
+     uint64_t Nanos, how far to move the real-time clock's start back
+ Returns
+     none.
+ Description
+     makes a real-time run look as if it started Nanos earlier, so the
+     clock math can be checked hours in without waiting hours
+ Notes
+     the ticks in between arrive on the next _HW_SysTickIntHandler
+ ****************************************************************************/
+void _HW_HostBackdateClock(uint64_t Nanos)
+{
+  StartNanos -= Nanos;
+}
+
+/****************************************************************************
+ Function
+     _HW_HostGetTicks / _HW_HostGetIdleCount / _HW_HostGetWakeups /
+     _HW_HostGetWallSeconds
+ Parameters
+     none
+ Returns
+     the full width virtual tick count, the number of idle passes through
+     ES_Run, the number of core timer interrupts the target would have
+     taken, and the wall clock time since the timer was started
+ Description
+     statistics for the end of run report
+ Notes
+ ****************************************************************************/
+uint64_t _HW_HostGetTicks(void)
+{
+  return VirtualTicks;
+}
+
+uint64_t _HW_HostGetIdleCount(void)
+{
+  return IdleCount;
+}
+
+uint64_t _HW_HostGetWakeups(void)
+{
+  return Wakeups;
+}
+
+double _HW_HostGetWallSeconds(void)
+{
+  return (double)(WallNanos() - StartNanos) / NS_PER_SEC;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static uint64_t WallNanos(void)
+{
+  struct timespec Now;
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (uint64_t)Now.tv_sec * NS_PER_SEC + (uint64_t)Now.tv_nsec;
+}
+
+// whole ticks of wall clock time since _HW_Timer_Init
+static uint64_t WallTicks(void)
+{
+  return (WallNanos() - StartNanos) / NS_PER_COUNT / tickPeriod;
+}
+
+// the body of the tick ISR: advance the clocks and flag the ticks pending.
+// NumInts is how many interrupts the target would have taken to get there
+static void GenerateTicks(uint64_t NumTicks, uint64_t NumInts)
+{
+  Wakeups         += NumInts;
+  VirtualTicks    += NumTicks;
+  TickCount       += (uint32_t)NumTicks;
+  SysTickCounter  += (uint16_t)NumTicks;
+  CoreCompare     += (uint32_t)(NumTicks * tickPeriod);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
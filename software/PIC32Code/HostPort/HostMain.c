@@ -0,0 +1,249 @@
+/****************************************************************************
+ Module
+     HostMain.c
+ Description
+     main() for running the SmartPot firmware on a POSIX host. Mirrors
+     ProjectSource/main.c, adding the command line controls for the virtual
+     clock and a short report when the run ends.
+ Notes
+     usage: smartpot_sim [-f] [-q] [-s seconds | -d days] [-k keys]
+                         [-t tracefile]
+       -f  free-running: skip idle time instead of waiting for it
+       -q  discard the terminal output (the report still goes to stderr)
+       -s  stop after this many simulated seconds
+       -d  stop after this many simulated days
+       -k  keystrokes to deliver as though typed on the terminal
+       -t  write the flight recorder to this file at the end, for
+           TraceDecode; only when built with ES_TRACE
+*****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Port.h"
+#include "ES_HostPort.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define TICKS_PER_SEC 1000ULL
+#define SECS_PER_DAY (24ULL * 60ULL * 60ULL)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Report(void);
+static void ReportQueues(void);
+#ifdef ES_PROFILE
+static void ReportProfile(void);
+#endif
+#ifdef ES_RUN_BUDGET
+static void ReportOverruns(void);
+#endif
+static void Usage(const char *Name);
+#ifdef ES_TRACE
+static void DumpTrace(void);
+#endif
+
+/*---------------------------- Module Variables ---------------------------*/
+#ifdef ES_TRACE
+static const char *TraceFile; // where -t sends the recorder at the end
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+  ES_Return_t ErrorType;
+  int Option;
+
+  while ((Option = getopt(argc, argv, "fqs:d:k:t:")) != -1)
+  {
+    switch (Option)
+    {
+      case 'f':
+      {
+        _HW_HostSetMode(HostFreeRun);
+      }
+      break;
+
+      case 'q':
+      {
+        if (freopen("/dev/null", "w", stdout) == NULL)
+        {
+          perror("freopen");
+          return EXIT_FAILURE;
+        }
+      }
+      break;
+
+      case 's':
+      {
+        _HW_HostSetRunLimit(strtoull(optarg, NULL, 0) * TICKS_PER_SEC);
+      }
+      break;
+
+      case 'd':
+      {
+        _HW_HostSetRunLimit(strtoull(optarg, NULL, 0) * SECS_PER_DAY *
+            TICKS_PER_SEC);
+      }
+      break;
+
+      case 'k':
+      {
+        Terminal_HostQueueKeys(optarg);
+      }
+      break;
+
+#ifdef ES_TRACE
+      case 't':
+      {
+        TraceFile = optarg;
+      }
+      break;
+#endif
+
+      default:
+      {
+        Usage(argv[0]);
+      }
+      return EXIT_FAILURE;
+    }
+  }
+
+  atexit(Report);
+
+  _HW_PIC32Init(); // basic host "hardware" init
+
+  ErrorType = ES_Initialize(ES_Timer_RATE_1mS);
+  if (ErrorType == Success)
+  {
+    ErrorType = ES_Run();
+  }
+  fprintf(stderr, "framework stopped with error %d\n", (int)ErrorType);
+  return EXIT_FAILURE;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static void Report(void)
+{
+  double Wall = _HW_HostGetWallSeconds();
+  double Simulated = (double)_HW_HostGetTicks() / TICKS_PER_SEC;
+
+  fflush(stdout);
+  fprintf(stderr, "simulated %.3f s in %.3f s wall (x%.0f)\n", Simulated,
+      Wall, (Wall > 0.0) ? Simulated / Wall : 0.0);
+  fprintf(stderr, "idle passes: %llu\n",
+      (unsigned long long)_HW_HostGetIdleCount());
+  fprintf(stderr, "core timer wakeups: %llu (%.1f per second)\n",
+      (unsigned long long)_HW_HostGetWakeups(),
+      (Simulated > 0.0) ? (double)_HW_HostGetWakeups() / Simulated : 0.0);
+  fprintf(stderr, "soil moisture at end: %.1f%%\n", HostSFR_GetSoilMoisture());
+  fprintf(stderr, "payload blocks free: %u of %u\n",
+      (unsigned)ES_PayloadNumFree(), (unsigned)NUM_PAYLOAD_BLOCKS);
+  fprintf(stderr, "periodic timer overruns: soil %u, temperature %u, usb %u\n",
+      (unsigned)ES_Timer_GetOverruns(SOIL_MOISTURE_TIMER),
+      (unsigned)ES_Timer_GetOverruns(TEMPERATURE_UPDATE_TIMER),
+      (unsigned)ES_Timer_GetOverruns(USB_UPDATE_TIMER));
+  ReportQueues();
+#ifdef ES_PROFILE
+  ReportProfile();
+#endif
+#ifdef ES_RUN_BUDGET
+  ReportOverruns();
+#endif
+#ifdef ES_TRACE
+  DumpTrace();
+#endif
+}
+
+// the queue sizing data, the same as the 'q' key prints on the terminal
+static void ReportQueues(void)
+{
+  ES_QueueStats_t Stats;
+  uint8_t         i;
+
+  fprintf(stderr, "%4s %4s %4s %10s %10s %8s %10s\n", "serv", "size",
+      "peak", "enqueued", "dequeued", "dropped", "coalesced");
+  for (i = 0; ES_GetQueueStats(i, &Stats); i++)
+  {
+    fprintf(stderr, "%4u %4u %4u %10lu %10lu %8lu %10lu\n", i, Stats.Capacity,
+        Stats.PeakDepth, (unsigned long)Stats.Enqueued,
+        (unsigned long)Stats.Dequeued, (unsigned long)Stats.Dropped,
+        (unsigned long)Stats.Coalesced);
+  }
+}
+
+#ifdef ES_PROFILE
+// the run function timings, the same as the 'p' key prints on the terminal,
+// wall clock time on this host rather than on the target
+static void ReportProfile(void)
+{
+  ES_ProfileStats_t Stats;
+  uint8_t           i;
+
+  fprintf(stderr, "%4s %10s %10s %10s %10s\n", "serv", "runs", "min us",
+      "mean us", "max us");
+  for (i = 0; ES_GetProfile(i, &Stats); i++)
+  {
+    fprintf(stderr, "%4u %10lu %10.2f %10.2f %10.2f\n", i,
+        (unsigned long)Stats.Runs,
+        (double)Stats.MinCounts / ES_PROFILE_COUNTS_PER_US,
+        (Stats.Runs == 0) ? 0.0 :
+        (double)Stats.TotalCounts / Stats.Runs / ES_PROFILE_COUNTS_PER_US,
+        (double)Stats.MaxCounts / ES_PROFILE_COUNTS_PER_US);
+  }
+}
+#endif
+
+#ifdef ES_RUN_BUDGET
+// the run budget overruns, the same as the 'o' key prints on the terminal.
+// Host run times are wall clock, so a busy host can show a few.
+static void ReportOverruns(void)
+{
+  ES_Overrun_t  Records[ES_OVERRUN_LOG_SIZE];
+  uint8_t       NumRecords = ES_GetOverruns(Records, ES_OVERRUN_LOG_SIZE);
+  uint8_t       i;
+
+  fprintf(stderr, "run budget overruns: %lu\n",
+      (unsigned long)ES_GetNumOverruns());
+  for (i = 0; i < NumRecords; i++)
+  {
+    fprintf(stderr, "  tick %llu serv %u event %u param %u: %.2f us\n",
+        (unsigned long long)Records[i].Tick, Records[i].Service,
+        (unsigned)Records[i].Event.EventType, Records[i].Event.EventParam,
+        (double)Records[i].Counts / ES_PROFILE_COUNTS_PER_US);
+  }
+}
+#endif
+
+#ifdef ES_TRACE
+// the flight recorder as 'r' would send it, but to a file of its own
+static void DumpTrace(void)
+{
+  if (TraceFile == NULL)
+  {
+    return;
+  }
+  if (freopen(TraceFile, "wb", stdout) == NULL)
+  {
+    perror(TraceFile);
+    return;
+  }
+  ES_TraceDump();
+  fflush(stdout);
+}
+#endif
+
+static void Usage(const char *Name)
+{
+#ifdef ES_TRACE
+  fprintf(stderr, "usage: %s [-f] [-q] [-s seconds | -d days] [-k keys] "
+      "[-t tracefile]\n", Name);
+#else
+  fprintf(stderr, "usage: %s [-f] [-q] [-s seconds | -d days] [-k keys]\n",
+      Name);
+#endif
+}
@@ -0,0 +1,303 @@
+/****************************************************************************
+ Module
+   HostSFR.c
+
+ Revision
+   1.0.1
+
+ Description
+   Storage for the special function register stand-ins declared in the host
+   xc.h, plus a very small plant model that drives the two analog inputs the
+   SmartPot reads (thermistor on AN12, soil moisture probe on AN13).
+
+ Notes
+   The plant model is deliberately simple: the air temperature follows a
+   sinusoid over the day and the soil dries at a constant rate, gaining
+   moisture while the pump output (RC10) is high. It exists so that a
+   simulated day exercises the same state machine paths as a real one, not
+   to be physically accurate.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <xc.h>
+#include <math.h>
+
+#include "ES_HostPort.h"
+#include "Thermistor.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define DEFINE_SFR(name) volatile uint32_t name
+
+#define TICKS_PER_DAY (24UL * 60UL * 60UL * 1000UL)
+#define MEAN_TEMP_C 22.0
+#define TEMP_SWING_C 6.0
+#define START_MOISTURE 35.0
+// percent per ms, ~1.5% per hour drying and ~2% per second while pumping
+#define DRY_RATE (1.5 / (60.0 * 60.0 * 1000.0))
+#define PUMP_RATE (2.0 / 1000.0)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void RunFilter(volatile __ADCFLTRxbits_t *pFilter, uint8_t Which);
+
+/*---------------------------- Module Variables ---------------------------*/
+DEFINE_SFR(IFS0CLR);
+DEFINE_SFR(IFS1CLR);
+DEFINE_SFR(IFS1SET);
+DEFINE_SFR(IEC0CLR);
+DEFINE_SFR(IEC0SET);
+DEFINE_SFR(IEC1CLR);
+DEFINE_SFR(IEC1SET);
+DEFINE_SFR(IEC2CLR);
+DEFINE_SFR(IEC2SET);
+DEFINE_SFR(IFS2CLR);
+
+DEFINE_SFR(TRISASET);
+DEFINE_SFR(TRISACLR);
+DEFINE_SFR(TRISBSET);
+DEFINE_SFR(TRISBCLR);
+DEFINE_SFR(TRISCSET);
+DEFINE_SFR(TRISCCLR);
+DEFINE_SFR(TRISDSET);
+DEFINE_SFR(TRISDCLR);
+DEFINE_SFR(ANSELASET);
+DEFINE_SFR(ANSELACLR);
+DEFINE_SFR(ANSELBSET);
+DEFINE_SFR(ANSELBCLR);
+DEFINE_SFR(ANSELCSET);
+DEFINE_SFR(ANSELCCLR);
+
+DEFINE_SFR(RPA0R);
+DEFINE_SFR(RPA7R);
+DEFINE_SFR(RPB5R);
+DEFINE_SFR(RPB6R);
+DEFINE_SFR(RPB14R);
+DEFINE_SFR(RPB15R);
+DEFINE_SFR(SDI1R);
+DEFINE_SFR(U1RXR);
+
+DEFINE_SFR(U1STA);
+DEFINE_SFR(U1BRG);
+DEFINE_SFR(U1TXREG);
+DEFINE_SFR(U1RXREG);
+
+DEFINE_SFR(SPI1CON);
+DEFINE_SFR(SPI1CON2);
+DEFINE_SFR(SPI1BRG);
+DEFINE_SFR(SPI1BUF);
+DEFINE_SFR(SPI2CON);
+DEFINE_SFR(SPI2CON2);
+DEFINE_SFR(SPI2BRG);
+DEFINE_SFR(SPI2BUF);
+
+DEFINE_SFR(DEVADC0);
+DEFINE_SFR(DEVADC1);
+DEFINE_SFR(DEVADC7);
+DEFINE_SFR(ADC0CFG);
+DEFINE_SFR(ADC1CFG);
+DEFINE_SFR(ADC7CFG);
+DEFINE_SFR(ADCCON1);
+DEFINE_SFR(ADCCON2);
+DEFINE_SFR(ADCCON3);
+DEFINE_SFR(ADCANCON);
+DEFINE_SFR(ADCCSS1);
+DEFINE_SFR(ADCCSS2);
+DEFINE_SFR(ADCGIRQEN1);
+DEFINE_SFR(ADCGIRQEN2);
+DEFINE_SFR(ADCCMPCON1);
+DEFINE_SFR(ADCCMPCON2);
+DEFINE_SFR(ADCFLTR1);
+DEFINE_SFR(ADCFLTR2);
+DEFINE_SFR(ADCEIEN1);
+DEFINE_SFR(ADCEIEN2);
+DEFINE_SFR(ADCDATA12);
+DEFINE_SFR(ADCDATA13);
+
+volatile __INTCONbits_t INTCONbits;
+volatile __PRISSbits_t PRISSbits;
+volatile __IFS0bits_t IFS0bits;
+volatile __IEC0bits_t IEC0bits;
+volatile __IPC0bits_t IPC0bits;
+volatile __IPC9bits_t IPC9bits;
+volatile __IPC11bits_t IPC11bits;
+volatile __LATAbits_t LATAbits;
+volatile __LATBbits_t LATBbits;
+volatile __LATCbits_t LATCbits;
+volatile __PORTAbits_t PORTAbits;
+volatile __PORTDbits_t PORTDbits;
+volatile __TRISBbits_t TRISBbits;
+volatile __ANSELBbits_t ANSELBbits;
+volatile __U1MODEbits_t U1MODEbits;
+volatile __U1STAbits_t U1STAbits;
+volatile __SPIxCONbits_t SPI1CONbits;
+volatile __SPIxCONbits_t SPI2CONbits;
+volatile __ADCCON1bits_t ADCCON1bits;
+// the reference is always ready on the host
+volatile __ADCCON2bits_t ADCCON2bits = { .BGVRRDY = 1 };
+volatile __ADCCON3bits_t ADCCON3bits;
+// so is the ADC7 SAR core
+volatile __ADCANCONbits_t ADCANCONbits = { .WKRDY0 = 1, .WKRDY7 = 1 };
+volatile __ADCxTIMEbits_t ADC0TIMEbits;
+volatile __ADCTRGMODEbits_t ADCTRGMODEbits;
+volatile __ADCIMCON1bits_t ADCIMCON1bits;
+volatile __ADCGIRQEN1bits_t ADCGIRQEN1bits;
+volatile __ADCCSS1bits_t ADCCSS1bits;
+volatile __ADCTRG4bits_t ADCTRG4bits;
+volatile __ADCFLTRxbits_t ADCFLTR1bits;
+volatile __ADCFLTRxbits_t ADCFLTR2bits;
+
+static double SoilMoisture = START_MOISTURE;
+static uint64_t LastUpdate;
+
+// what the oversampling filters have accumulated towards their next result
+static uint32_t FilterSums[2];
+static uint16_t FilterCounts[2];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     HostSFR_UpdateSensors
+
+ Parameters
+     uint64_t Now, the current virtual time in ticks (ms)
+
+ Returns
+     None.
+
+ Description
+     Advances the plant model to Now and loads the resulting readings into
+     ADCDATA12 (thermistor) and ADCDATA13 (soil moisture probe)
+ Notes
+     Called by the host port every time it processes pending ticks.
+****************************************************************************/
+void HostSFR_UpdateSensors(uint64_t Now)
+{
+  double Elapsed = (double)(Now - LastUpdate);
+  double TempC;
+  double R_thermistor;
+
+  LastUpdate = Now;
+
+  // soil dries continuously and is topped up while the pump runs
+  SoilMoisture -= DRY_RATE * Elapsed;
+  if (LATCbits.LATC10)
+  {
+    SoilMoisture += PUMP_RATE * Elapsed;
+  }
+  if (SoilMoisture < 0.0)
+  {
+    SoilMoisture = 0.0;
+  }
+  else if (SoilMoisture > 100.0)
+  {
+    SoilMoisture = 100.0;
+  }
+  ADCDATA13 = (uint32_t)(SoilMoisture * 4095.0 / 100.0 + 0.5);
+
+  // run the thermistor equation from Thermistor.c backwards
+  TempC = MEAN_TEMP_C + TEMP_SWING_C *
+      sin(2.0 * M_PI * (double)(Now % TICKS_PER_DAY) / TICKS_PER_DAY);
+  TempC += T_CALIBRATE;
+  R_thermistor = R_25 / exp(BETA / 298.1 - BETA / (TempC + 273.1));
+  ADCDATA12 = (uint32_t)(4095.0 * R_thermistor / (R1 + R_thermistor) + 0.5);
+}
+
+// the benches link the host port without ADC_HAL.c, and never start a scan
+void __attribute__((weak)) ADC_EOS_ISR(void)
+{
+}
+
+/****************************************************************************
+ Function
+     HostSFR_ServiceADC
+
+ Parameters
+     None.
+
+ Returns
+     None.
+
+ Description
+     Completes a software triggered scan: clears GSWTRG, as the converter
+     does, feeds the readings to the oversampling filters and runs the end
+     of scan ISR
+ Notes
+     Called by the host port every time it polls for interrupts, so a scan
+     finishes after the service that started it has returned. The ISR may
+     trigger again at once, to fill the filters, so this loops until it
+     stops.
+****************************************************************************/
+void HostSFR_ServiceADC(void)
+{
+  while (ADCCON3bits.GSWTRG && ADCCON2bits.EOSIEN)
+  {
+    ADCCON3bits.GSWTRG = 0;
+    RunFilter(&ADCFLTR1bits, 0);
+    RunFilter(&ADCFLTR2bits, 1);
+    ADC_EOS_ISR();
+  }
+}
+
+/****************************************************************************
+ Function
+     HostSFR_GetSoilMoisture
+
+ Parameters
+     None.
+
+ Returns
+     double, the modelled soil moisture in percent
+
+ Description
+     Lets the simulation report how well the watering loop held the plant
+****************************************************************************/
+double HostSFR_GetSoilMoisture(void)
+{
+  return SoilMoisture;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     RunFilter
+
+ Parameters
+     volatile __ADCFLTRxbits_t *pFilter, the filter's register
+     uint8_t Which, the filter's index into the accumulators
+
+ Returns
+     None.
+
+ Description
+     One conversion's worth of an oversampling filter: accumulates the
+     reading of the chosen input, if it is in the scan list, and once
+     OVRSAM's worth are in, posts the result and sets AFRDY
+ Notes
+     OVRSAM 0 to 3 take 4, 16, 64 or 256 samples and keep 1 to 4 extra bits.
+     Only the two inputs the project scans are modelled.
+****************************************************************************/
+static void RunFilter(volatile __ADCFLTRxbits_t *pFilter, uint8_t Which)
+{
+  uint16_t Needed = 4U << (2 * pFilter->OVRSAM);
+  bool InScan = (pFilter->CHNLID == 12) ? ADCCSS1bits.CSS12 :
+      ADCCSS1bits.CSS13;
+
+  if (!pFilter->AFEN || !InScan)
+  {
+    return;
+  }
+  if (FilterCounts[Which] == 0)
+  {
+    pFilter->AFRDY = 0;
+  }
+  FilterSums[Which] += (pFilter->CHNLID == 12) ? ADCDATA12 : ADCDATA13;
+  if (++FilterCounts[Which] >= Needed)
+  {
+    pFilter->FLTRDATA = FilterSums[Which] >> (pFilter->OVRSAM + 1);
+    pFilter->AFRDY = 1;
+    FilterSums[Which] = 0;
+    FilterCounts[Which] = 0;
+  }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
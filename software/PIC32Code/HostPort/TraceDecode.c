@@ -0,0 +1,396 @@
+/****************************************************************************
+ Module
+     TraceDecode.c
+ Description
+     Turns a flight recorder dump (ES_TRACE, see ES_Trace.h) into Chrome
+     trace JSON, for chrome://tracing or ui.perfetto.dev.
+ Notes
+     usage: trace_decode [dumpfile] > trace.json
+     The input may be a raw capture of the terminal, text and all; the last
+     complete dump in it is decoded. Each service is a track with a slice for
+     every run function call, named for the event, and a batch call is one
+     slice. Each post is a zero length slice on the track of whoever posted
+     it, the running service, the timers or, outside ES_Run's dispatch, the
+     event checkers and interrupts, with a flow arrow to the call that took
+     the event. Posts and calls are paired by service, type and param,
+     oldest first. Times are microseconds from the first record.
+     Built with the same ES_Configure.h as the firmware, for the names.
+*****************************************************************************/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_Trace.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define HEADER_SIZE 10
+#define MAX_PENDING 64    // posts waiting to be matched, per service
+
+// tracks that are not services
+#define TID_TIMERS (ES_TRACE_NO_SERVICE + 1)
+#define TID_OTHER (ES_TRACE_NO_SERVICE + 2)
+
+#define Str(x) Str_(x)
+#define Str_(x) #x
+
+/*------------------------------ Module Types -----------------------------*/
+typedef struct
+{
+  double    Time;
+  uint8_t   Source;     // the track that posted it
+  uint8_t   EventType;
+  uint16_t  EventParam;
+  uint32_t  FlowId;
+}Pending_t;
+
+typedef struct
+{
+  Pending_t Posts[MAX_PENDING];
+  uint8_t   NumPosts;
+  bool      InCall;
+  uint8_t   NumEvents;    // in this call, more than 1 for a batch
+}Track_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint8_t *ReadAll(FILE *pFile, size_t *pSize);
+static const uint8_t *FindLastDump(const uint8_t *pData, size_t Size);
+static uint32_t GetWord(const uint8_t *pBytes, uint8_t NumBytes);
+static void Emit(const char *Format, ...);
+static const char *EventName(uint8_t EventType);
+static const char *ServiceName(uint8_t WhichService);
+static void AddPending(uint8_t WhichService, const Pending_t *pPost);
+static bool TakePending(uint8_t WhichService, uint8_t EventType,
+    uint16_t EventParam, Pending_t *pPost);
+
+/*---------------------------- Module Variables ---------------------------*/
+// keep in step with ES_EventType_t in ES_Configure.h
+static const char *const EventNames[] =
+{
+  "ES_NO_EVENT", "ES_ERROR", "ES_INIT", "ES_TIMEOUT", "ES_SHORT_TIMEOUT",
+  "ES_NEW_KEY", "ES_LOCK", "ES_UNLOCK", "EV_USER_BUTTON_UP",
+  "EV_USER_BUTTON_DOWN", "EV_USER_BUTTON_PRESSED", "EV_USER_BUTTON_RELEASED",
+  "EV_WATER_BUTTON_UP", "EV_WATER_BUTTON_DOWN", "EV_UPDATE_TEMP",
+  "EV_SPI1_TX_FINISHED", "EV_SPI1_RX_RECEIVED", "EV_SPI2_TX_FINISHED",
+  "EV_ADD_WATER", "EV_WATER_PRESS", "EV_BEGIN_UNIT_SELECT",
+  "EV_END_UNIT_SELECT", "EV_SEND_WIFI_THRESHOLD_UPDATE",
+  "EV_SEND_WIFI_UNIT_UPDATE", "EV_SEND_WIFI_MOISTURE_UPDATE",
+  "EV_SEND_WATER_LOW_UPDATE", "EV_ADC_COMPLETE", "EV_ADC_READING"
+};
+// a new event in ES_Configure.h needs its name added above
+ES_STATIC_ASSERT(sizeof(EventNames) / sizeof(EventNames[0]) == NUM_EVENT_TYPES,
+    EventNames_matches_ES_EventType_t);
+
+// the run function names stand in for the service names
+static const char *const ServiceNames[] =
+{
+  Str(SERV_0_RUN), Str(SERV_1_RUN), Str(SERV_2_RUN), Str(SERV_3_RUN),
+  Str(SERV_4_RUN), Str(SERV_5_RUN), Str(SERV_6_RUN), Str(SERV_7_RUN),
+  Str(SERV_8_RUN), Str(SERV_9_RUN), Str(SERV_10_RUN), Str(SERV_11_RUN),
+  Str(SERV_12_RUN), Str(SERV_13_RUN), Str(SERV_14_RUN), Str(SERV_15_RUN)
+};
+
+static Track_t  Tracks[NUM_SERVICES];
+static bool     FirstEmit = true;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+  FILE            *pFile = stdin;
+  uint8_t         *pData;
+  size_t          Size;
+  const uint8_t   *pDump;
+  const uint8_t   *pRecord;
+  uint16_t        Count;
+  uint16_t        CountsPerUs;
+  uint16_t        i;
+  uint32_t        Stamp;
+  uint32_t        LastStamp;
+  int64_t         Elapsed = 0;
+  double          Now = 0.0;
+  uint8_t         Kind;
+  uint8_t         Service;
+  uint8_t         EventType;
+  uint16_t        EventParam;
+  int             Running = -1;       // the service in a call, if any
+  bool            AfterTimeout = false;
+  uint32_t        NextFlowId = 1;
+  Pending_t       Post;
+
+  if (argc > 2)
+  {
+    fprintf(stderr, "usage: %s [dumpfile] > trace.json\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if ((argc == 2) && ((pFile = fopen(argv[1], "rb")) == NULL))
+  {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+  pData = ReadAll(pFile, &Size);
+  pDump = FindLastDump(pData, Size);
+  if (pDump == NULL)
+  {
+    fprintf(stderr, "no complete flight recorder dump found\n");
+    return EXIT_FAILURE;
+  }
+  Count       = (uint16_t)GetWord(pDump + 6, 2);
+  CountsPerUs = (uint16_t)GetWord(pDump + 8, 2);
+  if (CountsPerUs == 0)
+  {
+    CountsPerUs = 1;
+  }
+
+  printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  Emit("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+      "\"args\":{\"name\":\"ES_Run\"}}");
+  for (i = 0; i < NUM_SERVICES; i++)
+  {
+    Emit("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+        "\"args\":{\"name\":\"%u %s\"}}", i, i, ServiceName((uint8_t)i));
+  }
+  Emit("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+      "\"args\":{\"name\":\"timers\"}}", TID_TIMERS);
+  Emit("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+      "\"args\":{\"name\":\"event checkers and interrupts\"}}", TID_OTHER);
+
+  pRecord = pDump + HEADER_SIZE;
+  LastStamp = (Count > 0) ? GetWord(pRecord, 4) : 0;
+  for (i = 0; i < Count; i++, pRecord += ES_TRACE_RECORD_SIZE)
+  {
+    // the clock wraps, but records are never far apart, or far out of order
+    Stamp       = GetWord(pRecord, 4);
+    Elapsed    += (int32_t)(Stamp - LastStamp);
+    LastStamp   = Stamp;
+    Now         = (double)Elapsed / CountsPerUs;
+    EventParam  = (uint16_t)GetWord(pRecord + 4, 2);
+    EventType   = pRecord[6];
+    Kind        = pRecord[7] >> 6;
+    Service     = pRecord[7] & ES_TRACE_NO_SERVICE;
+
+    if ((Kind != ES_TRACE_TIMEOUT) && (Service >= NUM_SERVICES))
+    {
+      fprintf(stderr, "record %u names service %u, skipped\n", i, Service);
+      continue;
+    }
+    switch (Kind)
+    {
+      case ES_TRACE_POST:
+      {
+        Post.Time       = Now;
+        Post.Source     = AfterTimeout ? TID_TIMERS :
+                          (Running >= 0) ? (uint8_t)Running : TID_OTHER;
+        Post.EventType  = EventType;
+        Post.EventParam = EventParam;
+        Post.FlowId     = NextFlowId++;
+        AddPending(Service, &Post);
+        Emit("{\"name\":\"post %s\",\"cat\":\"post\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":0,\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"to\":\"%s\",\"param\":%u}}", EventName(EventType),
+            Now, Post.Source, ServiceName(Service), EventParam);
+        AfterTimeout = false;
+      }
+      break;
+
+      case ES_TRACE_START:
+      {
+        if ((Running >= 0) && (Running != Service))
+        { // the END was lost, close the call where the next one starts
+          Emit("{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", Now,
+              Running);
+          Tracks[Running].InCall = false;
+        }
+        if (!Tracks[Service].InCall)
+        {
+          Emit("{\"name\":\"%s\",\"cat\":\"dispatch\",\"ph\":\"B\","
+              "\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"param\":%u}}",
+              EventName(EventType), Now, Service, EventParam);
+          Tracks[Service].InCall    = true;
+          Tracks[Service].NumEvents = 0;
+        }
+        Tracks[Service].NumEvents++;
+        Running = Service;
+        if (TakePending(Service, EventType, EventParam, &Post))
+        {
+          Emit("{\"name\":\"post\",\"cat\":\"post\",\"ph\":\"s\","
+              "\"id\":%u,\"ts\":%.3f,\"pid\":1,\"tid\":%u}", Post.FlowId,
+              Post.Time, Post.Source);
+          Emit("{\"name\":\"post\",\"cat\":\"post\",\"ph\":\"f\","
+              "\"bp\":\"e\",\"id\":%u,\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+              Post.FlowId, Now, Service);
+        }
+        AfterTimeout = false;
+      }
+      break;
+
+      case ES_TRACE_END:
+      {
+        if (Tracks[Service].InCall)
+        {
+          Emit("{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+              "\"args\":{\"events\":%u}}", Now, Service,
+              Tracks[Service].NumEvents);
+          Tracks[Service].InCall = false;
+        }
+        Running = -1;
+        AfterTimeout = false;
+      }
+      break;
+
+      case ES_TRACE_TIMEOUT:
+      {
+        Emit("{\"name\":\"timer %u\",\"cat\":\"timer\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":0,\"pid\":1,\"tid\":%u}", EventParam, Now,
+            TID_TIMERS);
+        AfterTimeout = true;
+      }
+      break;
+    }
+  }
+  if (Running >= 0)
+  {
+    Emit("{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", Now, Running);
+  }
+  printf("\n]}\n");
+  fprintf(stderr, "%u records over %.3f ms\n", Count, Now / 1000.0);
+  free(pData);
+  return EXIT_SUCCESS;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static uint8_t *ReadAll(FILE *pFile, size_t *pSize)
+{
+  size_t  Capacity = 65536;
+  size_t  Size = 0;
+  size_t  NumRead;
+  uint8_t *pData = malloc(Capacity);
+
+  while ((pData != NULL) &&
+      ((NumRead = fread(pData + Size, 1, Capacity - Size, pFile)) > 0))
+  {
+    Size += NumRead;
+    if (Size == Capacity)
+    {
+      Capacity *= 2;
+      pData = realloc(pData, Capacity);
+    }
+  }
+  if (pData == NULL)
+  {
+    fprintf(stderr, "out of memory\n");
+    exit(EXIT_FAILURE);
+  }
+  *pSize = Size;
+  return pData;
+}
+
+// the start of the last header with all of its records after it
+static const uint8_t *FindLastDump(const uint8_t *pData, size_t Size)
+{
+  size_t Offset;
+  size_t Count;
+
+  for (Offset = Size; Offset-- > 0;)
+  {
+    if ((Size - Offset >= HEADER_SIZE) &&
+        (memcmp(pData + Offset, "ESTR", 4) == 0) &&
+        (pData[Offset + 4] == ES_TRACE_VERSION) &&
+        (pData[Offset + 5] == ES_TRACE_RECORD_SIZE))
+    {
+      Count = GetWord(pData + Offset + 6, 2);
+      if (Size - Offset - HEADER_SIZE >= Count * ES_TRACE_RECORD_SIZE)
+      {
+        return pData + Offset;
+      }
+    }
+  }
+  return NULL;
+}
+
+// little endian, as ES_TraceDump sends it
+static uint32_t GetWord(const uint8_t *pBytes, uint8_t NumBytes)
+{
+  uint32_t Word = 0;
+
+  while (NumBytes-- > 0)
+  {
+    Word = (Word << 8) | pBytes[NumBytes];
+  }
+  return Word;
+}
+
+// one element of the traceEvents array
+static void Emit(const char *Format, ...)
+{
+  va_list Args;
+
+  printf(FirstEmit ? "\n" : ",\n");
+  FirstEmit = false;
+  va_start(Args, Format);
+  vprintf(Format, Args);
+  va_end(Args);
+}
+
+static const char *EventName(uint8_t EventType)
+{
+  static char Unknown[16];
+
+  if (EventType < sizeof(EventNames) / sizeof(EventNames[0]))
+  {
+    return EventNames[EventType];
+  }
+  snprintf(Unknown, sizeof(Unknown), "event %u", EventType);
+  return Unknown;
+}
+
+static const char *ServiceName(uint8_t WhichService)
+{
+  static char Unknown[16];
+
+  if (WhichService < sizeof(ServiceNames) / sizeof(ServiceNames[0]))
+  {
+    return ServiceNames[WhichService] + 3; // past "Run"
+  }
+  snprintf(Unknown, sizeof(Unknown), "service %u", WhichService);
+  return Unknown;
+}
+
+// a full list forgets its oldest post, it was never going to be matched
+static void AddPending(uint8_t WhichService, const Pending_t *pPost)
+{
+  Track_t *pTrack = &Tracks[WhichService];
+
+  if (pTrack->NumPosts == MAX_PENDING)
+  {
+    memmove(&pTrack->Posts[0], &pTrack->Posts[1],
+        (MAX_PENDING - 1) * sizeof(Pending_t));
+    pTrack->NumPosts--;
+  }
+  pTrack->Posts[pTrack->NumPosts++] = *pPost;
+}
+
+// the oldest post of this event to this service, taken off the list
+static bool TakePending(uint8_t WhichService, uint8_t EventType,
+    uint16_t EventParam, Pending_t *pPost)
+{
+  Track_t *pTrack = &Tracks[WhichService];
+  uint8_t i;
+
+  for (i = 0; i < pTrack->NumPosts; i++)
+  {
+    if ((pTrack->Posts[i].EventType == EventType) &&
+        (pTrack->Posts[i].EventParam == EventParam))
+    {
+      *pPost = pTrack->Posts[i];
+      memmove(&pTrack->Posts[i], &pTrack->Posts[i + 1],
+          (pTrack->NumPosts - i - 1) * sizeof(Pending_t));
+      pTrack->NumPosts--;
+      return true;
+    }
+  }
+  return false;
+}
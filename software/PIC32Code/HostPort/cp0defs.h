@@ -0,0 +1,23 @@
+/****************************************************************************
+ Module
+     cp0defs.h (host port)
+ Description
+     Stand-in for the XC32 coprocessor 0 accessors. The core timer Count
+     register is derived from the host port's virtual clock so that code
+     which timestamps with _CP0_GET_COUNT() sees the same 20MHz rate that it
+     would on the PIC32.
+*****************************************************************************/
+#ifndef HOST_CP0DEFS_H
+#define HOST_CP0DEFS_H
+
+#include <stdint.h>
+
+uint32_t _HW_HostGetCoreCount(void);
+uint32_t _HW_HostGetCoreCompare(void);
+void _HW_HostSetCoreCompare(uint32_t Compare);
+
+#define _CP0_GET_COUNT()      _HW_HostGetCoreCount()
+#define _CP0_GET_COMPARE()    _HW_HostGetCoreCompare()
+#define _CP0_SET_COMPARE(val) _HW_HostSetCoreCompare(val)
+
+#endif /* HOST_CP0DEFS_H */
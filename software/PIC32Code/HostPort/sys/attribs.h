@@ -0,0 +1,14 @@
+/****************************************************************************
+ Module
+     sys/attribs.h (host port)
+ Description
+     Stand-in for the XC32 interrupt attribute macros. On the host an ISR is
+     just an ordinary function that the simulation calls directly.
+*****************************************************************************/
+#ifndef HOST_SYS_ATTRIBS_H
+#define HOST_SYS_ATTRIBS_H
+
+#define __ISR(v, ...)
+#define __ISR_AT_VECTOR(v, ...)
+
+#endif /* HOST_SYS_ATTRIBS_H */
@@ -0,0 +1,141 @@
+/****************************************************************************
+ Module
+   terminal.c (host port)
+
+ Revision
+   1.0.1
+
+ Description
+  Host replacement for the UART1 terminal module. Output goes straight to
+  stdout, input comes from keystrokes queued by the simulation.
+ Notes
+  On the host printf/puts/putchar already reach stdout, so there is no
+  transmit circular buffer to drain.
+ ***************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include <xc.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ES_General.h"
+#include "ES_Port.h"
+#include "ES_HostPort.h"
+
+//this module
+#include "terminal.h"
+/*----------------------------- Module Defines ----------------------------*/
+#define KEY_BUFFER_SIZE 64
+
+/*---------------------------- Module Variables ---------------------------*/
+static char KeyBuffer[KEY_BUFFER_SIZE];
+static uint8_t KeyHead;
+static uint8_t KeyTail;
+
+/*------------------------------ Module Code ------------------------------*/
+/*******************************************************************************
+ * Function: Terminal_HWInit
+ * Arguments: None
+ * Returns nothing
+ *
+ * Description: Nothing to set up on the host. Keys queued from the command
+ *              line before this runs are kept.
+ ******************************************************************************/
+void Terminal_HWInit(void)
+{
+  U1STAbits.URXDA = (KeyTail != KeyHead);
+}
+
+/*******************************************************************************
+ * Function: Terminal_ReadByte
+ * Arguments: None
+ * Returns byte
+ *
+ * Description: Returns the next queued keystroke, 0 if there is none
+ ******************************************************************************/
+uint8_t Terminal_ReadByte(void)
+{
+  uint8_t Key = 0;
+  if (KeyTail != KeyHead)
+  {
+    Key = (uint8_t)KeyBuffer[KeyTail];
+    KeyTail = (KeyTail + 1) % KEY_BUFFER_SIZE;
+  }
+  U1STAbits.URXDA = (KeyTail != KeyHead);
+  return Key;
+}
+
+/*******************************************************************************
+ * Function: Terminal_WriteByte
+ * Arguments: byte to write
+ * Returns nothing
+ *
+ * Description: Writes the byte to stdout
+ ******************************************************************************/
+void Terminal_WriteByte(uint8_t txByte)
+{
+  putchar(txByte);
+}
+
+/*******************************************************************************
+ * Function: Terminal_IsRxData
+ * Arguments: none
+ * Returns status
+ *
+ * Description: Returns true if there is a keystroke waiting
+ ******************************************************************************/
+bool Terminal_IsRxData(void)
+{
+  return U1STAbits.URXDA;
+}
+
+/*******************************************************************************
+ * Function: Terminal_MoveBuffer2UART
+ * Arguments: none
+ * Returns none
+ *
+ * Description: flushes stdout so real-time runs show output as it happens
+ ******************************************************************************/
+void Terminal_MoveBuffer2UART(void)
+{
+  fflush(stdout);
+}
+
+/*******************************************************************************
+ * Function: Terminal_IsTxPending
+ * Arguments: none
+ * Returns status
+ *
+ * Description: always false, stdout takes every byte as it is written
+ ******************************************************************************/
+bool Terminal_IsTxPending(void)
+{
+  return false;
+}
+
+/*******************************************************************************
+ * Function: Terminal_HostQueueKeys
+ * Arguments: Keys, the characters to deliver as keystrokes
+ * Returns none
+ *
+ * Description: queues keystrokes for Check4Keystroke to find, as though they
+ *              had arrived on UART1. Characters beyond the queue size are
+ *              dropped, the way an overrun UART would.
+ ******************************************************************************/
+void Terminal_HostQueueKeys(const char *Keys)
+{
+  size_t i;
+  for (i = 0; i < strlen(Keys); i++)
+  {
+    uint8_t Next = (KeyHead + 1) % KEY_BUFFER_SIZE;
+    if (Next == KeyTail)
+    {
+      break;
+    }
+    KeyBuffer[KeyHead] = Keys[i];
+    KeyHead = Next;
+  }
+  U1STAbits.URXDA = (KeyTail != KeyHead);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
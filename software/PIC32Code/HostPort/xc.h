@@ -0,0 +1,280 @@
+/****************************************************************************
+ Module
+     xc.h (host port)
+ Description
+     Stand-in for the XC32 device header when building the Events & Services
+     framework and the SmartPot services on a POSIX host. Every special
+     function register that the project touches is declared here as a plain
+     variable so that the unmodified service code compiles and runs.
+ Notes
+     Only the registers and bit fields that the project actually uses are
+     present. The set/clear/invert aliases (TRISASET, IFS0CLR, ...) are
+     separate variables; writing them has no effect on the base register.
+     The storage for all of these lives in HostSFR.c, which also presets the
+     status bits that the firmware busy-waits on (BGVRRDY, WKRDY7) so those
+     loops fall straight through. A software triggered ADC scan completes,
+     oversampling filters included, the next time the host port polls for
+     interrupts (HostSFR_ServiceADC).
+*****************************************************************************/
+#ifndef HOST_XC_H
+#define HOST_XC_H
+
+#include <stdint.h>
+
+/*------------------------- interrupt control ------------------------------*/
+// the XC32 builtins return the previous status register; the host port
+// models the global interrupt enable as a single flag (see ES_Port.c)
+unsigned int _HW_HostDisableInts(void);
+unsigned int _HW_HostEnableInts(void);
+#define __builtin_disable_interrupts() _HW_HostDisableInts()
+#define __builtin_enable_interrupts()  _HW_HostEnableInts()
+
+/*------------------------- interrupt vectors ------------------------------*/
+#define _CORE_TIMER_VECTOR  0
+#define _SPI1_RX_VECTOR     36
+#define _ADC_EOS_VECTOR     46
+
+/*------------------------- plain registers --------------------------------*/
+#define HOST_SFR(name) extern volatile uint32_t name
+
+// interrupt controller
+HOST_SFR(IFS0CLR);
+HOST_SFR(IFS1CLR);
+HOST_SFR(IFS1SET);
+HOST_SFR(IEC0CLR);
+HOST_SFR(IEC0SET);
+HOST_SFR(IEC1CLR);
+HOST_SFR(IEC1SET);
+HOST_SFR(IEC2CLR);
+HOST_SFR(IEC2SET);
+HOST_SFR(IFS2CLR);
+
+// ports
+HOST_SFR(TRISASET);
+HOST_SFR(TRISACLR);
+HOST_SFR(TRISBSET);
+HOST_SFR(TRISBCLR);
+HOST_SFR(TRISCSET);
+HOST_SFR(TRISCCLR);
+HOST_SFR(TRISDSET);
+HOST_SFR(TRISDCLR);
+HOST_SFR(ANSELASET);
+HOST_SFR(ANSELACLR);
+HOST_SFR(ANSELBSET);
+HOST_SFR(ANSELBCLR);
+HOST_SFR(ANSELCSET);
+HOST_SFR(ANSELCCLR);
+
+// peripheral pin select
+HOST_SFR(RPA0R);
+HOST_SFR(RPA7R);
+HOST_SFR(RPB5R);
+HOST_SFR(RPB6R);
+HOST_SFR(RPB14R);
+HOST_SFR(RPB15R);
+HOST_SFR(SDI1R);
+HOST_SFR(U1RXR);
+
+// UART1
+HOST_SFR(U1STA);
+HOST_SFR(U1BRG);
+HOST_SFR(U1TXREG);
+HOST_SFR(U1RXREG);
+
+// SPI1 & SPI2
+HOST_SFR(SPI1CON);
+HOST_SFR(SPI1CON2);
+HOST_SFR(SPI1BRG);
+HOST_SFR(SPI1BUF);
+HOST_SFR(SPI2CON);
+HOST_SFR(SPI2CON2);
+HOST_SFR(SPI2BRG);
+HOST_SFR(SPI2BUF);
+
+// ADC
+HOST_SFR(DEVADC0);
+HOST_SFR(DEVADC1);
+HOST_SFR(DEVADC7);
+HOST_SFR(ADC0CFG);
+HOST_SFR(ADC1CFG);
+HOST_SFR(ADC7CFG);
+HOST_SFR(ADCCON1);
+HOST_SFR(ADCCON2);
+HOST_SFR(ADCCON3);
+HOST_SFR(ADCANCON);
+HOST_SFR(ADCCSS1);
+HOST_SFR(ADCCSS2);
+HOST_SFR(ADCGIRQEN1);
+HOST_SFR(ADCGIRQEN2);
+HOST_SFR(ADCCMPCON1);
+HOST_SFR(ADCCMPCON2);
+HOST_SFR(ADCFLTR1);
+HOST_SFR(ADCFLTR2);
+HOST_SFR(ADCEIEN1);
+HOST_SFR(ADCEIEN2);
+HOST_SFR(ADCDATA12);
+HOST_SFR(ADCDATA13);
+
+/*------------------------- bit field registers ----------------------------*/
+typedef struct { unsigned MVEC:1; } __INTCONbits_t;
+extern volatile __INTCONbits_t INTCONbits;
+
+typedef struct { unsigned PRI7SS:4; } __PRISSbits_t;
+extern volatile __PRISSbits_t PRISSbits;
+
+typedef struct { unsigned CTIF:1; } __IFS0bits_t;
+extern volatile __IFS0bits_t IFS0bits;
+
+typedef struct { unsigned CTIE:1; } __IEC0bits_t;
+extern volatile __IEC0bits_t IEC0bits;
+
+typedef struct { unsigned CTIP:3; } __IPC0bits_t;
+extern volatile __IPC0bits_t IPC0bits;
+
+typedef struct { unsigned SPI1RXIP:3; } __IPC9bits_t;
+extern volatile __IPC9bits_t IPC9bits;
+
+typedef struct { unsigned ADCEOSIP:3; } __IPC11bits_t;
+extern volatile __IPC11bits_t IPC11bits;
+
+typedef struct { unsigned LATA0:1; unsigned LATA7:1; unsigned LATA12:1; }
+  __LATAbits_t;
+extern volatile __LATAbits_t LATAbits;
+
+typedef struct { unsigned LATB4:1; unsigned LATB9:1; unsigned LATB15:1; }
+  __LATBbits_t;
+extern volatile __LATBbits_t LATBbits;
+
+typedef struct { unsigned LATC6:1; unsigned LATC10:1; unsigned LATC12:1; }
+  __LATCbits_t;
+extern volatile __LATCbits_t LATCbits;
+
+typedef struct { unsigned RA11:1; } __PORTAbits_t;
+extern volatile __PORTAbits_t PORTAbits;
+
+typedef struct { unsigned RD8:1; } __PORTDbits_t;
+extern volatile __PORTDbits_t PORTDbits;
+
+typedef struct { unsigned TRISB15:1; } __TRISBbits_t;
+extern volatile __TRISBbits_t TRISBbits;
+
+typedef struct { unsigned ANSB15:1; } __ANSELBbits_t;
+extern volatile __ANSELBbits_t ANSELBbits;
+
+typedef struct { unsigned BRGH:1; unsigned ON:1; } __U1MODEbits_t;
+extern volatile __U1MODEbits_t U1MODEbits;
+
+typedef struct
+{
+  unsigned URXDA:1; unsigned OERR:1; unsigned FERR:1; unsigned UTXBF:1;
+  unsigned UTXEN:1; unsigned URXEN:1;
+} __U1STAbits_t;
+extern volatile __U1STAbits_t U1STAbits;
+
+typedef struct
+{
+  unsigned SRXISEL:2; unsigned STXISEL:2; unsigned DISSDI:1; unsigned MSTEN:1;
+  unsigned CKP:1; unsigned SMP:1; unsigned CKE:1; unsigned MODE16:1;
+  unsigned MODE32:1; unsigned DISSDO:1; unsigned ON:1; unsigned ENHBUF:1;
+  unsigned MCLKSEL:1; unsigned MSSEN:1;
+} __SPIxCONbits_t;
+extern volatile __SPIxCONbits_t SPI1CONbits;
+extern volatile __SPIxCONbits_t SPI2CONbits;
+
+typedef struct
+{
+  unsigned STRGSRC:5; unsigned SELRES:2; unsigned ON:1;
+} __ADCCON1bits_t;
+extern volatile __ADCCON1bits_t ADCCON1bits;
+
+typedef struct
+{
+  unsigned ADCDIV:7; unsigned SAMC:10; unsigned EOSIEN:1; unsigned REFFLT:1;
+  unsigned BGVRRDY:1;
+} __ADCCON2bits_t;
+extern volatile __ADCCON2bits_t ADCCON2bits;
+
+typedef struct
+{
+  unsigned CONCLKDIV:6; unsigned GSWTRG:1; unsigned DIGEN0:1;
+  unsigned DIGEN7:1; unsigned VREFSEL:3; unsigned ADCSEL:2;
+} __ADCCON3bits_t;
+extern volatile __ADCCON3bits_t ADCCON3bits;
+
+typedef struct
+{
+  unsigned ANEN0:1; unsigned ANEN7:1; unsigned WKRDY0:1; unsigned WKRDY7:1;
+  unsigned WKUPCLKCNT:4;
+} __ADCANCONbits_t;
+extern volatile __ADCANCONbits_t ADCANCONbits;
+
+typedef struct
+{
+  unsigned ADCDIV:7; unsigned SAMC:10; unsigned SELRES:2;
+} __ADCxTIMEbits_t;
+extern volatile __ADCxTIMEbits_t ADC0TIMEbits;
+
+typedef struct { unsigned SH0ALT:2; } __ADCTRGMODEbits_t;
+extern volatile __ADCTRGMODEbits_t ADCTRGMODEbits;
+
+typedef struct
+{
+  unsigned SIGN12:1; unsigned DIFF12:1; unsigned SIGN13:1; unsigned DIFF13:1;
+} __ADCIMCON1bits_t;
+extern volatile __ADCIMCON1bits_t ADCIMCON1bits;
+
+typedef struct { unsigned AGIEN12:1; unsigned AGIEN13:1; } __ADCGIRQEN1bits_t;
+extern volatile __ADCGIRQEN1bits_t ADCGIRQEN1bits;
+
+typedef struct { unsigned CSS12:1; unsigned CSS13:1; } __ADCCSS1bits_t;
+extern volatile __ADCCSS1bits_t ADCCSS1bits;
+
+typedef struct { unsigned TRGSRC12:5; unsigned TRGSRC13:5; } __ADCTRG4bits_t;
+extern volatile __ADCTRG4bits_t ADCTRG4bits;
+
+typedef struct
+{
+  unsigned FLTRDATA:16; unsigned CHNLID:5; unsigned AFRDY:1; unsigned OVRSAM:3;
+  unsigned DFMODE:1; unsigned AFEN:1;
+} __ADCFLTRxbits_t;
+extern volatile __ADCFLTRxbits_t ADCFLTR1bits;
+extern volatile __ADCFLTRxbits_t ADCFLTR2bits;
+
+/*------------------------- bit masks --------------------------------------*/
+#define _IFS0_CTIF_MASK       0x00000001
+#define _IFS1_SPI1RXIF_MASK   0x00000020
+#define _IEC1_SPI1RXIE_MASK   0x00000020
+#define _IFS1_ADCEOSIF_MASK   0x00004000
+#define _IEC1_ADCEOSIE_MASK   0x00004000
+
+#define _TRISA_TRISA0_MASK    0x00000001
+#define _TRISA_TRISA4_MASK    0x00000010
+#define _TRISA_TRISA7_MASK    0x00000080
+#define _TRISA_TRISA8_MASK    0x00000100
+#define _TRISA_TRISA11_MASK   0x00000800
+#define _TRISA_TRISA12_MASK   0x00001000
+#define _TRISB_TRISB4_MASK    0x00000010
+#define _TRISB_TRISB5_MASK    0x00000020
+#define _TRISB_TRISB6_MASK    0x00000040
+#define _TRISB_TRISB7_MASK    0x00000080
+#define _TRISB_TRISB9_MASK    0x00000200
+#define _TRISB_TRISB14_MASK   0x00004000
+#define _TRISB_TRISB15_MASK   0x00008000
+#define _TRISC_TRISC1_MASK    0x00000002
+#define _TRISC_TRISC6_MASK    0x00000040
+#define _TRISC_TRISC7_MASK    0x00000080
+#define _TRISC_TRISC10_MASK   0x00000400
+#define _TRISC_TRISC12_MASK   0x00001000
+#define _TRISD_TRISD8_MASK    0x00000100
+
+#define _ANSELA_ANSA0_MASK    0x00000001
+#define _ANSELA_ANSA4_MASK    0x00000010
+#define _ANSELA_ANSA8_MASK    0x00000100
+#define _ANSELA_ANSA11_MASK   0x00000800
+#define _ANSELA_ANSA12_MASK   0x00001000
+#define _ANSELB_ANSB7_MASK    0x00000080
+#define _ANSELB_ANSB9_MASK    0x00000200
+#define _ANSELC_ANSC1_MASK    0x00000002
+#define _ANSELC_ANSC10_MASK   0x00000400
+
+#endif /* HOST_XC_H */
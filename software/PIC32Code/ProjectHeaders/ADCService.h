@@ -0,0 +1,29 @@
+/****************************************************************************
+
+  Header file for the ADC sampling service
+
+ ****************************************************************************/
+
+#ifndef ADCService_H
+#define ADCService_H
+
+// Event Definitions
+#include "ES_Configure.h" /* gets us event definitions */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ADC_HAL.h"      /* gets the channel names */
+
+// EV_ADC_READING carries the channel in the top 4 bits of the EventParam
+// and the 12 bit reading in the rest
+#define ADC_READING_CHANNEL(Param) ((ADC_Channel_t)((Param) >> 12))
+#define ADC_READING_COUNTS(Param) ((uint16_t)((Param) & 0x0FFF))
+
+// Public Function Prototypes
+
+bool InitADCService(uint8_t Priority);
+bool PostADCService(ES_Event_t ThisEvent);
+ES_Event_t RunADCService(ES_Event_t ThisEvent);
+
+bool RequestADCReading(uint8_t WhichService, ADC_Channel_t WhichChannel);
+uint16_t GetADCDroppedReadings(void);
+
+#endif /* ADCService_H */
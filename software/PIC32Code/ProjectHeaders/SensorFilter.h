@@ -0,0 +1,37 @@
+/****************************************************************************
+
+  Header file for the sensor filters
+
+ ****************************************************************************/
+
+#ifndef SensorFilter_H
+#define SensorFilter_H
+
+#include "ES_Types.h"     /* gets bool and the fixed width types */
+
+// the longest median window, the sorting networks cover 3 and 5
+#define FILTER_MAX_MEDIAN 5
+
+// fraction bits carried by the running average
+#define FILTER_EMA_FRAC 8
+
+// one input channel: a median of the last MedianSize samples to knock out
+// spikes, followed by an exponential moving average to smooth what is left
+typedef struct
+{
+  uint16_t Window[FILTER_MAX_MEDIAN]; // the most recent samples
+  uint8_t Next;                       // where the next sample goes
+  uint8_t MedianSize;                 // 1 (no median), 3 or 5
+  uint8_t EmaShift;                   // each sample counts 1/2^EmaShift
+  bool Primed;                        // false until the first sample
+  uint32_t Average;                   // in counts << FILTER_EMA_FRAC
+} SensorFilter_t;
+
+// Public Function Prototypes
+
+void SensorFilter_Init(SensorFilter_t *pFilter, uint8_t MedianSize,
+    uint8_t EmaShift);
+void SensorFilter_Reset(SensorFilter_t *pFilter);
+uint16_t SensorFilter_Update(SensorFilter_t *pFilter, uint16_t Sample);
+
+#endif /* SensorFilter_H */
@@ -23,6 +23,15 @@ typedef enum
     Fahrenheit, Celsius
 } TemperatureUnit_t;
 
+// the payload of EV_UPDATE_TEMP, whose EventParam is an ES_Payload handle.
+// Receivers release it once they are done.
+typedef struct
+{
+    int16_t Temp;         // in the unit selected when it was read
+    int16_t CentiC;       // in hundredths of a degree C
+    uint16_t AdcCounts;   // the thermistor reading it came from
+} TempReading_t;
+
 // Public Function Prototypes
 
 bool InitTemperatureSM(uint8_t Priority);
@@ -0,0 +1,22 @@
+/****************************************************************************
+
+  Header file for the thermistor conversion
+
+ ****************************************************************************/
+
+#ifndef Thermistor_H
+#define Thermistor_H
+
+#include "ES_Types.h"     /* gets the fixed width types */
+
+// the thermistor and its divider, on AN12
+#define BETA 3892 // For thermistor equation
+#define R_25 10000 // 10k resistance at 25 C
+#define R1 10000 // Resistance of fixed resistor in voltage divider
+#define T_CALIBRATE 4
+
+// Public Function Prototypes
+
+int16_t Thermistor_CountsToCentiC(uint16_t Counts);
+
+#endif /* Thermistor_H */
@@ -23,6 +23,7 @@ typedef enum
 bool InitWiFiSM(uint8_t Priority);
 bool PostWiFiSM(ES_Event_t ThisEvent);
 ES_Event_t RunWiFiSM(ES_Event_t ThisEvent);
+ES_Event_t RunWiFiSMBatch(const ES_Event_t *pEvents, uint8_t NumEvents);
 WiFiState_t QueryTemplateSM(void);
 
 #endif /* WiFiFSM_H */
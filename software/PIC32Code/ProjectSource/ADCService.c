@@ -0,0 +1,303 @@
+/****************************************************************************
+ Module
+   ADCService.c
+
+ Revision
+   1.0.1
+
+ Description
+   Owns the ADC. Services ask it for a channel with RequestADCReading, it
+   gathers the requests that arrive close together into one scan of just
+   the channels asked for and posts each requester an EV_ADC_READING per
+   channel it wanted.
+
+ Notes
+   The thermistor is read every 500ms and the soil moisture sensor every
+   5s, on the same tick as one of the thermistor readings. Scanning only
+   what was asked for leaves the moisture input out of nine scans in ten,
+   and the batch window puts the tenth into the thermistor's scan instead
+   of starting a second one, so the ADC does about half the conversions it
+   did when every reading scanned both inputs.
+   This is the only service that calls InitADC and ADC_StartScan.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+/* include header files for this state machine as well as any machines at the
+   next lower level in the hierarchy that are sub-machines to this machine
+*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ADCService.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// ticks to wait after the first request for others to join the scan
+#define BATCH_WINDOW 1
+// only one scan is ever in flight, so one EV_ADC_COMPLETE at a time
+#define ISR_QUEUE_SIZE 2
+
+/*---------------------------- Module Functions ---------------------------*/
+/* prototypes for private functions for this service.They should be functions
+   relevant to the behavior of this service
+*/
+static void StartBatch(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+// with the introduction of Gen2, we need a module level Priority variable
+static uint8_t MyPriority;
+
+// one bit per service, for each channel: who has asked for the next scan
+// and who the running scan is for
+static uint64_t Pending[ADC_NUM_CHANNELS];
+static uint64_t InFlight[ADC_NUM_CHANNELS];
+static bool WindowOpen = false;
+static bool Scanning = false;
+// EV_ADC_READINGs that a requester's queue would not take
+static uint16_t DroppedReadings = 0;
+
+// filled by ADC_EOS_ISR without turning interrupts off
+static ES_Event_t ISRSlots[ISR_QUEUE_SIZE];
+static ES_SPSCQueue_t ISRQueue;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitADCService
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets up the queue the end of scan interrupt
+     posts to and configures the ADC
+ Notes
+
+****************************************************************************/
+bool InitADCService(uint8_t Priority)
+{
+  ES_Event_t ThisEvent;
+
+  MyPriority = Priority;
+
+  // the end of scan interrupt posts through its own queue, set it up before
+  // enabling it
+  if ((ES_SPSCInit(&ISRQueue, ISRSlots, ISR_QUEUE_SIZE) == false) ||
+      (ES_AttachISRQueue(MyPriority, &ISRQueue) == false))
+  {
+    return false;
+  }
+  InitADC();
+
+  // post the initial transition event
+  ThisEvent.EventType = ES_INIT;
+  if (ES_PostToService(MyPriority, ThisEvent) == true)
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+/****************************************************************************
+ Function
+     PostADCService
+
+ Parameters
+     EF_Event_t ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+****************************************************************************/
+bool PostADCService(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunADCService
+
+ Parameters
+   ES_Event_t : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   Starts a scan when the batch window closes and hands out the readings
+   when it completes
+ Notes
+   requests that come in while a scan runs go out in the next scan as soon
+   as this one is done, there is no point waiting for more
+****************************************************************************/
+ES_Event_t RunADCService(ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent;
+  ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+
+  switch (ThisEvent.EventType)
+  {
+    case ES_TIMEOUT:
+    {
+      WindowOpen = false;
+      if (Scanning == false)
+      {
+        StartBatch();
+      }
+    }
+    break;
+
+    case EV_ADC_COMPLETE:
+    {
+      uint8_t WhichChannel;
+
+      Scanning = false;
+      for (WhichChannel = 0; WhichChannel < ADC_NUM_CHANNELS; WhichChannel++)
+      {
+        uint64_t Requesters = InFlight[WhichChannel];
+        uint8_t WhichService;
+        ES_Event_t Reading = {EV_ADC_READING,
+            (uint16_t)((WhichChannel << 12) |
+            ADC_GetResult((ADC_Channel_t)WhichChannel))};
+
+        if ((ThisEvent.EventParam & ADC_CHANNEL_BIT(WhichChannel)) == 0)
+        {
+          continue;
+        }
+        InFlight[WhichChannel] = 0;
+        for (WhichService = 0; Requesters != 0;
+             WhichService++, Requesters >>= 1)
+        {
+          if ((Requesters & 1) &&
+              (ES_PostToService(WhichService, Reading) == false) &&
+              (DroppedReadings < UINT16_MAX))
+          {
+            DroppedReadings++;
+          }
+        }
+      }
+      if (WindowOpen == false)
+      {
+        StartBatch();
+      }
+    }
+    break;
+
+    default:
+      ;
+  }
+  return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     RequestADCReading
+
+ Parameters
+     uint8_t WhichService : the service to post the EV_ADC_READING to
+     ADC_Channel_t WhichChannel : the input it wants
+
+ Returns
+     bool : false if WhichService or WhichChannel does not exist
+
+ Description
+     Asks for a fresh reading of WhichChannel. It arrives as an
+     EV_ADC_READING; take it apart with ADC_READING_CHANNEL and
+     ADC_READING_COUNTS.
+ Notes
+     Asking twice before the reading arrives still gets only one event.
+     The reading is never from a scan that started before the request.
+****************************************************************************/
+bool RequestADCReading(uint8_t WhichService, ADC_Channel_t WhichChannel)
+{
+  if ((WhichService >= NUM_SERVICES) || (WhichChannel >= ADC_NUM_CHANNELS))
+  {
+    return false;
+  }
+  Pending[WhichChannel] |= 1ULL << WhichService;
+  if ((WindowOpen == false) && (Scanning == false))
+  {
+    WindowOpen = true;
+    ES_Timer_InitTimer(ADC_BATCH_TIMER, BATCH_WINDOW);
+  }
+  return true;
+}
+
+/****************************************************************************
+ Function
+     GetADCDroppedReadings
+
+ Parameters
+     None
+
+ Returns
+     uint16_t : the number of EV_ADC_READINGs that could not be posted
+
+ Description
+     Returns how many readings were lost to a full requester queue
+ Notes
+     stops counting at 65535
+****************************************************************************/
+uint16_t GetADCDroppedReadings(void)
+{
+  return DroppedReadings;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     StartBatch
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Starts one scan of every channel somebody is waiting for, if any
+ Notes
+     call only when no scan is running. If the ADC will not start, the
+     requests stay pending and the batch timer tries again a window later.
+****************************************************************************/
+static void StartBatch(void)
+{
+  uint8_t Channels = 0;
+  uint8_t WhichChannel;
+
+  for (WhichChannel = 0; WhichChannel < ADC_NUM_CHANNELS; WhichChannel++)
+  {
+    if (Pending[WhichChannel] != 0)
+    {
+      Channels |= ADC_CHANNEL_BIT(WhichChannel);
+    }
+  }
+  if (Channels == 0)
+  {
+    return;
+  }
+  if (ADC_StartScan(MyPriority, Channels) == false)
+  {
+    WindowOpen = true;
+    ES_Timer_InitTimer(ADC_BATCH_TIMER, BATCH_WINDOW);
+    return;
+  }
+  for (WhichChannel = 0; WhichChannel < ADC_NUM_CHANNELS; WhichChannel++)
+  {
+    InFlight[WhichChannel] = Pending[WhichChannel];
+    Pending[WhichChannel] = 0;
+  }
+  Scanning = true;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -92,6 +92,9 @@ bool InitDisplaySM(uint8_t Priority)
   MyPriority = Priority;
   // put us into the Initial PseudoState
   CurrentState = InitPState_Display;
+  // show every new reading
+  ES_ListSubscribe(TEMPERATURE_LIST, MyPriority);
+  ES_ListSubscribe(MOISTURE_LIST, MyPriority);
   
     ////////////////////// Set Up SPI2 /////////////////////////////////////////
   // SDO2 (RB15), SS2 (RB14), SCK2 (RA7) Digital Output
@@ -195,7 +198,11 @@ ES_Event_t RunDisplaySM(ES_Event_t ThisEvent)
         case EV_UPDATE_TEMP: 
         {         
           uint16_t Data2Send = 0;
-          uint16_t Digit2Send = ThisEvent.EventParam;
+          const TempReading_t *pReading = ES_PayloadGet(ThisEvent.EventParam);
+          if (pReading == NULL) {
+              break;
+          }
+          uint16_t Digit2Send = pReading->Temp;
           if (Digit2Send == CurrentTemp) {
               // Don't Need to do anything here
           } else {
@@ -533,6 +540,11 @@ ES_Event_t RunDisplaySM(ES_Event_t ThisEvent)
     default:
       ;
   }
+  // the temperature payload is released here, whatever state took it
+  if (ThisEvent.EventType == EV_UPDATE_TEMP)
+  {
+    ES_PayloadRelease(ThisEvent.EventParam);
+  }
   return ReturnEvent;
 }
 
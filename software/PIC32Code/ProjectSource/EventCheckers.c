@@ -22,7 +22,7 @@
 // this will pull in the symbolic definitions for events, which we will want
 // to post in response to detecting events
 #include "ES_Configure.h"
-// This gets us the prototype for ES_PostAll
+// This gets us the prototype for ES_Publish
 #include "ES_Framework.h"
 // this will get us the structure definition for events, which we will need
 // in order to post events in response to detecting events
@@ -53,7 +53,8 @@ static uint8_t WaterButtonStatus;
    bool: true if a new key was detected & posted
  Description
    checks to see if a new key from the keyboard is detected and, if so,
-   retrieves the key and posts an ES_NewKey event to TestHarnessService0
+   retrieves the key and publishes an ES_NewKey event to the services that
+   subscribe to it
  Notes
    The functions that actually check the serial hardware for characters
    and retrieve them are assumed to be in ES_Port.c
@@ -71,7 +72,7 @@ bool Check4Keystroke(void)
     ES_Event_t ThisEvent;
     ThisEvent.EventType   = ES_NEW_KEY;
     ThisEvent.EventParam  = GetNewKey();
-    ES_PostAll(ThisEvent);
+    ES_Publish(ThisEvent);
     return true;
   }
   return false;
@@ -0,0 +1,185 @@
+/****************************************************************************
+ Module
+   SensorFilter.c
+
+ Revision
+   1.0.1
+
+ Description
+   Cheap fixed point streaming filters for the analog inputs: a median of
+   the last 3 or 5 samples, done with a sorting network, feeding an
+   exponential moving average.
+
+ Notes
+   The median throws away single sample spikes that an average would only
+   smear, the average then takes out the remaining noise. Both run in a
+   handful of integer operations per sample, so they can be run on every
+   EV_ADC_READING.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "SensorFilter.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// one compare-exchange of a sorting network, leaves a <= b
+#define SORT2(a, b) do { if ((a) > (b)) { uint16_t Temp = (a); \
+    (a) = (b); (b) = Temp; } } while (0)
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t Median(const SensorFilter_t *pFilter);
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     SensorFilter_Init
+
+ Parameters
+     SensorFilter_t *pFilter : the filter to set up
+     uint8_t MedianSize : samples in the median window, 1, 3 or 5
+     uint8_t EmaShift : the average weighs each new sample 1/2^EmaShift
+
+ Returns
+     None
+
+ Description
+     Sets up a channel's filter, empty
+ Notes
+     any other MedianSize is taken as 1, no median
+****************************************************************************/
+void SensorFilter_Init(SensorFilter_t *pFilter, uint8_t MedianSize,
+    uint8_t EmaShift)
+{
+  if ((MedianSize != 3) && (MedianSize != 5))
+  {
+    MedianSize = 1;
+  }
+  pFilter->MedianSize = MedianSize;
+  pFilter->EmaShift = EmaShift;
+  SensorFilter_Reset(pFilter);
+}
+
+/****************************************************************************
+ Function
+     SensorFilter_Reset
+
+ Parameters
+     SensorFilter_t *pFilter : the filter to empty
+
+ Returns
+     None
+
+ Description
+     Forgets the history, the next sample is passed straight through
+ Notes
+     for when the quantity has been changed on purpose (the pump ran) and
+     the filter should not spend the next few samples catching up
+****************************************************************************/
+void SensorFilter_Reset(SensorFilter_t *pFilter)
+{
+  pFilter->Next = 0;
+  pFilter->Primed = false;
+}
+
+/****************************************************************************
+ Function
+     SensorFilter_Update
+
+ Parameters
+     SensorFilter_t *pFilter : the channel's filter
+     uint16_t Sample : the new reading
+
+ Returns
+     uint16_t : the filtered reading, in the same units as Sample
+
+ Description
+     Adds Sample to the median window and the median to the average
+ Notes
+     the first sample after Init or Reset fills the window and the average,
+     so there is no start up ramp from 0
+****************************************************************************/
+uint16_t SensorFilter_Update(SensorFilter_t *pFilter, uint16_t Sample)
+{
+  uint32_t Target;
+  uint8_t i;
+
+  if (pFilter->Primed == false)
+  {
+    for (i = 0; i < pFilter->MedianSize; i++)
+    {
+      pFilter->Window[i] = Sample;
+    }
+    pFilter->Average = (uint32_t)Sample << FILTER_EMA_FRAC;
+    pFilter->Primed = true;
+    return Sample;
+  }
+
+  pFilter->Window[pFilter->Next] = Sample;
+  if (++pFilter->Next >= pFilter->MedianSize)
+  {
+    pFilter->Next = 0;
+  }
+
+  Target = (uint32_t)Median(pFilter) << FILTER_EMA_FRAC;
+  // move 1/2^EmaShift of the way to the new median
+  if (Target >= pFilter->Average)
+  {
+    pFilter->Average += (Target - pFilter->Average) >> pFilter->EmaShift;
+  }
+  else
+  {
+    pFilter->Average -= (pFilter->Average - Target) >> pFilter->EmaShift;
+  }
+  return (uint16_t)((pFilter->Average + (1UL << (FILTER_EMA_FRAC - 1))) >>
+         FILTER_EMA_FRAC);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     Median
+
+ Parameters
+     const SensorFilter_t *pFilter : the filter whose window to use
+
+ Returns
+     uint16_t : the median of the window
+
+ Description
+     Runs the shortest known median network for the window size on a copy
+     of the window, 3 compare-exchanges for 3 samples and 7 for 5
+ Notes
+     the networks are from Devillard, "Fast median search: an ANSI C
+     implementation", 1998
+****************************************************************************/
+static uint16_t Median(const SensorFilter_t *pFilter)
+{
+  uint16_t p[FILTER_MAX_MEDIAN];
+  uint8_t i;
+
+  for (i = 0; i < pFilter->MedianSize; i++)
+  {
+    p[i] = pFilter->Window[i];
+  }
+  switch (pFilter->MedianSize)
+  {
+    case 3:
+    {
+      SORT2(p[0], p[1]); SORT2(p[1], p[2]); SORT2(p[0], p[1]);
+      return p[1];
+    }
+
+    case 5:
+    {
+      SORT2(p[0], p[1]); SORT2(p[3], p[4]); SORT2(p[0], p[3]);
+      SORT2(p[1], p[4]); SORT2(p[1], p[2]); SORT2(p[2], p[3]);
+      SORT2(p[1], p[2]);
+      return p[2];
+    }
+
+    default:
+      return p[0];
+  }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -18,7 +18,8 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "SoilMoistureSM.h"
-#include "ADC_HAL.h"
+#include "ADCService.h"
+#include "SensorFilter.h"
 #include "PumpSM.h"
 #include "dbprintf.h"
 #include "WiFiSM.h"
@@ -27,9 +28,14 @@
 /*----------------------------- Module Defines ----------------------------*/
 #define MEASURE_TIME 4500
 #define WAIT_TIME   500
+// sensor on to sensor on, the periodic SOIL_MOISTURE_TIMER
+#define MEASURE_PERIOD (WAIT_TIME + MEASURE_TIME)
 #define LOW_THRESHOLD 20
 #define HIGH_THRESHOLD 30
 #define WATERING_TIMEOUT 10000
+// readings are MEASURE_PERIOD apart, a lone bad one must not start the pump
+#define MOISTURE_MEDIAN 3
+#define MOISTURE_EMA_SHIFT 1
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
@@ -39,9 +45,9 @@
 // everybody needs a state variable, you may need others as well.
 // type of state variable should match that of enum in header file
 static SoilMoistureState_t CurrentState;
-static uint16_t ADC_Results[2];
 static uint16_t Threshold;
 static uint16_t CurrentSoilMoisture;
+static SensorFilter_t MoistureFilter;
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
@@ -89,7 +95,7 @@ bool InitSoilMoistureSM(uint8_t Priority)
   TRISASET = _TRISA_TRISA4_MASK;
   ANSELASET = _ANSELA_ANSA4_MASK;
   
-  InitADC(); // Initialize the ADC
+  SensorFilter_Init(&MoistureFilter, MOISTURE_MEDIAN, MOISTURE_EMA_SHIFT);
   
   Threshold = LOW_THRESHOLD; // Start with the low threshold
   
@@ -153,7 +159,8 @@ ES_Event_t RunSoilMoistureSM(ES_Event_t ThisEvent)
       {
         CurrentState = SoilMoistureMeasuring;
         LATBbits.LATB4 = 1; // Activate the sensor
-        ES_Timer_InitTimer(SOIL_MOISTURE_TIMER, WAIT_TIME); // Wait a bit before reading the measurement
+        ES_Timer_InitTimer(SOIL_MOISTURE_SETTLE_TIMER, WAIT_TIME); // Wait a bit before reading the measurement
+        ES_Timer_InitPeriodic(SOIL_MOISTURE_TIMER, MEASURE_PERIOD); // and measure again every period
       }
     }
     break;
@@ -164,9 +171,12 @@ ES_Event_t RunSoilMoistureSM(ES_Event_t ThisEvent)
       {
         case ES_TIMEOUT:
         {  
-          LATBbits.LATB4 = 1; // Activate the sensor
-          ES_Timer_InitTimer(SOIL_MOISTURE_TIMER, WAIT_TIME); // Wait a bit before reading the measurement
-          CurrentState = SoilMoistureMeasuring;  
+          if (ThisEvent.EventParam == SOIL_MOISTURE_TIMER)
+          {
+            LATBbits.LATB4 = 1; // Activate the sensor
+            ES_Timer_InitTimer(SOIL_MOISTURE_SETTLE_TIMER, WAIT_TIME); // Wait a bit before reading the measurement
+            CurrentState = SoilMoistureMeasuring;  
+          }
         }
         break;
 
@@ -182,29 +192,45 @@ ES_Event_t RunSoilMoistureSM(ES_Event_t ThisEvent)
       {
         case ES_TIMEOUT:
         {  
-          ReadADC(ADC_Results); // Read the sensor
+          if (ThisEvent.EventParam == SOIL_MOISTURE_SETTLE_TIMER)
+          {
+            RequestADCReading(MyPriority, ADC_SOIL_MOISTURE); // Read the sensor
+          }
+          else if (ThisEvent.EventParam == SOIL_MOISTURE_TIMER)
+          {
+            // a whole period and still no reading, it was lost on the way,
+            // the sensor is still on so just ask again
+            RequestADCReading(MyPriority, ADC_SOIL_MOISTURE);
+          }
+        }
+        break;
+
+        case EV_ADC_READING:
+        {  
+          uint16_t Reading = SensorFilter_Update(&MoistureFilter,
+              ADC_READING_COUNTS(ThisEvent.EventParam));
           LATBbits.LATB4 = 0; // Turn off sensor
           
-//          DB_printf("Soil Moisture: %d\r\n", ADC_Results[1]);
-          uint8_t soil_moisture_percent = ADC_Results[1] * 100 / 4095;
+//          DB_printf("Soil Moisture: %d\r\n", Reading);
+          uint8_t soil_moisture_percent = Reading * 100 / 4095;
 //          DB_printf("Soil Moisture Percent: %d%%\r\n",  soil_moisture_percent);
           
           CurrentSoilMoisture = soil_moisture_percent;
           
           ES_Event_t NewEvent1 = {EV_SEND_WIFI_MOISTURE_UPDATE, soil_moisture_percent};
-          PostWiFiSM(NewEvent1);
-          PostDisplaySM(NewEvent1);
+          ES_ListPost(MOISTURE_LIST, NewEvent1);
           
           if (soil_moisture_percent < Threshold  && soil_moisture_percent >= 5) {
               // percent < 5%  indicates probes not in pot
               ES_Event_t NewEvent = {EV_ADD_WATER, 2000};
               PostPumpSM(NewEvent);
               DB_printf("Hit Threshold: Begin Pumping\r\n");
+              // the pump changes the soil on purpose, start over from the
+              // next reading instead of averaging it with this one
+              SensorFilter_Reset(&MoistureFilter);
         
           } 
           CurrentState = SoilMoistureWaiting;
-     
-          ES_Timer_InitTimer(SOIL_MOISTURE_TIMER, MEASURE_TIME); // Set timer to measure again     
         }
         break;
 
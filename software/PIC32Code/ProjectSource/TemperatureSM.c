@@ -18,32 +18,34 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "TemperatureSM.h"
-#include "ADC_HAL.h"
+#include "ADCService.h"
+#include "SensorFilter.h"
 #include "DisplaySM.h"
 #include "dbprintf.h"
 #include "WiFiSM.h"
-#include <math.h>
+#include "Thermistor.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 #define UPDATE_TIME 500
-#define BETA 3892 // For thermistor equation
-#define R_25 10000 // 10k resistance at 25 C
-#define R1 10000 // Resistance of fixed resistor in voltage divider
-#define T_CALIBRATE 4
+// readings are 500ms apart, so this smooths over about 2 seconds
+#define THERMISTOR_MEDIAN 5
+#define THERMISTOR_EMA_SHIFT 2
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
-static int16_t VoltageToTemperature(uint16_t Reading);
+static int16_t ToTempUnit(int16_t CentiC);
+static void PublishTemperature(int16_t CentiC, bool ToWiFi);
 
 /*---------------------------- Module Variables ---------------------------*/
 // everybody needs a state variable, you may need others as well.
 // type of state variable should match htat of enum in header file
 static TemperatureState_t CurrentState;
-static uint16_t ADC_Results[2];
+static uint16_t ThermistorCounts;
+static SensorFilter_t ThermistorFilter;
 static TemperatureUnit_t TempUnit = Celsius;
-static uint16_t CurrentTemp = 0;
+static int16_t CurrentCentiC = 0;
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
@@ -77,13 +79,8 @@ bool InitTemperatureSM(uint8_t Priority)
   TRISASET = _TRISA_TRISA8_MASK;  // input
   ANSELASET = _ANSELA_ANSA8_MASK; // analog
   
-  InitADC(); // Initialize the ADC
-  ReadADC(ADC_Results);
- 
-  // Get the initial temperature and send to the display
-  int16_t Temp = VoltageToTemperature(ADC_Results[0]);
-  ES_Event_t NewEvent = {EV_UPDATE_TEMP, Temp};
-  PostDisplaySM(NewEvent);
+  SensorFilter_Init(&ThermistorFilter, THERMISTOR_MEDIAN,
+      THERMISTOR_EMA_SHIFT);
   
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
@@ -143,8 +140,22 @@ ES_Event_t RunTemperatureSM(ES_Event_t ThisEvent)
     {
       if (ThisEvent.EventType == ES_INIT)
       {
+        // Get the initial temperature, now that every service has been
+        // initialized and can take a post. The timer starts now rather than
+        // on the reading so that its timeouts land on the same ticks as
+        // SoilMoistureSM's and the two share a scan.
+        RequestADCReading(MyPriority, ADC_THERMISTOR);
+        ES_Timer_InitPeriodic(TEMPERATURE_UPDATE_TIMER, UPDATE_TIME);
+      }
+      else if (ThisEvent.EventType == EV_ADC_READING)
+      {
+        // and send it to the display
+        ThermistorCounts = SensorFilter_Update(&ThermistorFilter,
+            ADC_READING_COUNTS(ThisEvent.EventParam));
+        CurrentCentiC = Thermistor_CountsToCentiC(ThermistorCounts);
+        PublishTemperature(CurrentCentiC, false);
+        
         CurrentState = PublishingTemp;
-        ES_Timer_InitTimer(TEMPERATURE_UPDATE_TIMER, UPDATE_TIME);
       }
     }
     break;
@@ -155,17 +166,19 @@ ES_Event_t RunTemperatureSM(ES_Event_t ThisEvent)
       {
         case ES_TIMEOUT:
         {
-            ReadADC(ADC_Results);
+            RequestADCReading(MyPriority, ADC_THERMISTOR);
+        }
+        break;
+        
+        case EV_ADC_READING:
+        {
+            ThermistorCounts = SensorFilter_Update(&ThermistorFilter,
+            ADC_READING_COUNTS(ThisEvent.EventParam));
  
             // Get the temperature and send to the display
-            int16_t Temp = VoltageToTemperature(ADC_Results[0]);
-            ES_Event_t NewEvent = {EV_UPDATE_TEMP, Temp};
-            PostDisplaySM(NewEvent);
-            PostWiFiSM(NewEvent);
-            
-            CurrentTemp = Temp;
-//            DB_printf("Temperature: %d\r\n", Temp);
-            ES_Timer_InitTimer(TEMPERATURE_UPDATE_TIMER, UPDATE_TIME);
+            CurrentCentiC = Thermistor_CountsToCentiC(ThermistorCounts);
+            PublishTemperature(CurrentCentiC, true);
+//            DB_printf("Temperature: %d\r\n", CurrentCentiC);
         }
         break;
         
@@ -189,17 +202,9 @@ ES_Event_t RunTemperatureSM(ES_Event_t ThisEvent)
         {
             CurrentState = PublishingTemp;
             
-            ReadADC(ADC_Results);
- 
-            // Get the temperature and send to the display
-            int16_t Temp = VoltageToTemperature(ADC_Results[0]);
-            ES_Event_t NewEvent = {EV_UPDATE_TEMP, Temp};
-            PostDisplaySM(NewEvent);
-            PostWiFiSM(NewEvent);
-            
-            CurrentTemp = Temp;
-//            DB_printf("Temperature: %d\r\n", Temp);
-            ES_Timer_InitTimer(TEMPERATURE_UPDATE_TIMER, UPDATE_TIME);
+            // the reading is published when it arrives
+            RequestADCReading(MyPriority, ADC_THERMISTOR);
+            ES_Timer_InitPeriodic(TEMPERATURE_UPDATE_TIMER, UPDATE_TIME);
         }
         break;
 
@@ -273,13 +278,14 @@ void SetTemperatureUnit(uint8_t unit)
      uint16_t: the stored current temperature
 
  Description
-     Returns the latest stored temperature
+     Returns the latest stored temperature, in whole degrees of the
+     current unit
  Notes
-
+     converted here, so a unit change shows up without a new reading
 ****************************************************************************/
 uint16_t GetCurrentTemp(void)
 {
-    return CurrentTemp;
+    return ToTempUnit(CurrentCentiC);
 }
 
 /****************************************************************************
@@ -303,19 +309,74 @@ TemperatureUnit_t GetTempUnit(void) {
 /***************************************************************************
  private functions
  ***************************************************************************/
-static int16_t VoltageToTemperature(uint16_t Reading)
+/****************************************************************************
+ Function
+     ToTempUnit
+
+ Parameters
+     int16_t CentiC : a temperature in hundredths of a degree C
+
+ Returns
+     int16_t : the same temperature in whole degrees of the current unit
+
+ Description
+     Converts a reading for display, rounding half away from zero
+ Notes
+     integer only, the readings stay in C until they are shown
+****************************************************************************/
+static int16_t ToTempUnit(int16_t CentiC)
 {
-//    DB_printf("Reading: %d\r\n", Reading);
-    double V_out = (double)Reading / 4095 * 3.3; // Calculate voltage corresponding to ADC reading
-    double R_thermistor = R1 / (3.3 - V_out) * V_out;
-    double T = BETA / (BETA/298.1 - log(R_25 / R_thermistor))-273.1; // In celsius
-    
-    T = T-T_CALIBRATE;
-    
-    // Convert to fahrenheit if needed
+    int32_t Centi = CentiC;
+
     if (TempUnit == Fahrenheit) {
-        T = T * 9 / 5 + 32;
+        Centi = Centi * 9 / 5 + 3200;
     }
-    
-    return roundf(T);
-}
\ No newline at end of file
+    if (Centi >= 0) {
+        return (int16_t)((Centi + 50) / 100);
+    }
+    return (int16_t)((Centi - 50) / 100);
+}
+
+/****************************************************************************
+ Function
+     PublishTemperature
+
+ Parameters
+     int16_t CentiC : the new temperature, in hundredths of a degree C
+     bool ToWiFi : false to send it to the display only, true to send it to
+                   everyone on TEMPERATURE_LIST (the display and WiFi)
+
+ Returns
+     None
+
+ Description
+     posts EV_UPDATE_TEMP with a TempReading_t payload, one shared block
+     for every receiver
+ Notes
+     takes a reference for each post that lands, then drops our own. If the
+     pool is empty this update is skipped, the next one is 500ms away.
+****************************************************************************/
+static void PublishTemperature(int16_t CentiC, bool ToWiFi)
+{
+    uint16_t Handle = ES_PayloadAlloc();
+    TempReading_t *pReading = ES_PayloadGet(Handle);
+    ES_Event_t NewEvent = {EV_UPDATE_TEMP, Handle};
+    uint8_t NumTaken = 0;
+
+    if (pReading == NULL) {
+        return;
+    }
+    pReading->Temp = ToTempUnit(CentiC);
+    pReading->CentiC = CentiC;
+    pReading->AdcCounts = ThermistorCounts;
+
+    if (ToWiFi) {
+        NumTaken = ES_ListPost(TEMPERATURE_LIST, NewEvent);
+    } else if (PostDisplaySM(NewEvent)) {
+        NumTaken = 1;
+    }
+    while (NumTaken-- > 0) {
+        ES_PayloadRetain(Handle);
+    }
+    ES_PayloadRelease(Handle);
+}
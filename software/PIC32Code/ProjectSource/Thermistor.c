@@ -0,0 +1,121 @@
+/****************************************************************************
+ Module
+   Thermistor.c
+
+ Revision
+   1.0.1
+
+ Description
+   Converts thermistor ADC readings to hundredths of a degree Celsius with
+   a lookup table and linear interpolation, no floating point at run time.
+
+ Notes
+   The table is worked out by the compiler from BETA, R_25, R1 and
+   T_CALIBRATE in Thermistor.h, using the same beta equation TemperatureSM
+   used to run on every sample. Change the part and the table follows.
+   With a point every 32 counts, interpolation stays within 0.03 C of the
+   equation from -20 C to 80 C and within 0.1 C from -40 C to 100 C.
+   HostPort/Bench/BenchThermistor.c checks this against the equation and
+   times both.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "Thermistor.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define ADC_FULL_SCALE 4095
+
+// a table point every 2^STEP_BITS counts, both ends included
+#define STEP_BITS 5
+#define STEP (1 << STEP_BITS)
+#define TABLE_SIZE ((ADC_FULL_SCALE + 1) / STEP + 1)
+
+// natural log as a constant expression, so it can fill a static table.
+// x = m 2^k with m in [1/sqrt(2), sqrt(2)), then ln(m) = 2 atanh(z) with
+// z = (m - 1)/(m + 1), |z| < 0.172, and the series to z^7 is good to 4e-8
+#define LN_2 0.69314718055994531
+#define SQRT_2 1.41421356237309505
+#define LN_Z2(z) ((z) * (z))
+#define LN_SERIES(z) (2.0 * (z) * (1.0 + LN_Z2(z) * (1.0 / 3 +              \
+    LN_Z2(z) * (1.0 / 5 + LN_Z2(z) / 7))))
+#define LN_M(m) LN_SERIES(((m) - 1.0) / ((m) + 1.0))
+#define LN_POW2(x, k) (LN_M((x) / (double)(1UL << (k))) + (k) * LN_2)
+#define ABOVE(x, k) ((x) >= (double)(1UL << (k)) / SQRT_2)
+// for x in [1, 4096)
+#define LN_12(x) (ABOVE(x, 12) ? LN_POW2(x, 12) :                            \
+    ABOVE(x, 11) ? LN_POW2(x, 11) : ABOVE(x, 10) ? LN_POW2(x, 10) :          \
+    ABOVE(x, 9) ? LN_POW2(x, 9) : ABOVE(x, 8) ? LN_POW2(x, 8) :              \
+    ABOVE(x, 7) ? LN_POW2(x, 7) : ABOVE(x, 6) ? LN_POW2(x, 6) :              \
+    ABOVE(x, 5) ? LN_POW2(x, 5) : ABOVE(x, 4) ? LN_POW2(x, 4) :              \
+    ABOVE(x, 3) ? LN_POW2(x, 3) : ABOVE(x, 2) ? LN_POW2(x, 2) :              \
+    ABOVE(x, 1) ? LN_POW2(x, 1) : LN_POW2(x, 0))
+// for x in [1, 16), and for x in (1/16, 16)
+#define LN_4(x) (ABOVE(x, 4) ? LN_POW2(x, 4) : ABOVE(x, 3) ? LN_POW2(x, 3) :  \
+    ABOVE(x, 2) ? LN_POW2(x, 2) : ABOVE(x, 1) ? LN_POW2(x, 1) : LN_POW2(x, 0))
+#define LN_RATIO(x) ((x) >= 1.0 ? LN_4(x) : -LN_4(1.0 / (x)))
+
+#if (R1 >= 16 * R_25) || (R_25 >= 16 * R1)
+#error the table needs R1 within a factor of 16 of R_25
+#endif
+
+// the beta equation: R_thermistor = R1 * Counts / (4095 - Counts), so
+// T = BETA / (BETA / 298.1 + ln(R_thermistor / R_25)) - 273.1 - T_CALIBRATE
+#define LN_R_RATIO(c) (LN_12(c) - LN_12(ADC_FULL_SCALE - (c)) +              \
+    LN_RATIO((double)R1 / R_25))
+#define CENTI_C(c) (100.0 * ((double)BETA / ((double)BETA / 298.1 +          \
+    LN_R_RATIO(c)) - 273.1 - T_CALIBRATE))
+
+// rounded to the nearest hundredth, the offset keeps the cast a floor
+#define POINT_AT(c) ((int16_t)((int32_t)(CENTI_C(c) + 32768.5) - 32768))
+#define POINT(k) POINT_AT((k) * STEP)
+#define POINTS8(k) POINT(k), POINT(k + 1), POINT(k + 2), POINT(k + 3),      \
+    POINT(k + 4), POINT(k + 5), POINT(k + 6), POINT(k + 7)
+
+/*---------------------------- Module Variables ---------------------------*/
+// hundredths of a degree C at Counts = 0, 32, 64 ... 4096. The equation
+// runs off to infinity at 0 and full scale, so the end points are taken
+// half a step in. Readings out there are not a temperature anyway.
+static const int16_t CentiC[TABLE_SIZE] =
+{
+  POINT_AT(STEP / 2), POINT(1), POINT(2), POINT(3), POINT(4), POINT(5),
+  POINT(6), POINT(7), POINTS8(8), POINTS8(16), POINTS8(24), POINTS8(32),
+  POINTS8(40), POINTS8(48), POINTS8(56), POINTS8(64), POINTS8(72),
+  POINTS8(80), POINTS8(88), POINTS8(96), POINTS8(104), POINTS8(112),
+  POINTS8(120), POINT_AT(ADC_FULL_SCALE - STEP / 2)
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     Thermistor_CountsToCentiC
+
+ Parameters
+     uint16_t Counts : a 12 bit reading of the thermistor divider
+
+ Returns
+     int16_t : the temperature in hundredths of a degree C, calibrated
+
+ Description
+     Looks up the two table points either side of Counts and interpolates
+     between them
+ Notes
+     readings above full scale are taken as full scale
+****************************************************************************/
+int16_t Thermistor_CountsToCentiC(uint16_t Counts)
+{
+  uint16_t Index;
+  int32_t Low;
+  int32_t Rise;
+
+  if (Counts > ADC_FULL_SCALE)
+  {
+    Counts = ADC_FULL_SCALE;
+  }
+  Index = Counts >> STEP_BITS;
+  Low = CentiC[Index];
+  Rise = (CentiC[Index + 1] - Low) * (int32_t)(Counts & (STEP - 1));
+  // rounded to the nearest hundredth, whichever way the table slopes
+  Rise += (Rise < 0) ? -(STEP / 2) : (STEP / 2);
+  return (int16_t)(Low + Rise / STEP);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
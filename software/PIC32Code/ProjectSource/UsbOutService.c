@@ -46,12 +46,16 @@
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static void DrawStatus(void);
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 static uint8_t MyPriority;
 // add a deferral queue for up to 3 pending deferrals +1 to allow for overhead
 static ES_Event_t DeferralQueue[3 + 1];
+// a dump (queue stats, run times...) is on screen, leave it there until the
+// next key rather than clearing it at the next redraw
+static bool ShowingDump = false;
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -85,6 +89,16 @@ bool InitUsbOutService(uint8_t Priority)
   DB_printf( "Press 'c' to switch to Celsius \n\r");
   DB_printf( "Press 'w' to water the plant \n\r");
   DB_printf( "Press 't' to switch water level threshold \n\r");
+  DB_printf( "Press 'q' to show event queue statistics \n\r");
+#ifdef ES_PROFILE
+  DB_printf( "Press 'p' to show service run times \n\r");
+#endif
+#ifdef ES_TRACE
+  DB_printf( "Press 'r' to dump the event recorder \n\r");
+#endif
+#ifdef ES_RUN_BUDGET
+  DB_printf( "Press 'o' to show run budget overruns \n\r");
+#endif
 
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
@@ -142,42 +156,16 @@ ES_Event_t RunUsbOutService(ES_Event_t ThisEvent)
   {
     case ES_INIT:
     {
-        ES_Timer_InitTimer(USB_UPDATE_TIMER, TWO_SEC);
+        ES_Timer_InitPeriodic(USB_UPDATE_TIMER, TWO_SEC);
     }
     break;
     
-    case ES_TIMEOUT:   // re-start timer & announce
+    case ES_TIMEOUT:   // announce, the timer reloads itself
     {
-        ES_Timer_InitTimer(USB_UPDATE_TIMER, TWO_SEC);
-        clrScrn();
-        puts("\rSmart Pot, Matthew Sato, EE256 Final Project \r");
-        DB_printf( "\n\r\n");
-        DB_printf( "Press 'f' to switch to Fahrenheit \n\r");
-        DB_printf( "Press 'c' to switch to Celsius \n\r");
-        DB_printf( "Press 'w' to water the plant \n\r");
-        DB_printf( "Press 't' to switch water level threshold \n\r");
-        
-        TemperatureUnit_t TempUnit = GetTempUnit();
-        if (TempUnit == Celsius) {
-            DB_printf( "Temperature: %d C \n\r", GetCurrentTemp());
-        } else {
-            DB_printf( "Temperature: %d F \n\r", GetCurrentTemp());
-        }
-        DB_printf( "Soil Moisture: %d%% \n\r", GetCurrentSoilMoisture());
-        
-        bool threshold = GetCurrentThreshold();
-        if (threshold) {
-            DB_printf("Threshold = 30%% \n\r");
-        } else {
-            DB_printf("Threshold = 20%% \n\r");
-        }
-        
-        if (GetWaterStatus()) {
-            DB_printf("\r\n**************************\r\n");
-            DB_printf("WATER LOW!!!\r\nRefill Water\r\n");
-            DB_printf("**************************\r\n");
+        if (ShowingDump == false)
+        {
+            DrawStatus();
         }
-        // TODO: Print current temp, water level, etc...
     }
     break;
     
@@ -189,6 +177,14 @@ ES_Event_t RunUsbOutService(ES_Event_t ThisEvent)
           (char)ThisEvent.EventParam);
         #endif
 
+        // a key with a dump up only takes it down
+        if (ShowingDump)
+        {
+          ShowingDump = false;
+          DrawStatus();
+          break;
+        }
+
         if (('f' == ThisEvent.EventParam) || ('F' == ThisEvent.EventParam))
         {
           SetTemperatureUnit(1);
@@ -216,6 +212,36 @@ ES_Event_t RunUsbOutService(ES_Event_t ThisEvent)
         {
             ToggleThreshold();
         }        
+
+        if (('q' == ThisEvent.EventParam) || ('Q' == ThisEvent.EventParam))
+        {
+            ES_PrintQueueStats();
+            ShowingDump = true;
+        }
+#ifdef ES_PROFILE
+
+        if (('p' == ThisEvent.EventParam) || ('P' == ThisEvent.EventParam))
+        {
+            ES_PrintProfile();
+            ShowingDump = true;
+        }
+#endif
+#ifdef ES_TRACE
+
+        if (('r' == ThisEvent.EventParam) || ('R' == ThisEvent.EventParam))
+        {
+            ES_TraceDump();
+            ShowingDump = true;
+        }
+#endif
+#ifdef ES_RUN_BUDGET
+
+        if (('o' == ThisEvent.EventParam) || ('O' == ThisEvent.EventParam))
+        {
+            ES_PrintOverruns();
+            ShowingDump = true;
+        }
+#endif
     }
     break;
     
@@ -223,6 +249,10 @@ ES_Event_t RunUsbOutService(ES_Event_t ThisEvent)
     {}
      break;
   }
+  if ((ThisEvent.EventType == ES_NEW_KEY) && ShowingDump)
+  {
+    DB_printf("Press any key to go back \n\r");
+  }
 
   return ReturnEvent;
 }
@@ -230,6 +260,63 @@ ES_Event_t RunUsbOutService(ES_Event_t ThisEvent)
 /***************************************************************************
  private functions
  ***************************************************************************/
+/****************************************************************************
+ Function
+     DrawStatus
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     clears the terminal and prints the key menu and the current readings
+ Notes
+     the ES_TIMEOUT redraw every two seconds, held off while a dump is up
+****************************************************************************/
+static void DrawStatus(void)
+{
+  clrScrn();
+  puts("\rSmart Pot, Matthew Sato, EE256 Final Project \r");
+  DB_printf( "\n\r\n");
+  DB_printf( "Press 'f' to switch to Fahrenheit \n\r");
+  DB_printf( "Press 'c' to switch to Celsius \n\r");
+  DB_printf( "Press 'w' to water the plant \n\r");
+  DB_printf( "Press 't' to switch water level threshold \n\r");
+  DB_printf( "Press 'q' to show event queue statistics \n\r");
+#ifdef ES_PROFILE
+  DB_printf( "Press 'p' to show service run times \n\r");
+#endif
+#ifdef ES_TRACE
+  DB_printf( "Press 'r' to dump the event recorder \n\r");
+#endif
+#ifdef ES_RUN_BUDGET
+  DB_printf( "Press 'o' to show run budget overruns \n\r");
+#endif
+
+  TemperatureUnit_t TempUnit = GetTempUnit();
+  if (TempUnit == Celsius) {
+      DB_printf( "Temperature: %d C \n\r", GetCurrentTemp());
+  } else {
+      DB_printf( "Temperature: %d F \n\r", GetCurrentTemp());
+  }
+  DB_printf( "Soil Moisture: %d%% \n\r", GetCurrentSoilMoisture());
+
+  bool threshold = GetCurrentThreshold();
+  if (threshold) {
+      DB_printf("Threshold = 30%% \n\r");
+  } else {
+      DB_printf("Threshold = 20%% \n\r");
+  }
+
+  if (GetWaterStatus()) {
+      DB_printf("\r\n**************************\r\n");
+      DB_printf("WATER LOW!!!\r\nRefill Water\r\n");
+      DB_printf("**************************\r\n");
+  }
+  // TODO: Print current temp, water level, etc...
+}
 
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -15,6 +15,8 @@
 /* include header files for this state machine as well as any machines at the
    next lower level in the hierarchy that are sub-machines to this machine
 */
+#include <sys/attribs.h>
+
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "WiFiSM.h"
@@ -25,6 +27,8 @@
 
 /*----------------------------- Module Defines ----------------------------*/
 #define SPI_BRG_DIVISOR 1000
+// SPI1 RX bytes waiting for the state machine, must be a power of 2
+#define RX_QUEUE_SIZE 16
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
@@ -40,6 +44,10 @@ static uint8_t MyPriority;
 
 static uint8_t LastReceivedMessage = 0;
 
+// filled by SPI1_RX_ISR without turning interrupts off
+static ES_Event_t RxSlots[RX_QUEUE_SIZE];
+static ES_SPSCQueue_t RxQueue;
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -64,6 +72,16 @@ bool InitWiFiSM(uint8_t Priority)
   MyPriority = Priority;
   // put us into the Initial PseudoState
   CurrentState = InitPState_WiFi;
+  // pass every new reading on to the WiFi module
+  ES_ListSubscribe(TEMPERATURE_LIST, MyPriority);
+  ES_ListSubscribe(MOISTURE_LIST, MyPriority);
+
+  // the RX interrupt posts through its own queue, set it up before enabling it
+  if ((ES_SPSCInit(&RxQueue, RxSlots, RX_QUEUE_SIZE) == false) ||
+      (ES_AttachISRQueue(MyPriority, &RxQueue) == false))
+  {
+    return false;
+  }
   
   ////////////////////// Set Up SPI1 /////////////////////////////////////////
   // SDI1 Digital Input (RC7)
@@ -176,7 +194,11 @@ ES_Event_t RunWiFiSM(ES_Event_t ThisEvent)
       {
         case EV_UPDATE_TEMP: 
         {
-          uint8_t Temp = ThisEvent.EventParam;
+          const TempReading_t *pReading = ES_PayloadGet(ThisEvent.EventParam);
+          if (pReading == NULL) {
+              break;
+          }
+          uint8_t Temp = pReading->Temp;
           SPI1BUF = Temp;
           SPI1BUF = 0;
           SPI1BUF = 0;
@@ -284,6 +306,47 @@ ES_Event_t RunWiFiSM(ES_Event_t ThisEvent)
     default:
       ;
   }
+  // the temperature payload is released here, whatever state took it
+  if (ThisEvent.EventType == EV_UPDATE_TEMP)
+  {
+    ES_PayloadRelease(ThisEvent.EventParam);
+  }
+  return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+    RunWiFiSMBatch
+
+ Parameters
+   const ES_Event_t * : the events waiting in the queue, oldest first
+   uint8_t : how many there are
+
+ Returns
+   ES_Event_t, ES_NO_EVENT if no error, the first error otherwise
+
+ Description
+   runs the state machine over every event that was waiting, so a burst of
+   SPI1 RX bytes costs one trip through the dispatcher
+ Notes
+   the events are already off the queue, so all of them are run even after
+   an error. Stopping would leak the payload of every EV_UPDATE_TEMP left.
+****************************************************************************/
+ES_Event_t RunWiFiSMBatch(const ES_Event_t *pEvents, uint8_t NumEvents)
+{
+  ES_Event_t ReturnEvent;
+  ES_Event_t ThisReturn;
+  uint8_t i;
+
+  ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+  for (i = 0; i < NumEvents; i++)
+  {
+    ThisReturn = RunWiFiSM(pEvents[i]);
+    if (ReturnEvent.EventType == ES_NO_EVENT)
+    {
+      ReturnEvent = ThisReturn;
+    }
+  }
   return ReturnEvent;
 }
 
@@ -310,12 +373,12 @@ WiFiState_t QueryWiFiSM(void)
 /***************************************************************************
  private functions
  ***************************************************************************/
-void __attribute__((interrupt(ipl7srs), at_vector(_SPI1_RX_VECTOR), aligned(16))) SPI1_RX_ISR()
+void __ISR_AT_VECTOR(_SPI1_RX_VECTOR, IPL7SRS) SPI1_RX_ISR(void)
 {  
     IFS1CLR = _IFS1_SPI1RXIF_MASK; // clear SPI1 interrupt flag
     uint8_t ReceivedData = SPI1BUF;
     ES_Event_t NewEvent = {EV_SPI1_RX_RECEIVED, ReceivedData};
     if (ReceivedData > 0) {
-      PostWiFiSM(NewEvent);
+      ES_PostToServiceFromISR(MyPriority, NewEvent);
     }
 }
\ No newline at end of file